@@ -23,19 +23,189 @@
 #include "audio_cache.h"
 #include "logger.h"
 #include "config.h"
+#ifdef _WIN32
 #include <Windows.h>
 #include <Shlwapi.h>
 #include <bcrypt.h>
+#else
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 #include <sstream>
 #include <iomanip>
 #include <fstream>
+#include <cstdlib>
 
+#ifdef _WIN32
 #pragma comment(lib, "bcrypt.lib")
 #pragma comment(lib, "shlwapi.lib")
+#endif
 
 // Global instance - constructor now does nothing (lazy initialization)
 AudioCache g_audioCache;
 
+#ifdef _WIN32
+static const char PATH_SEPARATOR = '\\';
+#else
+static const char PATH_SEPARATOR = '/';
+#endif
+
+// ============================================================
+// FREQUENCY SKETCH
+// ============================================================
+
+FrequencySketch::FrequencySketch(size_t width)
+    : additions(0)
+{
+    // Round width up to a power of two so rows can be indexed with a mask
+    size_t w = 1;
+    while (w < width) w <<= 1;
+    widthMask = w - 1;
+    sampleSize = w * 10;
+    counters.assign(w * DEPTH, 0);
+}
+
+size_t FrequencySketch::IndexOf(uint64_t hash, size_t row) const {
+    // Each row uses a different 16-bit slice of the key hash
+    uint64_t h = (hash >> (row * 16)) * 0x9E3779B97F4A7C15ull;
+    return row * (widthMask + 1) + static_cast<size_t>((h >> 32) & widthMask);
+}
+
+void FrequencySketch::Age() {
+    // Halve every counter so old popularity fades out
+    for (auto& c : counters) {
+        c >>= 1;
+    }
+    additions /= 2;
+}
+
+uint8_t FrequencySketch::Increment(uint64_t hash) {
+    uint8_t estimate = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        uint8_t& c = counters[IndexOf(hash, row)];
+        if (c < MAX_COUNT) c++;
+        if (c < estimate) estimate = c;
+    }
+
+    if (++additions >= sampleSize) {
+        Age();
+    }
+    return estimate;
+}
+
+uint8_t FrequencySketch::Estimate(uint64_t hash) const {
+    uint8_t estimate = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        uint8_t c = counters[IndexOf(hash, row)];
+        if (c < estimate) estimate = c;
+    }
+    return estimate;
+}
+
+// Cache keys are hex SHA-256 digests, so the first 16 digits are already a good hash
+static uint64_t CacheKeyHash(const std::string& cacheKey) {
+    if (cacheKey.size() < 16) return 0;
+    return std::strtoull(cacheKey.substr(0, 16).c_str(), nullptr, 16);
+}
+
+// ============================================================
+// CACHE FILE WRITER
+// ============================================================
+
+#ifdef _WIN32
+CacheFileWriter::CacheFileWriter(HANDLE f, std::string temp, std::string target)
+    : file(f), tempPath(std::move(temp)), finalPath(std::move(target)), written(0), failed(false) {}
+
+CacheFileWriter::~CacheFileWriter() {
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        DeleteFileA(tempPath.c_str());
+    }
+}
+
+void CacheFileWriter::Write(const uint8_t* data, size_t size) {
+    if (failed || size == 0) {
+        return;
+    }
+
+    DWORD bytesWritten = 0;
+    if (!WriteFile(file, data, static_cast<DWORD>(size), &bytesWritten, NULL) || bytesWritten != size) {
+        LOG_ERROR(L"Failed to write cache file: " + std::wstring(tempPath.begin(), tempPath.end()));
+        failed = true;
+        return;
+    }
+    written += size;
+}
+
+bool CacheFileWriter::Commit() {
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+
+    // Replacing an existing copy of the clip is fine - it has the same content
+    if (failed || !MoveFileExA(tempPath.c_str(), finalPath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+
+    LOG_DEBUG(L"Saved to disk cache: " + std::wstring(finalPath.begin(), finalPath.end()));
+    return true;
+}
+
+#else
+
+CacheFileWriter::CacheFileWriter(FILE* f, std::string temp, std::string target)
+    : file(f), tempPath(std::move(temp)), finalPath(std::move(target)), written(0), failed(false) {}
+
+CacheFileWriter::~CacheFileWriter() {
+    if (file) {
+        fclose(file);
+        remove(tempPath.c_str());
+    }
+}
+
+void CacheFileWriter::Write(const uint8_t* data, size_t size) {
+    if (failed || size == 0) {
+        return;
+    }
+
+    if (fwrite(data, 1, size, file) != size) {
+        LOG_ERROR(L"Failed to write cache file: " + std::wstring(tempPath.begin(), tempPath.end()));
+        failed = true;
+        return;
+    }
+    written += size;
+}
+
+bool CacheFileWriter::Commit() {
+    if (!file) {
+        return false;
+    }
+
+    bool closed = fclose(file) == 0;
+    file = nullptr;
+
+    // rename replaces an existing copy of the clip in one step
+    if (failed || !closed || rename(tempPath.c_str(), finalPath.c_str()) != 0) {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    LOG_DEBUG(L"Saved to disk cache: " + std::wstring(finalPath.begin(), finalPath.end()));
+    return true;
+}
+
+#endif
+
+// ============================================================
+// AUDIO CACHE
+// ============================================================
+
 AudioCache::AudioCache(size_t size) : maxSize(size), diskCacheEnabled(false), initialized(false) {}
 
 // Initialize the cache - called on first use
@@ -46,6 +216,7 @@ void AudioCache::Initialize() {
         return;  // Already initialized
     }
 
+#ifdef _WIN32
     gameDirectory = GetGameDirectory();
     if (gameDirectory.empty()) {
         LOG_ERROR(L"Failed to get game directory");
@@ -56,10 +227,26 @@ void AudioCache::Initialize() {
     diskCacheEnabled = InitializeCacheDirectory();
 
     if (diskCacheEnabled) {
+        RemoveTempFiles();
         LOG_INFO(L"Disk cache initialized at: " + std::wstring(cacheDirectory.begin(), cacheDirectory.end()));
     }
+#else
+    gameDirectory = GetGameDirectory();
+    cacheDirectory = gameDirectory + "/tts_audio_cache";
+    diskCacheEnabled = InitializeCacheDirectory();
+
+    if (diskCacheEnabled) {
+        RemoveTempFiles();
+        LOG_INFO(L"Disk cache initialized at: " + std::wstring(cacheDirectory.begin(), cacheDirectory.end()));
+    }
+#endif
+}
+
+std::string AudioCache::ClipPath(const std::string& cacheKey) const {
+    return cacheDirectory + PATH_SEPARATOR + cacheKey + "." + g_config.format;
 }
 
+#ifdef _WIN32
 std::string AudioCache::GetGameDirectory() {
     wchar_t modulePath[MAX_PATH];
     if (GetModuleFileNameW(NULL, modulePath, MAX_PATH) == 0) {
@@ -206,15 +393,18 @@ bool AudioCache::LoadFromDisk(const std::string& cacheKey, std::vector<uint8_t>&
     return false;
 }
 
-bool AudioCache::SaveToDisk(const std::string& cacheKey, const std::vector<uint8_t>& data) {
+// Temporary files get a unique name, so two downloads of the same clip (a
+// hedged request) don't write into each other
+std::unique_ptr<CacheFileWriter> AudioCache::OpenCacheFile(const std::string& cacheKey) {
     if (!diskCacheEnabled) {
-        return false;
+        return nullptr;
     }
 
     std::string filePath = cacheDirectory + "\\" + cacheKey + "." + std::string(g_config.format);
+    std::string tempPath = cacheDirectory + "\\" + cacheKey + "." + std::to_string(tempFileCounter.fetch_add(1)) + ".tmp";
 
     HANDLE hFile = CreateFileA(
-        filePath.c_str(),
+        tempPath.c_str(),
         GENERIC_WRITE,
         0,
         NULL,
@@ -224,57 +414,295 @@ bool AudioCache::SaveToDisk(const std::string& cacheKey, const std::vector<uint8
     );
 
     if (hFile == INVALID_HANDLE_VALUE) {
-        LOG_ERROR(L"Failed to create cache file: " + std::wstring(filePath.begin(), filePath.end()));
-        return false;
+        LOG_ERROR(L"Failed to create cache file: " + std::wstring(tempPath.begin(), tempPath.end()));
+        return nullptr;
     }
 
-    DWORD bytesWritten;
-    BOOL success = WriteFile(hFile, data.data(), static_cast<DWORD>(data.size()), &bytesWritten, NULL);
-    CloseHandle(hFile);
+    return std::make_unique<CacheFileWriter>(hFile, tempPath, filePath);
+}
+
+// Leftovers of downloads the game exited during
+void AudioCache::RemoveTempFiles() {
+    std::string searchPath = cacheDirectory + "\\*.tmp";
+    WIN32_FIND_DATAA findData;
+    HANDLE hFind = FindFirstFileA(searchPath.c_str(), &findData);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    int deletedCount = 0;
+    do {
+        std::string filePath = cacheDirectory + "\\" + findData.cFileName;
+        if (DeleteFileA(filePath.c_str())) {
+            deletedCount++;
+        }
+    } while (FindNextFileA(hFind, &findData));
+
+    FindClose(hFind);
+    if (deletedCount > 0) {
+        LOG_DEBUG(L"Removed " + std::to_wstring(deletedCount) + L" unfinished cache files");
+    }
+}
+
+#else
+
+// Lowercase hex SHA-256 of data, the same digest BCrypt gives on Windows
+static std::string Sha256Hex(const std::string& data) {
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    uint32_t h[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+    // Message, a 1 bit, zero padding and the bit length fill whole 64-byte blocks
+    std::string padded = data;
+    padded += static_cast<char>(0x80);
+    while (padded.size() % 64 != 56) {
+        padded += '\0';
+    }
+    uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+    for (int i = 7; i >= 0; --i) {
+        padded += static_cast<char>((bitLength >> (i * 8)) & 0xFF);
+    }
 
-    if (success && bytesWritten == data.size()) {
-        LOG_DEBUG(L"Saved to disk cache: " + std::wstring(filePath.begin(), filePath.end()));
+    for (size_t block = 0; block < padded.size(); block += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(padded.data() + block + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint32_t word : h) {
+        ss << std::setw(8) << word;
+    }
+    return ss.str();
+}
+
+std::string AudioCache::GenerateCacheKey(const std::string& text, const std::string& server, const std::string& voice) {
+    return Sha256Hex(text + "|" + server + "|" + voice);
+}
+
+// There is no game executable to sit beside, so the cache goes in the working directory
+std::string AudioCache::GetGameDirectory() {
+    char path[4096];
+    return getcwd(path, sizeof(path)) ? std::string(path) : std::string(".");
+}
+
+bool AudioCache::InitializeCacheDirectory() {
+    if (mkdir(cacheDirectory.c_str(), 0755) == 0 || errno == EEXIST) {
         return true;
     }
 
-    LOG_ERROR(L"Failed to write cache file: " + std::wstring(filePath.begin(), filePath.end()));
+    LOG_ERROR(L"Failed to create cache directory: " + std::wstring(cacheDirectory.begin(), cacheDirectory.end()));
     return false;
 }
 
+bool AudioCache::LoadFromDisk(const std::string& cacheKey, std::vector<uint8_t>& outData) {
+    if (!diskCacheEnabled) {
+        return false;
+    }
+
+    std::string filePath = ClipPath(cacheKey);
+    FILE* file = fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    struct stat info;
+    bool success = fstat(fileno(file), &info) == 0;
+    if (success) {
+        outData.resize(static_cast<size_t>(info.st_size));
+        success = fread(outData.data(), 1, outData.size(), file) == outData.size();
+    }
+    fclose(file);
+
+    if (success) {
+        LOG_DEBUG(L"Loaded from disk cache: " + std::wstring(filePath.begin(), filePath.end()));
+    }
+    return success;
+}
+
+std::unique_ptr<CacheFileWriter> AudioCache::OpenCacheFile(const std::string& cacheKey) {
+    if (!diskCacheEnabled) {
+        return nullptr;
+    }
+
+    std::string tempPath = cacheDirectory + "/" + cacheKey + "." + std::to_string(tempFileCounter.fetch_add(1)) + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        LOG_ERROR(L"Failed to create cache file: " + std::wstring(tempPath.begin(), tempPath.end()));
+        return nullptr;
+    }
+
+    return std::make_unique<CacheFileWriter>(file, tempPath, ClipPath(cacheKey));
+}
+
+// Deletes the files in the cache directory whose names end in suffix
+static int RemoveFilesEndingIn(const std::string& directory, const std::string& suffix) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return 0;
+    }
+
+    int deletedCount = 0;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+            remove((directory + "/" + name).c_str()) == 0) {
+            deletedCount++;
+        }
+    }
+    closedir(dir);
+    return deletedCount;
+}
+
+// Leftovers of downloads the process exited during
+void AudioCache::RemoveTempFiles() {
+    int deletedCount = RemoveFilesEndingIn(cacheDirectory, ".tmp");
+    if (deletedCount > 0) {
+        LOG_DEBUG(L"Removed " + std::to_wstring(deletedCount) + L" unfinished cache files");
+    }
+}
+
+#endif
+
+bool AudioCache::SaveToDisk(const std::string& cacheKey, const std::vector<uint8_t>& data) {
+    std::unique_ptr<CacheFileWriter> writer = OpenCacheFile(cacheKey);
+    if (!writer) {
+        return false;
+    }
+
+    writer->Write(data.data(), data.size());
+    return writer->Commit();
+}
+
+bool AudioCache::ShouldAdmitToDisk(size_t textLength, uint8_t frequency) const {
+    if (g_config.DiskAdmissionEquals("second_access")) {
+        return frequency >= 2;
+    }
+    if (g_config.DiskAdmissionEquals("min_length")) {
+        return textLength >= static_cast<size_t>(g_config.disk_admission_min_chars);
+    }
+    if (g_config.DiskAdmissionEquals("frequency")) {
+        return frequency >= g_config.disk_admission_min_hits;
+    }
+    return true;  // "always"
+}
+
+void AudioCache::EvictOldestLocked() {
+    if (cache.empty()) {
+        return;
+    }
+
+    auto oldest = cache.begin();
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->second.timestamp < oldest->second.timestamp) {
+            oldest = it;
+        }
+    }
+
+    // A probation entry leaving memory was never worth the disk write
+    if (diskCacheEnabled && !oldest->second.persisted) {
+        admissionStats.writesAvoided++;
+        admissionStats.bytesAvoided += oldest->second.data.size();
+        LOG_DEBUG(L"Evicted unpersisted clip, disk write avoided (" +
+            std::to_wstring(oldest->second.data.size()) + L" bytes)");
+    }
+
+    cache.erase(oldest);
+}
+
 bool AudioCache::Get(const std::string& text, const std::string& server, const std::string& voice, std::vector<uint8_t>& outData) {
     std::string cacheKey = GenerateCacheKey(text, server, voice);
+    uint64_t keyHash = CacheKeyHash(cacheKey);
+    bool memoryHit = false;
+    bool promote = false;
 
     // Check in-memory cache first
     {
         std::lock_guard<std::mutex> lock(cacheMutex);
+        uint8_t frequency = sketch.Increment(keyHash);
+
         auto it = cache.find(cacheKey);
         if (it != cache.end()) {
             outData = it->second.data;
             it->second.timestamp = std::chrono::steady_clock::now();
+            memoryHit = true;
+
+            // Probation entry hit again - promote it to disk if the policy now agrees
+            if (diskCacheEnabled && !it->second.persisted && ShouldAdmitToDisk(it->second.textLength, frequency)) {
+                it->second.persisted = true;  // Claim the write so concurrent hits don't repeat it
+                promote = true;
+            }
+
             LOG_DEBUG(L"Cache hit (memory) for key: " + std::wstring(cacheKey.begin(), cacheKey.begin() + 16) + L"...");
-            return true;
         }
     }
 
+    if (promote) {
+        bool saved = SaveToDisk(cacheKey, outData);
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (saved) {
+            admissionStats.promotedFromMemory++;
+            admissionStats.writesAdmitted++;
+            admissionStats.bytesWritten += outData.size();
+        } else {
+            auto it = cache.find(cacheKey);
+            if (it != cache.end()) {
+                it->second.persisted = false;
+            }
+        }
+    }
+
+    if (memoryHit) {
+        return true;
+    }
+
     // Check disk cache
     if (LoadFromDisk(cacheKey, outData)) {
+        if (outData.size() > MAX_MEMORY_CLIP_BYTES) {
+            LOG_DEBUG(L"Cache hit (disk) for key: " + std::wstring(cacheKey.begin(), cacheKey.begin() + 16) + L"...");
+            return true;
+        }
+
         // Load into memory for faster access next time
         std::lock_guard<std::mutex> lock(cacheMutex);
 
         // Evict oldest if cache is full
         if (cache.size() >= maxSize) {
-            auto oldest = cache.begin();
-            for (auto it = cache.begin(); it != cache.end(); ++it) {
-                if (it->second.timestamp < oldest->second.timestamp) {
-                    oldest = it;
-                }
-            }
-            cache.erase(oldest);
+            EvictOldestLocked();
         }
 
         CacheEntry entry;
         entry.data = outData;
         entry.timestamp = std::chrono::steady_clock::now();
+        entry.textLength = text.length();
+        entry.persisted = true;
         cache[cacheKey] = std::move(entry);
 
         LOG_DEBUG(L"Cache hit (disk) for key: " + std::wstring(cacheKey.begin(), cacheKey.begin() + 16) + L"...");
@@ -285,29 +713,89 @@ bool AudioCache::Get(const std::string& text, const std::string& server, const s
     return false;
 }
 
-void AudioCache::Put(const std::string& text, const std::string& server, const std::string& voice, const std::vector<uint8_t>& data) {
+std::unique_ptr<CacheFileWriter> AudioCache::BeginDiskWrite(const std::string& text, const std::string& server,
+    const std::string& voice) {
+    if (!diskCacheEnabled) {
+        return nullptr;
+    }
+
+    std::string cacheKey = GenerateCacheKey(text, server, voice);
+    {
+        // Get() already counted this access, so only read the estimate here
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (!ShouldAdmitToDisk(text.length(), sketch.Estimate(CacheKeyHash(cacheKey)))) {
+            return nullptr;
+        }
+    }
+    return OpenCacheFile(cacheKey);
+}
+
+void AudioCache::Put(const std::string& text, const std::string& server, const std::string& voice, const std::vector<uint8_t>& data,
+    CacheFileWriter* diskCopy) {
     std::string cacheKey = GenerateCacheKey(text, server, voice);
+    bool admit = false;
 
-    std::lock_guard<std::mutex> lock(cacheMutex);
+    // A clip that was streamed to disk was admitted when its download began
+    if (diskCopy) {
+        admit = true;
+    } else if (diskCacheEnabled) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        admit = ShouldAdmitToDisk(text.length(), sketch.Estimate(CacheKeyHash(cacheKey)));
+    }
 
-    // Evict oldest if cache is full
-    if (cache.size() >= maxSize) {
-        auto oldest = cache.begin();
-        for (auto it = cache.begin(); it != cache.end(); ++it) {
-            if (it->second.timestamp < oldest->second.timestamp) {
-                oldest = it;
-            }
+    auto saveClip = [&]() {
+        bool saved = diskCopy ? diskCopy->Commit() : SaveToDisk(cacheKey, data);
+        if (saved) {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            admissionStats.writesAdmitted++;
+            admissionStats.bytesWritten += data.size();
+        }
+        return saved;
+    };
+
+    // A large clip that lands on disk is served from there alone
+    bool writeFailed = false;
+    if (admit && data.size() > MAX_MEMORY_CLIP_BYTES) {
+        if (saveClip()) {
+            return;
+        }
+        admit = false;
+        writeFailed = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        // Evict oldest if cache is full
+        if (cache.size() >= maxSize) {
+            EvictOldestLocked();
+        }
+
+        CacheEntry entry;
+        entry.data = data;
+        entry.timestamp = std::chrono::steady_clock::now();
+        entry.textLength = text.length();
+        entry.persisted = admit;
+        cache[cacheKey] = std::move(entry);
+
+        if (diskCacheEnabled && !admit && !writeFailed) {
+            admissionStats.writesDeferred++;
+            LOG_DEBUG(L"Disk admission deferred, clip kept in memory only");
         }
-        cache.erase(oldest);
     }
 
-    CacheEntry entry;
-    entry.data = data;
-    entry.timestamp = std::chrono::steady_clock::now();
-    cache[cacheKey] = std::move(entry);
+    if (!admit) {
+        return;
+    }
 
-    // Also save to disk (async - don't block if it fails)
-    SaveToDisk(cacheKey, data);
+    // Write outside the lock so other workers aren't blocked on disk I/O
+    if (!saveClip()) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(cacheKey);
+        if (it != cache.end()) {
+            it->second.persisted = false;
+        }
+    }
 }
 
 void AudioCache::Clear() {
@@ -316,6 +804,7 @@ void AudioCache::Clear() {
 }
 
 void AudioCache::ClearDiskCache() {
+#ifdef _WIN32
     if (!diskCacheEnabled) {
         return;
     }
@@ -339,6 +828,14 @@ void AudioCache::ClearDiskCache() {
 
     FindClose(hFind);
     LOG_INFO(L"Cleared " + std::to_wstring(deletedCount) + L" files from disk cache");
+#else
+    if (!diskCacheEnabled) {
+        return;
+    }
+
+    int deletedCount = RemoveFilesEndingIn(cacheDirectory, std::string(".") + g_config.format);
+    LOG_INFO(L"Cleared " + std::to_wstring(deletedCount) + L" files from disk cache");
+#endif
 }
 
 void AudioCache::SetMaxSize(size_t size) {
@@ -346,8 +843,54 @@ void AudioCache::SetMaxSize(size_t size) {
     maxSize = size;
 }
 
+bool AudioCache::Contains(const std::string& text, const std::string& server, const std::string& voice) {
+    std::string cacheKey = GenerateCacheKey(text, server, voice);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (cache.find(cacheKey) != cache.end()) {
+            return true;
+        }
+    }
+
+    if (!diskCacheEnabled) {
+        return false;
+    }
+#ifdef _WIN32
+    return GetFileAttributesA(ClipPath(cacheKey).c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat info;
+    return stat(ClipPath(cacheKey).c_str(), &info) == 0;
+#endif
+}
+
 std::string AudioCache::GetCachedFilePath(const std::string& text, const std::string& server, const std::string& voice) {
     if (!diskCacheEnabled) return "";
     std::string cacheKey = GenerateCacheKey(text, server, voice);
-    return cacheDirectory + "\\" + cacheKey + "." + g_config.format;
+
+    // Clips still on probation have no file yet
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(cacheKey);
+        if (it != cache.end() && !it->second.persisted) {
+            return "";
+        }
+    }
+
+    return ClipPath(cacheKey);
+}
+
+DiskAdmissionStats AudioCache::GetAdmissionStats() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return admissionStats;
+}
+
+void AudioCache::LogAdmissionStats() {
+    DiskAdmissionStats stats = GetAdmissionStats();
+    std::string policy(g_config.disk_admission);
+
+    LOG_INFO(L"Disk admission (" + std::wstring(policy.begin(), policy.end()) + L"): " +
+        std::to_wstring(stats.writesAdmitted) + L" writes (" + std::to_wstring(stats.bytesWritten) + L" bytes), " +
+        std::to_wstring(stats.writesDeferred) + L" deferred, " +
+        std::to_wstring(stats.promotedFromMemory) + L" promoted, " +
+        std::to_wstring(stats.writesAvoided) + L" avoided (" + std::to_wstring(stats.bytesAvoided) + L" bytes)");
 }
@@ -29,29 +29,124 @@
 #include <string>
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+// Count-min sketch with 4-bit saturating counters and periodic aging (TinyLFU style)
+// Remembers approximate access frequency of keys that are no longer in memory
+class FrequencySketch {
+private:
+    static constexpr size_t DEPTH = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+
+    std::vector<uint8_t> counters;
+    size_t widthMask;
+    size_t additions;
+    size_t sampleSize;
+
+    size_t IndexOf(uint64_t hash, size_t row) const;
+    void Age();
+
+public:
+    explicit FrequencySketch(size_t width = 4096);
+
+    // Record one access, returns the new estimated frequency
+    uint8_t Increment(uint64_t hash);
+    uint8_t Estimate(uint64_t hash) const;
+};
+
+// Counters for the disk admission policy
+struct DiskAdmissionStats {
+    uint64_t writesAdmitted = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t writesDeferred = 0;      // Put kept the clip in memory only (probation)
+    uint64_t promotedFromMemory = 0;  // Probation entries written after a later hit
+    uint64_t writesAvoided = 0;       // Probation entries evicted without ever being written
+    uint64_t bytesAvoided = 0;
+};
 
 // Simple LRU Cache for audio with persistent disk storage
+// Memory acts as a probation tier: clips are only written to disk once the
+// configured disk_admission policy accepts them
+// A clip written to the disk cache while it downloads
+// Bytes go to a temporary file beside the final one and Commit renames it
+// into place, so a reader never opens a half-written clip. A writer that is
+// destroyed without Commit (failed or cancelled download) deletes its file.
+class CacheFileWriter {
+private:
+#ifdef _WIN32
+    HANDLE file;
+#else
+    FILE* file;
+#endif
+    std::string tempPath;
+    std::string finalPath;
+    size_t written;
+    bool failed;
+
+public:
+#ifdef _WIN32
+    CacheFileWriter(HANDLE f, std::string temp, std::string target);
+#else
+    CacheFileWriter(FILE* f, std::string temp, std::string target);
+#endif
+    ~CacheFileWriter();
+
+    CacheFileWriter(const CacheFileWriter&) = delete;
+    CacheFileWriter& operator=(const CacheFileWriter&) = delete;
+
+    // Append downloaded bytes; after a failed write the rest is ignored and Commit fails
+    void Write(const uint8_t* data, size_t size);
+
+    // Close the file and move it into place
+    bool Commit();
+
+    size_t Size() const { return written; }
+};
+
 class AudioCache {
 private:
     struct CacheEntry {
         std::vector<uint8_t> data;
         std::chrono::steady_clock::time_point timestamp;
+        size_t textLength = 0;
+        bool persisted = false;
     };
 
+    // Clips larger than this that are on disk aren't held in memory as well;
+    // reading one back on a repeat costs less than keeping a second copy
+    static constexpr size_t MAX_MEMORY_CLIP_BYTES = 256 * 1024;
+
     std::unordered_map<std::string, CacheEntry> cache;
     std::mutex cacheMutex;
     size_t maxSize;
     std::string cacheDirectory;
     bool diskCacheEnabled;
     std::atomic<bool> initialized;  // Track if cache has been initialized
+    std::atomic<uint64_t> tempFileCounter{ 0 };
     std::string gameDirectory;
+    FrequencySketch sketch;         // Protected by cacheMutex
+    DiskAdmissionStats admissionStats;  // Protected by cacheMutex
 
     std::string GenerateCacheKey(const std::string& text, const std::string& server, const std::string& voice);
+    std::string ClipPath(const std::string& cacheKey) const;
     bool InitializeCacheDirectory();
     bool LoadFromDisk(const std::string& cacheKey, std::vector<uint8_t>& outData);
     bool SaveToDisk(const std::string& cacheKey, const std::vector<uint8_t>& data);
+    std::unique_ptr<CacheFileWriter> OpenCacheFile(const std::string& cacheKey);
+    void RemoveTempFiles();
     std::string GetGameDirectory();
 
+    // Must be called with cacheMutex held
+    void EvictOldestLocked();
+
+    // Apply the configured disk_admission policy to a clip
+    bool ShouldAdmitToDisk(size_t textLength, uint8_t frequency) const;
+
 public:
     AudioCache(size_t size = 50);
 
@@ -61,8 +156,23 @@ public:
     void SetMaxSize(size_t size);
 
     bool Get(const std::string& text, const std::string& server, const std::string& voice, std::vector<uint8_t>& outData);
-    void Put(const std::string& text, const std::string& server, const std::string& voice, const std::vector<uint8_t>& data);
+
+    // Start writing a clip to disk as it downloads; null if the disk cache is
+    // off or the admission policy keeps this clip in memory for now
+    std::unique_ptr<CacheFileWriter> BeginDiskWrite(const std::string& text, const std::string& server, const std::string& voice);
+
+    // Store a downloaded clip; diskCopy, if given, already holds it and is committed here
+    void Put(const std::string& text, const std::string& server, const std::string& voice, const std::vector<uint8_t>& data,
+        CacheFileWriter* diskCopy = nullptr);
+
+    // Is the clip in memory or on disk, without loading it
+    bool Contains(const std::string& text, const std::string& server, const std::string& voice);
+
+    // Returns the disk path of a cached clip, or empty if it only lives in memory
     std::string GetCachedFilePath(const std::string& text, const std::string& server, const std::string& voice);
+
+    DiskAdmissionStats GetAdmissionStats();
+    void LogAdmissionStats();
 };
 
 // Global audio cache instance
@@ -0,0 +1,290 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "audio_decoder.h"
+#include "config.h"
+#include "logger.h"
+#ifdef _WIN32
+#include <Windows.h>
+#include <Shlwapi.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#endif
+#include <atomic>
+#include <mutex>
+#include <cstring>
+
+#ifdef _WIN32
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+#pragma comment(lib, "shlwapi.lib")
+#endif
+
+static std::atomic<bool> g_wireFormatFailed{ false };
+
+// Wire format savings, for the log
+static std::mutex g_wireStatsMutex;
+static uint64_t g_clipsDecoded = 0;
+static uint64_t g_wireBytes = 0;
+static uint64_t g_decodedBytes = 0;
+static uint64_t g_downloadMs = 0;
+static uint64_t g_decodeMs = 0;
+
+bool DecodesWireFormat() {
+    return g_config.wire_format[0] != '\0' && !g_wireFormatFailed.load();
+}
+
+const char* RequestFormat() {
+    return DecodesWireFormat() ? g_config.wire_format : g_config.format;
+}
+
+#ifdef _WIN32
+static const size_t WAV_HEADER_SIZE = 44;
+
+static std::once_flag g_mediaFoundationOnce;
+static bool g_mediaFoundationStarted = false;
+
+// Tells Media Foundation which media source to use for the bytes
+static const wchar_t* ContentTypeFor(const char* format) {
+    if (strcmp(format, "mp3") == 0) return L"audio/mpeg";
+    if (strcmp(format, "opus") == 0) return L"audio/ogg";   // OpenAI sends Opus in an Ogg container
+    if (strcmp(format, "aac") == 0) return L"audio/aac";
+    if (strcmp(format, "flac") == 0) return L"audio/flac";
+    return L"audio/wav";
+}
+
+static std::wstring HResultText(const wchar_t* call, HRESULT hr) {
+    wchar_t code[16];
+    swprintf_s(code, L"0x%08lX", static_cast<unsigned long>(hr));
+    return std::wstring(call) + L" failed: " + code;
+}
+
+static void WriteWavHeader(uint8_t* header, const WAVEFORMATEX& format, uint32_t dataSize) {
+    uint32_t riffSize = dataSize + 36;
+    uint32_t fmtSize = 16;
+    uint16_t audioFormat = 1;  // PCM
+    uint32_t sampleRate = format.nSamplesPerSec;
+    uint32_t byteRate = format.nAvgBytesPerSec;
+    uint16_t channels = format.nChannels;
+    uint16_t blockAlign = format.nBlockAlign;
+    uint16_t bitsPerSample = format.wBitsPerSample;
+
+    memcpy(header, "RIFF", 4);
+    memcpy(header + 4, &riffSize, 4);
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    memcpy(header + 16, &fmtSize, 4);
+    memcpy(header + 20, &audioFormat, 2);
+    memcpy(header + 22, &channels, 2);
+    memcpy(header + 24, &sampleRate, 4);
+    memcpy(header + 28, &byteRate, 4);
+    memcpy(header + 32, &blockAlign, 2);
+    memcpy(header + 34, &bitsPerSample, 2);
+    memcpy(header + 36, "data", 4);
+    memcpy(header + 40, &dataSize, 4);
+}
+
+bool DecodeToWav(const std::vector<uint8_t>& encoded, std::vector<uint8_t>& wav, std::wstring& error) {
+    // Fetch workers already run with COM initialized; Media Foundation needs starting once
+    std::call_once(g_mediaFoundationOnce, []() {
+        g_mediaFoundationStarted = SUCCEEDED(MFStartup(MF_VERSION, MFSTARTUP_LITE));
+    });
+    if (!g_mediaFoundationStarted) {
+        error = L"Media Foundation is not available";
+        return false;
+    }
+
+    const DWORD audioStream = static_cast<DWORD>(MF_SOURCE_READER_FIRST_AUDIO_STREAM);
+    IStream* memory = nullptr;
+    IMFByteStream* byteStream = nullptr;
+    IMFAttributes* streamAttributes = nullptr;
+    IMFSourceReader* reader = nullptr;
+    IMFMediaType* pcmType = nullptr;
+    IMFMediaType* outputType = nullptr;
+    WAVEFORMATEX* waveFormat = nullptr;
+    UINT32 waveFormatSize = 0;
+    bool ok = false;
+    HRESULT hr;
+
+    memory = SHCreateMemStream(encoded.data(), static_cast<UINT>(encoded.size()));
+    if (!memory) {
+        error = L"SHCreateMemStream failed";
+        goto cleanup;
+    }
+
+    hr = MFCreateMFByteStreamOnStream(memory, &byteStream);
+    if (FAILED(hr)) {
+        error = HResultText(L"MFCreateMFByteStreamOnStream", hr);
+        goto cleanup;
+    }
+    if (SUCCEEDED(byteStream->QueryInterface(IID_PPV_ARGS(&streamAttributes)))) {
+        streamAttributes->SetString(MF_BYTESTREAM_CONTENT_TYPE, ContentTypeFor(g_config.wire_format));
+    }
+
+    hr = MFCreateSourceReaderFromByteStream(byteStream, nullptr, &reader);
+    if (FAILED(hr)) {
+        error = HResultText(L"MFCreateSourceReaderFromByteStream", hr);
+        goto cleanup;
+    }
+    reader->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE);
+    reader->SetStreamSelection(audioStream, TRUE);
+
+    // Ask for 16-bit PCM; the decoder keeps the clip's own rate and channel count
+    hr = MFCreateMediaType(&pcmType);
+    if (FAILED(hr)) {
+        error = HResultText(L"MFCreateMediaType", hr);
+        goto cleanup;
+    }
+    pcmType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+    pcmType->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+    pcmType->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+
+    hr = reader->SetCurrentMediaType(audioStream, nullptr, pcmType);
+    if (FAILED(hr)) {
+        error = HResultText(L"SetCurrentMediaType", hr);
+        goto cleanup;
+    }
+    hr = reader->GetCurrentMediaType(audioStream, &outputType);
+    if (FAILED(hr)) {
+        error = HResultText(L"GetCurrentMediaType", hr);
+        goto cleanup;
+    }
+    hr = MFCreateWaveFormatExFromMFMediaType(outputType, &waveFormat, &waveFormatSize, 0);
+    if (FAILED(hr)) {
+        error = HResultText(L"MFCreateWaveFormatExFromMFMediaType", hr);
+        goto cleanup;
+    }
+
+    // Samples go straight in behind room for the header
+    wav.assign(WAV_HEADER_SIZE, 0);
+    while (true) {
+        DWORD flags = 0;
+        IMFSample* sample = nullptr;
+        hr = reader->ReadSample(audioStream, 0, nullptr, &flags, nullptr, &sample);
+        if (FAILED(hr)) {
+            error = HResultText(L"ReadSample", hr);
+            goto cleanup;
+        }
+
+        if (sample) {
+            IMFMediaBuffer* buffer = nullptr;
+            if (SUCCEEDED(sample->ConvertToContiguousBuffer(&buffer))) {
+                BYTE* data = nullptr;
+                DWORD length = 0;
+                if (SUCCEEDED(buffer->Lock(&data, nullptr, &length))) {
+                    wav.insert(wav.end(), data, data + length);
+                    buffer->Unlock();
+                }
+                buffer->Release();
+            }
+            sample->Release();
+        }
+
+        if (flags & MF_SOURCE_READERF_ENDOFSTREAM) {
+            break;
+        }
+    }
+
+    if (wav.size() == WAV_HEADER_SIZE) {
+        error = L"no audio in the clip";
+        goto cleanup;
+    }
+    WriteWavHeader(wav.data(), *waveFormat, static_cast<uint32_t>(wav.size() - WAV_HEADER_SIZE));
+    ok = true;
+
+cleanup:
+    if (waveFormat) CoTaskMemFree(waveFormat);
+    if (outputType) outputType->Release();
+    if (pcmType) pcmType->Release();
+    if (reader) reader->Release();
+    if (streamAttributes) streamAttributes->Release();
+    if (byteStream) byteStream->Release();
+    if (memory) memory->Release();
+    return ok;
+}
+#else
+// Media Foundation is the only decoder; elsewhere wire_format falls back to format
+bool DecodeToWav(const std::vector<uint8_t>&, std::vector<uint8_t>&, std::wstring& error) {
+    error = L"no decoder outside Windows";
+    return false;
+}
+#endif
+
+bool DecodeDownloadedClip(std::vector<uint8_t>& audio, std::chrono::milliseconds downloadTime) {
+    // Requested before wire_format was dropped, or the server ignored response_format
+    if (audio.size() >= 4 && memcmp(audio.data(), "RIFF", 4) == 0) {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> wav;
+    std::wstring error;
+    if (!DecodeToWav(audio, wav, error)) {
+        if (!g_wireFormatFailed.exchange(true)) {
+            std::string wire(g_config.wire_format);
+            std::string format(g_config.format);
+            LOG_WARNING(L"Can't decode " + std::wstring(wire.begin(), wire.end()) + L" audio (" + error +
+                L"), downloading " + std::wstring(format.begin(), format.end()) + L" from now on");
+        }
+        return false;
+    }
+    auto decodeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    // What the same clip would have cost in WAV, at the throughput this download got
+    uint64_t wireBytes = audio.size();
+    uint64_t savedBytes = wav.size() > wireBytes ? wav.size() - wireBytes : 0;
+    uint64_t savedMs = downloadTime.count() > 0 ? savedBytes * downloadTime.count() / wireBytes : 0;
+    LOG_DEBUG(L"Decoded " + std::to_wstring(wireBytes) + L" bytes to " + std::to_wstring(wav.size()) +
+        L" bytes of WAV in " + std::to_wstring(decodeMs.count()) + L" ms; saved " + std::to_wstring(savedBytes) +
+        L" bytes, about " + std::to_wstring(savedMs) + L" ms of download");
+
+    {
+        std::lock_guard<std::mutex> lock(g_wireStatsMutex);
+        g_clipsDecoded++;
+        g_wireBytes += wireBytes;
+        g_decodedBytes += wav.size();
+        g_downloadMs += downloadTime.count();
+        g_decodeMs += decodeMs.count();
+    }
+
+    audio = std::move(wav);
+    return true;
+}
+
+void LogWireFormatStats() {
+    std::lock_guard<std::mutex> lock(g_wireStatsMutex);
+    if (g_clipsDecoded == 0) {
+        return;
+    }
+
+    std::string wire(g_config.wire_format);
+    uint64_t savedBytes = g_decodedBytes > g_wireBytes ? g_decodedBytes - g_wireBytes : 0;
+    uint64_t savedMs = g_wireBytes > 0 ? savedBytes * g_downloadMs / g_wireBytes : 0;
+    LOG_INFO(L"Wire format " + std::wstring(wire.begin(), wire.end()) + L": " + std::to_wstring(g_clipsDecoded) +
+        L" clips, " + std::to_wstring(g_wireBytes / 1024) + L" KB downloaded instead of " +
+        std::to_wstring(g_decodedBytes / 1024) + L" KB; per clip " + std::to_wstring(savedBytes / g_clipsDecoded / 1024) +
+        L" KB and about " + std::to_wstring(savedMs / g_clipsDecoded) + L" ms saved, " +
+        std::to_wstring(g_decodeMs / g_clipsDecoded) + L" ms to decode");
+}
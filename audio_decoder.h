@@ -0,0 +1,51 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TTS_STELLARIS_AUDIO_DECODER_H
+#define TTS_STELLARIS_AUDIO_DECODER_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+// Local decoding of a compact wire format (wire_format) into the WAV the player needs
+// Media Foundation does the decoding; a clip is decoded once fully downloaded.
+
+// Audio is requested in wire_format and decoded before playback
+bool DecodesWireFormat();
+
+// response_format to ask the server for
+const char* RequestFormat();
+
+// Decode a complete clip to 16-bit PCM WAV at its native rate and channel count
+bool DecodeToWav(const std::vector<uint8_t>& encoded, std::vector<uint8_t>& wav, std::wstring& error);
+
+// Decode a downloaded clip in place; on failure wire_format is dropped for the
+// rest of the session and false is returned, so the caller can fetch it again.
+// downloadTime is how long the body took, for the bandwidth statistics.
+bool DecodeDownloadedClip(std::vector<uint8_t>& audio, std::chrono::milliseconds downloadTime);
+
+void LogWireFormatStats();
+
+#endif // TTS_STELLARIS_AUDIO_DECODER_H
@@ -1,4 +1,6 @@
 #include "audio_player.h"
+#include "audio_stream.h"
+#include "audio_decoder.h"
 #include "config.h"
 #include "utils.h"
 #include "logger.h"
@@ -7,6 +9,8 @@
 #include <mmsystem.h>
 #include <string>
 #include <vector>
+#include <chrono>
+#include <algorithm>
 
 #pragma comment(lib, "winmm.lib")
 
@@ -83,17 +87,27 @@ void PlayAudioFromMemory(const std::vector<uint8_t>& inputAudioData, const std::
         return;
     }
 
-    // Work on a mutable copy so we can fix headers
-    std::vector<uint8_t> audioData = inputAudioData;
     char tempFile[MAX_PATH];
     bool useCachedFile = false;
 
     // --- 1. DATA PREPARATION & HEADER FIXING ---
 
-    bool isWav = g_config.FormatEquals("wav");
+    // Raw PCM gets the same treatment as a headerless WAV
+    bool isWav = g_config.FormatEquals("wav") || g_config.FormatEquals("pcm");
+
+    // Compressed clips in the disk cache are played from there as they are
+    if (!isWav && cachedFilePath && !cachedFilePath->empty() &&
+        GetFileAttributesA(cachedFilePath->c_str()) != INVALID_FILE_ATTRIBUTES) {
+        strncpy_s(tempFile, cachedFilePath->c_str(), MAX_PATH - 1);
+        useCachedFile = true;
+    }
 
     // If it claims to be a WAV, we must ensure the header is valid for MCI
+    // Only WAV data is modified, so only WAV data needs a mutable copy
+    std::vector<uint8_t> audioData;
     if (isWav) {
+        audioData = inputAudioData;
+
         // Check if "RIFF" tag exists
         if (audioData.size() >= 4 && memcmp(audioData.data(), "RIFF", 4) == 0) {
             // It has a header, but sizes might be wrong (ffmpeg: "Ignoring maximum wav data size")
@@ -106,6 +120,7 @@ void PlayAudioFromMemory(const std::vector<uint8_t>& inputAudioData, const std::
             AddWavHeader(audioData, 24000, 1, 16);
         }
     }
+    const std::vector<uint8_t>& fileData = isWav ? audioData : inputAudioData;
 
     // --- 2. FILE CREATION ---
 
@@ -113,7 +128,7 @@ void PlayAudioFromMemory(const std::vector<uint8_t>& inputAudioData, const std::
         char tempPath[MAX_PATH];
         GetTempPathA(MAX_PATH, tempPath);
 
-        std::string extension = "." + std::string(g_config.format);
+        std::string extension = isWav ? ".wav" : "." + std::string(g_config.format);
         std::string tempFileName = std::string(tempPath) + "stellaris_tts_" + std::to_string(GetTickCount()) + extension;
         strncpy_s(tempFile, tempFileName.c_str(), MAX_PATH - 1);
 
@@ -124,7 +139,7 @@ void PlayAudioFromMemory(const std::vector<uint8_t>& inputAudioData, const std::
         }
 
         DWORD bytesWritten;
-        WriteFile(hFile, audioData.data(), audioData.size(), &bytesWritten, NULL);
+        WriteFile(hFile, fileData.data(), fileData.size(), &bytesWritten, NULL);
         FlushFileBuffers(hFile);
         CloseHandle(hFile);
     }
@@ -132,7 +147,6 @@ void PlayAudioFromMemory(const std::vector<uint8_t>& inputAudioData, const std::
     // --- 3. MCI PLAYBACK ---
 
     g_isPlaying = true;
-    g_shouldCancel = false;
 
     // Explicitly use 'waveaudio' for wav files to avoid codec issues
     std::string deviceType = (isWav) ? "waveaudio" : "mpegvideo";
@@ -196,4 +210,242 @@ void PlayAudioFromMemory(const std::vector<uint8_t>& inputAudioData, const std::
     g_isPlaying = false;
 
     if (!useCachedFile) DeleteFileA(tempFile);
-}
\ No newline at end of file
+}
+
+// ============================================================
+// PROGRESSIVE (STREAMING) PLAYBACK
+// ============================================================
+
+enum class WavHeaderStatus {
+    NeedMore,
+    Ok,
+    Invalid
+};
+
+// Parse the RIFF header at the start of a streamed WAV response
+// Streaming servers often write 0xFFFFFFFF as the data size, so only the
+// format and the offset of the sample data are taken from the header
+static WavHeaderStatus ParseWavStreamHeader(const std::vector<uint8_t>& bytes, WAVEFORMATEX& fmt, size_t& dataOffset) {
+    if (bytes.size() < 12) return WavHeaderStatus::NeedMore;
+    if (memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return WavHeaderStatus::Invalid;
+    }
+
+    bool haveFmt = false;
+    size_t pos = 12;
+
+    while (pos + 8 <= bytes.size()) {
+        uint32_t chunkSize = 0;
+        memcpy(&chunkSize, bytes.data() + pos + 4, 4);
+
+        if (memcmp(bytes.data() + pos, "data", 4) == 0) {
+            if (!haveFmt) return WavHeaderStatus::Invalid;
+            dataOffset = pos + 8;
+            return WavHeaderStatus::Ok;
+        }
+
+        if (memcmp(bytes.data() + pos, "fmt ", 4) == 0) {
+            if (pos + 8 + 16 > bytes.size()) return WavHeaderStatus::NeedMore;
+
+            uint16_t audioFormat, channels, blockAlign, bitsPerSample;
+            uint32_t sampleRate, byteRate;
+            memcpy(&audioFormat, bytes.data() + pos + 8, 2);
+            memcpy(&channels, bytes.data() + pos + 10, 2);
+            memcpy(&sampleRate, bytes.data() + pos + 12, 4);
+            memcpy(&byteRate, bytes.data() + pos + 16, 4);
+            memcpy(&blockAlign, bytes.data() + pos + 20, 2);
+            memcpy(&bitsPerSample, bytes.data() + pos + 22, 2);
+
+            // 0xFFFE is WAVE_FORMAT_EXTENSIBLE, which TTS servers use for plain PCM too
+            if ((audioFormat != WAVE_FORMAT_PCM && audioFormat != 0xFFFE) || channels == 0 || blockAlign == 0) {
+                return WavHeaderStatus::Invalid;
+            }
+
+            fmt.wFormatTag = WAVE_FORMAT_PCM;
+            fmt.nChannels = channels;
+            fmt.nSamplesPerSec = sampleRate;
+            fmt.nAvgBytesPerSec = byteRate;
+            fmt.nBlockAlign = blockAlign;
+            fmt.wBitsPerSample = bitsPerSample;
+            fmt.cbSize = 0;
+            haveFmt = true;
+        }
+        else if (chunkSize > 1024 * 1024) {
+            return WavHeaderStatus::Invalid;  // Only the data chunk may be this large
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    // A real header never gets this long before the data chunk
+    return bytes.size() > 64 * 1024 ? WavHeaderStatus::Invalid : WavHeaderStatus::NeedMore;
+}
+
+// A clip downloaded in wire_format can only be decoded once complete
+bool SupportsStreamingPlayback() {
+    return (g_config.FormatEquals("wav") || g_config.FormatEquals("pcm")) && !DecodesWireFormat();
+}
+
+void PlayAudioStream(const std::shared_ptr<AudioStream>& stream) {
+    g_isPlaying = true;
+
+    uint8_t readBuf[8192];
+    std::vector<uint8_t> staging;
+    WAVEFORMATEX fmt = {};
+    size_t dataOffset = 0;
+    bool rawPcm = g_config.FormatEquals("pcm");
+
+    // --- 1. HEADER ---
+
+    while (!rawPcm && !g_shouldCancel) {
+        WavHeaderStatus status = ParseWavStreamHeader(staging, fmt, dataOffset);
+        if (status == WavHeaderStatus::Ok) {
+            break;
+        }
+        if (status == WavHeaderStatus::Invalid) {
+            if (staging.size() >= 4 && memcmp(staging.data(), "RIFF", 4) == 0) {
+                LOG_ERROR(L"Unsupported WAV header in streamed audio");
+                stream->Close();
+                g_isPlaying = false;
+                return;
+            }
+            // Same assumption as PlayAudioFromMemory: no RIFF tag means raw PCM
+            rawPcm = true;
+            break;
+        }
+        if (stream->IsDrained()) {
+            LOG_ERROR(L"Audio stream ended before any playable data arrived");
+            stream->Close();
+            g_isPlaying = false;
+            return;
+        }
+
+        size_t n = stream->Read(readBuf, sizeof(readBuf), std::chrono::milliseconds(100));
+        staging.insert(staging.end(), readBuf, readBuf + n);
+    }
+
+    if (rawPcm) {
+        fmt.wFormatTag = WAVE_FORMAT_PCM;
+        fmt.nChannels = 1;
+        fmt.nSamplesPerSec = 24000;
+        fmt.wBitsPerSample = 16;
+        fmt.nBlockAlign = 2;
+        fmt.nAvgBytesPerSec = 48000;
+        fmt.cbSize = 0;
+        dataOffset = 0;
+    }
+
+    staging.erase(staging.begin(), staging.begin() + std::min(dataOffset, staging.size()));
+
+    // --- 2. PRE-BUFFER ---
+
+    size_t prebufferBytes = static_cast<size_t>(fmt.nAvgBytesPerSec) * g_config.progressive_prebuffer_ms / 1000;
+    while (!g_shouldCancel && staging.size() < prebufferBytes &&
+        !stream->WaitForBuffered(prebufferBytes - staging.size(), std::chrono::milliseconds(50))) {
+    }
+
+    // --- 3. WAVEOUT PLAYBACK ---
+
+    HANDLE doneEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    HWAVEOUT hWaveOut = nullptr;
+    MMRESULT mmr = waveOutOpen(&hWaveOut, WAVE_MAPPER, &fmt, (DWORD_PTR)doneEvent, 0, CALLBACK_EVENT);
+    if (mmr != MMSYSERR_NOERROR) {
+        LOG_ERROR(L"waveOutOpen failed: " + std::to_wstring(mmr));
+        if (doneEvent) CloseHandle(doneEvent);
+        stream->Close();
+        g_isPlaying = false;
+        return;
+    }
+
+    // waveOut volume is 0-0xFFFF per channel (low word left, high word right)
+    DWORD channelVolume = static_cast<DWORD>(g_config.volume) * 0xFFFF / 100;
+    waveOutSetVolume(hWaveOut, channelVolume | (channelVolume << 16));
+
+    // ~100 ms per buffer, whole sample frames only
+    const size_t blockAlign = fmt.nBlockAlign;
+    const size_t bufferBytes = std::max(blockAlign, (fmt.nAvgBytesPerSec / 10) / blockAlign * blockAlign);
+    constexpr int NUM_BUFFERS = 4;
+
+    std::vector<uint8_t> buffers[NUM_BUFFERS];
+    WAVEHDR headers[NUM_BUFFERS] = {};
+    bool inFlight[NUM_BUFFERS] = {};
+    bool firstWrite = true;
+
+    while (!g_shouldCancel) {
+        int active = 0;
+
+        for (int i = 0; i < NUM_BUFFERS; ++i) {
+            if (inFlight[i] && (headers[i].dwFlags & WHDR_DONE)) {
+                waveOutUnprepareHeader(hWaveOut, &headers[i], sizeof(WAVEHDR));
+                inFlight[i] = false;
+            }
+            if (inFlight[i]) {
+                active++;
+                continue;
+            }
+
+            // Top up the staging area; don't wait long while audio is still queued
+            auto readTimeout = std::chrono::milliseconds(active > 0 ? 5 : 50);
+            while (staging.size() < bufferBytes) {
+                size_t n = stream->Read(readBuf, std::min(sizeof(readBuf), bufferBytes - staging.size()), readTimeout);
+                if (n == 0) break;
+                staging.insert(staging.end(), readBuf, readBuf + n);
+            }
+
+            size_t take = std::min(staging.size(), bufferBytes);
+            take -= take % blockAlign;
+            if (take == 0) {
+                break;
+            }
+
+            buffers[i].assign(staging.begin(), staging.begin() + take);
+            staging.erase(staging.begin(), staging.begin() + take);
+
+            headers[i] = {};
+            headers[i].lpData = reinterpret_cast<LPSTR>(buffers[i].data());
+            headers[i].dwBufferLength = static_cast<DWORD>(take);
+            waveOutPrepareHeader(hWaveOut, &headers[i], sizeof(WAVEHDR));
+            waveOutWrite(hWaveOut, &headers[i], sizeof(WAVEHDR));
+            inFlight[i] = true;
+            active++;
+
+            if (firstWrite) {
+                firstWrite = false;
+                stream->MarkFirstSound();
+                auto ttfa = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - stream->StartTime()).count();
+                LOG_INFO(L"Time to first audio: " + std::to_wstring(ttfa) + L" ms (progressive)");
+            }
+        }
+
+        if (active == 0 && stream->IsDrained() && staging.size() < blockAlign) {
+            break;  // Everything downloaded has been played
+        }
+
+        WaitForSingleObject(doneEvent, 20);
+    }
+
+    if (g_shouldCancel) {
+        waveOutReset(hWaveOut);  // Returns all queued buffers as done
+    }
+
+    for (int i = 0; i < NUM_BUFFERS; ++i) {
+        if (inFlight[i]) {
+            while (!(headers[i].dwFlags & WHDR_DONE)) {
+                WaitForSingleObject(doneEvent, 20);
+            }
+            waveOutUnprepareHeader(hWaveOut, &headers[i], sizeof(WAVEHDR));
+        }
+    }
+
+    waveOutClose(hWaveOut);
+    CloseHandle(doneEvent);
+
+    // Unblock the fetcher if playback was cancelled mid-download
+    stream->Close();
+
+    LOG_DEBUG(L"Streamed " + std::to_wstring(stream->TotalWritten()) + L" bytes, download took " +
+        std::to_wstring(stream->DownloadDuration().count()) + L" ms");
+
+    g_isPlaying = false;
+}
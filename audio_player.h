@@ -27,6 +27,9 @@
 #include <cstdint>
 #include <atomic>
 #include <string>
+#include <memory>
+
+class AudioStream;
 
 // Audio playback control
 extern std::atomic<bool> g_isPlaying;
@@ -35,4 +38,10 @@ extern std::atomic<bool> g_shouldCancel;
 // Audio playback function
 void PlayAudioFromMemory(const std::vector<uint8_t>& audioData, const std::string* cachedFilePath = nullptr);
 
+// Progressive playback of WAV/PCM while the response is still downloading
+void PlayAudioStream(const std::shared_ptr<AudioStream>& stream);
+
+// True if the configured format can be played progressively
+bool SupportsStreamingPlayback();
+
 #endif // TTS_STELLARIS_AUDIO_PLAYER_H
@@ -0,0 +1,241 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio_splitter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+// Level is measured over 10 ms frames
+static const int FRAMES_PER_SECOND = 100;
+
+// A pause between utterances lasts at least this long; commas are usually shorter
+static const size_t MIN_PAUSE_FRAMES = 12;
+
+// Quieter than this share of the loudest frame counts as silence
+static const double SILENCE_LEVEL = 0.05;
+
+// Each frame a pause sits away from its expected place costs this many frames of pause length
+static const double DISTANCE_PENALTY = 0.2;
+
+// A pause may be at most this share of the shorter neighbouring utterance away from where
+// the character counts put the boundary
+static const double MAX_DRIFT = 0.6;
+
+// Characters' worth of audio every utterance has regardless of length (lead-in, final pause)
+static const size_t FIXED_WEIGHT = 8;
+
+struct PcmFormat {
+    uint16_t channels = 1;
+    uint32_t sampleRate = 24000;
+    uint16_t bitsPerSample = 16;
+};
+
+// Find the sample data; raw PCM is what OpenAI-compatible servers send for format=pcm
+static bool LocatePcm(const std::vector<uint8_t>& audio, PcmFormat& format, size_t& offset, size_t& size) {
+    if (audio.size() < 12 || memcmp(audio.data(), "RIFF", 4) != 0) {
+        offset = 0;
+        size = audio.size();
+        return true;
+    }
+    if (memcmp(audio.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    bool haveFmt = false;
+    size_t pos = 12;
+    while (pos + 8 <= audio.size()) {
+        uint32_t chunkSize = 0;
+        memcpy(&chunkSize, audio.data() + pos + 4, 4);
+
+        if (memcmp(audio.data() + pos, "fmt ", 4) == 0) {
+            if (pos + 8 + 16 > audio.size()) {
+                return false;
+            }
+            uint16_t audioFormat;
+            memcpy(&audioFormat, audio.data() + pos + 8, 2);
+            memcpy(&format.channels, audio.data() + pos + 10, 2);
+            memcpy(&format.sampleRate, audio.data() + pos + 12, 4);
+            memcpy(&format.bitsPerSample, audio.data() + pos + 22, 2);
+            // 0xFFFE is WAVE_FORMAT_EXTENSIBLE, which TTS servers use for plain PCM too
+            // Below FRAMES_PER_SECOND a level frame would hold no samples
+            if ((audioFormat != 1 && audioFormat != 0xFFFE) || format.channels == 0 ||
+                format.sampleRate < FRAMES_PER_SECOND) {
+                return false;
+            }
+            haveFmt = true;
+        } else if (memcmp(audio.data() + pos, "data", 4) == 0) {
+            // Streaming servers write 0xFFFFFFFF here; the data runs to the end
+            offset = pos + 8;
+            size = std::min<size_t>(chunkSize, audio.size() - offset);
+            return haveFmt;
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+static void AppendWavClip(const PcmFormat& format, const uint8_t* samples, size_t size, std::vector<uint8_t>& clip) {
+    uint16_t audioFormat = 1;  // PCM
+    uint16_t blockAlign = static_cast<uint16_t>(format.channels * 2);
+    uint32_t byteRate = format.sampleRate * blockAlign;
+    uint32_t fmtSize = 16;
+    uint32_t dataSize = static_cast<uint32_t>(size);
+    uint32_t riffSize = dataSize + 36;
+
+    clip.resize(44);
+    memcpy(&clip[0], "RIFF", 4);
+    memcpy(&clip[4], &riffSize, 4);
+    memcpy(&clip[8], "WAVE", 4);
+    memcpy(&clip[12], "fmt ", 4);
+    memcpy(&clip[16], &fmtSize, 4);
+    memcpy(&clip[20], &audioFormat, 2);
+    memcpy(&clip[22], &format.channels, 2);
+    memcpy(&clip[24], &format.sampleRate, 4);
+    memcpy(&clip[28], &byteRate, 4);
+    memcpy(&clip[32], &blockAlign, 2);
+    memcpy(&clip[34], &format.bitsPerSample, 2);
+    memcpy(&clip[36], "data", 4);
+    memcpy(&clip[40], &dataSize, 4);
+    clip.insert(clip.end(), samples, samples + size);
+}
+
+bool SplitSpeechAudio(const std::vector<uint8_t>& audio, const std::vector<size_t>& weights,
+    std::vector<std::vector<uint8_t>>& clips, std::wstring& error) {
+    clips.clear();
+
+    PcmFormat format;
+    size_t dataOffset = 0;
+    size_t dataSize = 0;
+    if (!LocatePcm(audio, format, dataOffset, dataSize)) {
+        error = L"not a PCM WAV clip";
+        return false;
+    }
+    if (format.bitsPerSample != 16) {
+        error = L"only 16-bit audio can be split";
+        return false;
+    }
+
+    const uint8_t* samples = audio.data() + dataOffset;
+    size_t blockAlign = format.channels * 2;
+    size_t frameBytes = (format.sampleRate / FRAMES_PER_SECOND) * blockAlign;
+    size_t frameCount = dataSize / frameBytes;
+    if (weights.empty() || frameCount == 0) {
+        error = L"no audio";
+        return false;
+    }
+
+    // Mean absolute amplitude of each frame
+    std::vector<double> level(frameCount);
+    double loudest = 0.0;
+    for (size_t f = 0; f < frameCount; ++f) {
+        const uint8_t* frame = samples + f * frameBytes;
+        double sum = 0.0;
+        for (size_t i = 0; i + 1 < frameBytes; i += 2) {
+            int16_t sample;
+            memcpy(&sample, frame + i, 2);
+            sum += std::abs(static_cast<int>(sample));
+        }
+        level[f] = sum / (frameBytes / 2);
+        loudest = std::max(loudest, level[f]);
+    }
+
+    // Pauses: runs of quiet frames long enough to be between utterances, not at either end
+    struct Pause {
+        size_t start;
+        size_t length;
+        bool used;
+    };
+    std::vector<Pause> pauses;
+    double threshold = loudest * SILENCE_LEVEL;
+    size_t runStart = 0;
+    for (size_t f = 0; f <= frameCount; ++f) {
+        bool quiet = f < frameCount && level[f] <= threshold;
+        if (quiet) {
+            continue;
+        }
+        size_t length = f - runStart;
+        if (runStart > 0 && f < frameCount && length >= MIN_PAUSE_FRAMES) {
+            pauses.push_back({ runStart, length, false });
+        }
+        runStart = f + 1;
+    }
+
+    // Where each boundary should fall if audio length follows character count
+    std::vector<double> expectedLength;
+    double totalWeight = 0.0;
+    for (size_t weight : weights) {
+        expectedLength.push_back(static_cast<double>(weight + FIXED_WEIGHT));
+        totalWeight += weight + FIXED_WEIGHT;
+    }
+    for (double& length : expectedLength) {
+        length = length / totalWeight * frameCount;
+    }
+
+    // Best pause for each boundary in turn: long, and close to where it was expected
+    std::vector<size_t> cuts;
+    double expected = 0.0;
+    size_t previousCut = 0;
+    for (size_t b = 0; b + 1 < weights.size(); ++b) {
+        expected += expectedLength[b];
+        double maxDistance = std::min(expectedLength[b], expectedLength[b + 1]) * MAX_DRIFT;
+
+        Pause* best = nullptr;
+        double bestScore = 0.0;
+        for (Pause& pause : pauses) {
+            double center = pause.start + pause.length / 2.0;
+            double distance = center > expected ? center - expected : expected - center;
+            if (pause.used || pause.start < previousCut || distance > maxDistance) {
+                continue;
+            }
+            double score = pause.length - distance * DISTANCE_PENALTY;
+            if (!best || score > bestScore) {
+                best = &pause;
+                bestScore = score;
+            }
+        }
+        if (!best) {
+            error = L"no pause found after utterance " + std::to_wstring(b + 1) + L" of " +
+                std::to_wstring(weights.size());
+            return false;
+        }
+
+        best->used = true;
+        previousCut = best->start + best->length / 2;
+        cuts.push_back(previousCut);
+    }
+    cuts.push_back(frameCount);
+
+    // Each clip keeps half of the pause on either side of it
+    size_t from = 0;
+    for (size_t cut : cuts) {
+        size_t begin = from * frameBytes;
+        size_t end = cut == frameCount ? dataSize - dataSize % blockAlign : cut * frameBytes;
+        std::vector<uint8_t> clip;
+        AppendWavClip(format, samples + begin, end - begin, clip);
+        clips.push_back(std::move(clip));
+        from = cut;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_AUDIO_SPLITTER_H
+#define TTS_STELLARIS_AUDIO_SPLITTER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Cutting one synthesized clip back into the utterances it was made from (batching)
+
+// Split WAV or raw PCM (24 kHz mono, 16-bit) speech into weights.size() WAV
+// clips. Each cut goes in a pause near where the utterances' share of the
+// weights (their lengths in characters) puts it. Fails rather than cut
+// through speech when a boundary has no clear pause.
+bool SplitSpeechAudio(const std::vector<uint8_t>& audio, const std::vector<size_t>& weights,
+    std::vector<std::vector<uint8_t>>& clips, std::wstring& error);
+
+#endif // TTS_STELLARIS_AUDIO_SPLITTER_H
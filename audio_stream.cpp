@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "audio_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+AudioStream::AudioStream(size_t capacityBytes)
+    : frontOffset(0)
+    , bufferedBytes(0)
+    , totalWritten(0)
+    , capacity(capacityBytes)
+    , finished(false)
+    , succeeded(false)
+    , closed(false)
+    , full(false)
+    , startTime(std::chrono::steady_clock::now())
+    , finishTime(startTime)
+{}
+
+bool AudioStream::Write(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(streamMutex);
+
+    // Back-pressure: let the player catch up before buffering more
+    spaceCv.wait(lock, [this, size] {
+        return closed || bufferedBytes == 0 || bufferedBytes + size <= capacity;
+    });
+
+    if (closed) {
+        return false;
+    }
+
+    chunks.emplace_back(data, data + size);
+    bufferedBytes += size;
+    totalWritten += size;
+    dataCv.notify_all();
+    return true;
+}
+
+bool AudioStream::Append(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(streamMutex);
+    if (closed) {
+        return false;
+    }
+
+    chunks.emplace_back(data, data + size);
+    bufferedBytes += size;
+    totalWritten += size;
+    dataCv.notify_all();
+    return true;
+}
+
+bool AudioStream::HasSpace() {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    if (!closed && bufferedBytes >= capacity) {
+        full = true;
+    }
+    return !full;
+}
+
+void AudioStream::SetSpaceCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    onSpace = std::move(callback);
+}
+
+void AudioStream::Finish(bool success) {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    finished = true;
+    succeeded = success;
+    finishTime = std::chrono::steady_clock::now();
+    dataCv.notify_all();
+}
+
+size_t AudioStream::Read(uint8_t* dest, size_t maxBytes, std::chrono::milliseconds timeout) {
+    std::function<void()> resume;
+    std::unique_lock<std::mutex> lock(streamMutex);
+
+    if (!dataCv.wait_for(lock, timeout, [this] { return bufferedBytes > 0 || finished; })) {
+        return 0;
+    }
+
+    size_t copied = 0;
+    while (copied < maxBytes && !chunks.empty()) {
+        std::vector<uint8_t>& front = chunks.front();
+        size_t n = std::min(maxBytes - copied, front.size() - frontOffset);
+        memcpy(dest + copied, front.data() + frontOffset, n);
+        copied += n;
+        frontOffset += n;
+
+        if (frontOffset == front.size()) {
+            chunks.pop_front();
+            frontOffset = 0;
+        }
+    }
+
+    bufferedBytes -= copied;
+    if (copied > 0) {
+        spaceCv.notify_all();
+    }
+    if (full && bufferedBytes <= capacity / 2) {
+        full = false;
+        resume = onSpace;
+    }
+    lock.unlock();
+
+    // Outside the lock: it may wake the producer, which then writes
+    if (resume) {
+        resume();
+    }
+    return copied;
+}
+
+bool AudioStream::WaitForBuffered(size_t bytes, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(streamMutex);
+    return dataCv.wait_for(lock, timeout, [this, bytes] { return bufferedBytes >= bytes || finished; });
+}
+
+void AudioStream::Close() {
+    std::function<void()> resume;
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        closed = true;
+        chunks.clear();
+        frontOffset = 0;
+        bufferedBytes = 0;
+        spaceCv.notify_all();
+        if (full) {
+            full = false;
+            resume = onSpace;
+        }
+    }
+
+    // The producer finds the stream closed on its next write
+    if (resume) {
+        resume();
+    }
+}
+
+bool AudioStream::IsDrained() const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    return finished && bufferedBytes == 0;
+}
+
+bool AudioStream::Succeeded() const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    return succeeded;
+}
+
+size_t AudioStream::TotalWritten() const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    return totalWritten;
+}
+
+std::chrono::milliseconds AudioStream::DownloadDuration() const {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    auto end = finished ? finishTime : std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - startTime);
+}
@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_AUDIO_STREAM_H
+#define TTS_STELLARIS_AUDIO_STREAM_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// Bounded single-producer / single-consumer byte pipe between a fetch worker
+// and the playback coordinator, used for progressive playback
+// The fetcher writes response bytes as they arrive; the player starts
+// reading as soon as enough audio is buffered
+class AudioStream {
+private:
+    std::deque<std::vector<uint8_t>> chunks;
+    size_t frontOffset;      // Bytes already consumed from chunks.front()
+    size_t bufferedBytes;
+    size_t totalWritten;
+    size_t capacity;
+    bool finished;
+    bool succeeded;
+    bool closed;             // Consumer gone - further writes are dropped
+    bool full;               // HasSpace said no; cleared once half the buffer is read
+    std::function<void()> onSpace;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point finishTime;
+    std::chrono::steady_clock::time_point firstSoundTime;   // Consumer only, no lock
+    mutable std::mutex streamMutex;
+    std::condition_variable dataCv;
+    std::condition_variable spaceCv;
+
+public:
+    explicit AudioStream(size_t capacityBytes = 4 * 1024 * 1024);
+
+    // Producer side
+    // Blocks while the buffer is full; returns false once the consumer has closed the stream
+    bool Write(const uint8_t* data, size_t size);
+    // Same without waiting, for producers that must never block (the socket event loop)
+    // Such a producer checks HasSpace before it takes in more data
+    bool Append(const uint8_t* data, size_t size);
+    // False from when the buffer reaches capacity until the player has read
+    // half of it, or closes the stream; onSpace then runs on the player's thread
+    bool HasSpace();
+    void SetSpaceCallback(std::function<void()> callback);
+    void Finish(bool success);
+
+    // Consumer side
+    // Copies up to maxBytes, waiting at most timeout for data; returns 0 on timeout or end of stream
+    size_t Read(uint8_t* dest, size_t maxBytes, std::chrono::milliseconds timeout);
+
+    // Wait until at least `bytes` are buffered or the producer finished
+    bool WaitForBuffered(size_t bytes, std::chrono::milliseconds timeout);
+
+    // Stop consuming - unblocks a producer waiting for space
+    void Close();
+
+    // The player handed the first audio to the device
+    void MarkFirstSound() { firstSoundTime = std::chrono::steady_clock::now(); }
+    // Unset (epoch) if nothing was played
+    std::chrono::steady_clock::time_point FirstSoundTime() const { return firstSoundTime; }
+
+    bool IsDrained() const;     // Finished and everything has been read
+    bool Succeeded() const;
+    size_t TotalWritten() const;
+
+    std::chrono::steady_clock::time_point StartTime() const { return startTime; }
+    std::chrono::milliseconds DownloadDuration() const;
+};
+
+#endif // TTS_STELLARIS_AUDIO_STREAM_H
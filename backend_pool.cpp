@@ -0,0 +1,456 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "backend_pool.h"
+#include "http_transport.h"
+#include "fetch_thread_pool.h"
+#include "retry_policy.h"
+#include "cancellation.h"
+#include "config.h"
+#include "logger.h"
+
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+// Global backend pool instance
+BackendPool g_backendPool;
+
+// Latency samples lose half their influence after about 7 seconds (tau 10 s);
+// an idle backend's estimate decays the same way so it gets tried again
+static constexpr double EWMA_DECAY_SECONDS = 10.0;
+
+// The second pick must be this much cheaper to win
+static constexpr double COST_TIE_MARGIN = 1.25;
+
+// A failed request counts as at least this slow
+static constexpr double FAILURE_PENALTY_MS = 1000.0;
+
+static std::wstring Widen(const std::string& s) {
+    return std::wstring(s.begin(), s.end());
+}
+
+bool ParseBackendSpec(const std::string& spec, Backend& backend, std::wstring& error) {
+    std::istringstream stream(spec);
+    std::string token;
+
+    if (!(stream >> backend.url)) {
+        error = L"empty backend";
+        return false;
+    }
+
+    while (stream >> token) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            error = L"expected name=value, got " + Widen(token);
+            return false;
+        }
+
+        std::string name = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+
+        if (name == "weight") backend.weight = std::max(1, std::min(100, atoi(value.c_str())));
+        else if (name == "max_inflight") backend.maxInflight = std::max(0, atoi(value.c_str()));
+        else if (name == "rpm") backend.rpm = std::max(0, atoi(value.c_str()));
+        else if (name == "cpm") backend.cpm = std::max(0, atoi(value.c_str()));
+        else if (name == "metered") backend.metered = atoi(value.c_str()) != 0;
+        else if (name == "cache_group") backend.cacheGroup = value;
+        else if (name == "api_key") backend.apiKey = value;
+        else if (name == "model") backend.model = value;
+        else if (name == "voice") backend.voice = value;
+        else {
+            error = L"unknown option " + Widen(name);
+            return false;
+        }
+    }
+    return true;
+}
+
+void BackendPool::Configure() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    backends.clear();
+
+    std::vector<std::string> specs;
+    specs.push_back(g_config.server);
+    for (int i = 0; i < MAX_BACKENDS; ++i) {
+        if (g_config.backends[i][0] != '\0') {
+            specs.push_back(g_config.backends[i]);
+        }
+    }
+
+    for (const std::string& spec : specs) {
+        auto backend = std::make_unique<Backend>();
+        backend->apiKey = g_config.api_key;
+        backend->model = g_config.model;
+        backend->voice = g_config.voice;
+        backend->rpm = g_config.rate_limit_rpm;
+        backend->cpm = g_config.rate_limit_cpm;
+
+        std::wstring error;
+        if (!ParseBackendSpec(spec, *backend, error)) {
+            LOG_ERROR(L"Invalid backend \"" + Widen(spec) + L"\": " + error);
+            continue;
+        }
+
+        HttpRequest target;
+        if (!ParseHttpUrl(backend->url, target)) {
+            LOG_ERROR(L"Invalid backend URL: " + Widen(backend->url));
+            continue;
+        }
+
+        // The URL alone keeps single-server cache keys what they have always been
+        if (backend->cacheGroup.empty()) {
+            backend->cacheGroup = backend->url;
+        }
+        backend->name = target.host + ":" + std::to_string(target.port);
+        backend->breaker = &g_circuitBreakers.For(target.host, target.port);
+        backend->requestBucket.Configure(backend->rpm);
+        backend->charBucket.Configure(backend->cpm);
+        if (g_config.adaptive_concurrency) {
+            int ceiling = g_config.adaptive_max_concurrency;
+            if (backend->maxInflight > 0) {
+                ceiling = std::min(ceiling, backend->maxInflight);
+            }
+            backend->concurrency.Configure(g_config.max_fetch_threads, ceiling, g_config.adaptive_latency_tolerance);
+        }
+        backends.push_back(std::move(backend));
+    }
+
+    if (backends.size() > 1) {
+        for (const auto& backend : backends) {
+            LOG_INFO(L"Backend " + Widen(backend->url) + L": weight " + std::to_wstring(backend->weight) +
+                (backend->maxInflight > 0 ? L", max " + std::to_wstring(backend->maxInflight) + L" in flight" : L"") +
+                (backend->rpm > 0 ? L", " + std::to_wstring(backend->rpm) + L" requests/min" : L"") +
+                (backend->cpm > 0 ? L", " + std::to_wstring(backend->cpm) + L" chars/min" : L"") +
+                (backend->metered ? L"" : L", unmetered") +
+                L", cache group " + Widen(backend->cacheGroup));
+        }
+    }
+}
+
+bool BackendPool::HasRoomLocked(const Backend* backend) {
+    return (backend->maxInflight == 0 || backend->inflight < backend->maxInflight) &&
+        (!backend->concurrency.Enabled() || backend->inflight < backend->concurrency.Limit());
+}
+
+bool BackendPool::IsEligibleLocked(Backend* backend, const Backend* avoid, size_t chars, bool budgetLeft,
+    std::chrono::steady_clock::time_point now) {
+    return backend != avoid &&
+        HasRoomLocked(backend) &&
+        (budgetLeft || !backend->metered) &&
+        backend->breaker->IsAvailable() &&
+        backend->requestBucket.TimeUntil(1, now).count() == 0 &&
+        backend->charBucket.TimeUntil(static_cast<double>(chars), now).count() == 0;
+}
+
+Backend* BackendPool::PickLocked(const Backend* avoid, size_t chars) {
+    auto now = std::chrono::steady_clock::now();
+    bool budgetLeft = !g_spendGovernor.Exhausted();
+
+    std::vector<Backend*> candidates;
+    int totalWeight = 0;
+    for (auto& backend : backends) {
+        if (IsEligibleLocked(backend.get(), avoid, chars, budgetLeft, now)) {
+            candidates.push_back(backend.get());
+            totalWeight += backend->weight;
+        }
+    }
+
+    if (candidates.empty()) {
+        return nullptr;
+    }
+    if (candidates.size() == 1) {
+        return candidates[0];
+    }
+
+    static thread_local std::mt19937 rng(std::random_device{}());
+
+    // Two distinct candidates, each drawn in proportion to its weight
+    auto draw = [&](const Backend* skip) {
+        int limit = totalWeight - (skip ? skip->weight : 0);
+        int point = std::uniform_int_distribution<int>(0, limit - 1)(rng);
+        for (Backend* candidate : candidates) {
+            if (candidate == skip) continue;
+            if (point < candidate->weight) return candidate;
+            point -= candidate->weight;
+        }
+        return candidates.back();
+    };
+    Backend* first = draw(nullptr);
+    Backend* second = draw(first);
+
+    // Expected wait: latency estimate, decayed while idle, times the queue it would join
+    auto cost = [now](const Backend* backend) {
+        double idle = std::chrono::duration<double>(now - backend->lastSample).count();
+        double latency = backend->peakEwmaMs * std::exp(-idle / EWMA_DECAY_SECONDS);
+        return (latency + 1.0) * (backend->inflight + 1);
+    };
+    // Similar costs count as a tie, which goes to the first draw so weights still set the split
+    return cost(second) * COST_TIE_MARGIN < cost(first) ? second : first;
+}
+
+// Shortest wait until a backend that is otherwise free to take the request is within its rate limits
+std::chrono::milliseconds BackendPool::RateLimitWaitLocked(size_t chars) {
+    auto now = std::chrono::steady_clock::now();
+    bool budgetLeft = !g_spendGovernor.Exhausted();
+    auto shortest = std::chrono::milliseconds::max();
+
+    for (auto& backend : backends) {
+        if (HasRoomLocked(backend.get()) &&
+            (budgetLeft || !backend->metered) && backend->breaker->IsAvailable()) {
+            shortest = std::min(shortest, std::max(backend->requestBucket.TimeUntil(1, now),
+                backend->charBucket.TimeUntil(static_cast<double>(chars), now)));
+        }
+    }
+    return shortest;
+}
+
+bool BackendPool::BudgetExhaustedLocked() {
+    for (auto& backend : backends) {
+        if (!backend->metered) {
+            return false;
+        }
+    }
+    return g_spendGovernor.Exhausted();
+}
+
+bool BackendPool::BudgetExhausted() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return BudgetExhaustedLocked();
+}
+
+// A waiter that could take a backend right now, ahead of self in playback order
+bool BackendPool::OutrankedLocked(const Waiter& self) {
+    for (const Waiter* other : waiters) {
+        if (other != &self && other->priority < self.priority && PickLocked(nullptr, other->chars)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BackendPool::Lease BackendPool::Acquire(const Backend* avoid, size_t chars, uint64_t priority,
+    std::chrono::milliseconds maxWait, CancellationToken* cancel) {
+    // Registered before taking the lock: an already cancelled token runs the callback right away
+    CancellationRegistration wake(cancel, [this]() {
+        std::lock_guard<std::mutex> guard(poolMutex);
+        slotFreed.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lock(poolMutex);
+    if (backends.empty()) {
+        return Lease();
+    }
+
+    // Listed while waiting so a freed slot goes to the line that plays soonest
+    Waiter self{ priority, chars };
+    waiters.push_back(&self);
+    struct Unlist {
+        BackendPool* pool;
+        const Waiter* waiter;
+        ~Unlist() {
+            auto& list = pool->waiters;
+            list.erase(std::find(list.begin(), list.end(), waiter));
+            pool->slotFreed.notify_all();  // The next in line may be able to go now
+        }
+    } unlist{ this, &self };
+
+    auto deadline = std::chrono::steady_clock::now() + maxWait;
+    while (true) {
+        Backend* backend = nullptr;
+        if (!OutrankedLocked(self)) {
+            backend = PickLocked(avoid, chars);
+            if (!backend && avoid) {
+                backend = PickLocked(nullptr, chars);
+            }
+        }
+
+        if (backend) {
+            backend->requestBucket.Take(1);
+            backend->charBucket.Take(static_cast<double>(chars));
+            size_t charged = 0;
+            if (backend->metered && g_spendGovernor.TryCharge(chars)) {
+                charged = chars;
+            }
+            backend->inflight++;
+            backend->requests++;
+            return Lease(this, backend, charged, chars);
+        }
+
+        // Everything is down: hand out the first backend and let its breaker fail the request fast
+        bool anyUp = false;
+        for (auto& candidate : backends) {
+            anyUp = anyUp || candidate->breaker->IsAvailable();
+        }
+        if (!anyUp) {
+            Backend* fallback = backends[0].get();
+            fallback->inflight++;
+            return Lease(this, fallback, 0, chars);
+        }
+
+        // Out of budget stays that way; don't hold the request for nothing
+        if (BudgetExhaustedLocked()) {
+            return Lease();
+        }
+
+        // Wake for a freed slot, the next rate limit refill or the deadline, whichever comes first
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || (cancel && cancel->IsCancelled())) {
+            return Lease();
+        }
+        auto rateWait = RateLimitWaitLocked(chars);
+        auto wakeAt = rateWait < deadline - now ? now + rateWait : deadline;
+        slotFreed.wait_until(lock, wakeAt);
+    }
+}
+
+bool BackendPool::HasAlternative(const Backend* backend) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return PickLocked(backend, 0) != nullptr;
+}
+
+void BackendPool::Lease::RefundCharge() {
+    if (chargedChars > 0) {
+        g_spendGovernor.Refund(chargedChars);
+        chargedChars = 0;
+    }
+}
+
+void BackendPool::Lease::Finish(Result result, std::chrono::milliseconds responseTime) {
+    if (!pool || !backend) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pool->poolMutex);
+    pool->FinishLocked(backend, chargedChars, chars, overloaded, result, responseTime);
+    pool = nullptr;
+    backend = nullptr;
+}
+
+void BackendPool::FinishLocked(Backend* backend, size_t chargedChars, size_t chars, bool overloaded, Result result,
+    std::chrono::milliseconds responseTime) {
+    // Judged with this request still counted, as the server saw it
+    int oldLimit = backend->concurrency.Limit();
+    if (overloaded) {
+        backend->concurrency.OnOverload(responseTime);
+    } else if (result == Result::Success) {
+        backend->concurrency.OnResponse(responseTime, chars, backend->inflight);
+    }
+    if (backend->concurrency.Limit() != oldLimit) {
+        LOG_DEBUG(L"Backend " + Widen(backend->name) + L" concurrency limit " + std::to_wstring(oldLimit) +
+            L" -> " + std::to_wstring(backend->concurrency.Limit()) + (overloaded ? L" (server overloaded)" : L""));
+    }
+
+    backend->inflight--;
+    slotFreed.notify_all();
+
+    // Nothing was synthesized, so nothing was spent
+    if (result != Result::Success && chargedChars > 0) {
+        g_spendGovernor.Refund(chargedChars);
+    }
+
+    if (result == Result::Cancelled) {
+        return;
+    }
+
+    double sample = static_cast<double>(responseTime.count());
+    if (result == Result::Failure) {
+        backend->failures++;
+        sample = std::max(backend->peakEwmaMs * 2, FAILURE_PENALTY_MS);
+    }
+
+    // Peak EWMA: jump straight up to a slower sample, decay towards faster ones
+    auto now = std::chrono::steady_clock::now();
+    if (sample >= backend->peakEwmaMs) {
+        backend->peakEwmaMs = sample;
+    } else {
+        double elapsed = std::chrono::duration<double>(now - backend->lastSample).count();
+        double keep = std::exp(-elapsed / EWMA_DECAY_SECONDS);
+        backend->peakEwmaMs = backend->peakEwmaMs * keep + sample * (1.0 - keep);
+    }
+    backend->lastSample = now;
+
+    if (result == Result::Failure && backend->breaker->GetState() == CircuitBreaker::State::Open) {
+        ScheduleHealthCheckLocked(backend);
+    }
+}
+
+void BackendPool::ScheduleHealthCheckLocked(Backend* backend) {
+    if (backend->healthCheckPending) {
+        return;
+    }
+
+    backend->healthCheckPending = true;
+    if (!g_fetchThreadPool.EnqueueDelayed([this, backend]() { RunHealthCheck(backend); },
+        std::chrono::seconds(g_config.health_check_seconds), FETCH_PRIORITY_BACKGROUND)) {
+        backend->healthCheckPending = false;
+    }
+}
+
+// Runs on a fetch worker; any answer short of a 5xx means the server is back
+void BackendPool::RunHealthCheck(Backend* backend) {
+    HttpRequest request;
+    bool healthy = false;
+
+    if (ParseHttpUrl(backend->url + "/models", request)) {
+        request.method = "GET";
+        if (!backend->apiKey.empty()) {
+            request.headers = "Authorization: Bearer " + backend->apiKey + "\r\n";
+        }
+
+        std::wstring error;
+        std::unique_ptr<HttpResponse> response = GetHttpTransport().Send(request, error);
+        healthy = response && response->StatusCode() < 500;
+    }
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    backend->healthCheckPending = false;
+
+    if (healthy) {
+        LOG_INFO(L"Backend " + Widen(backend->name) + L" passed its health check");
+        backend->breaker->RecordSuccess();
+        backend->peakEwmaMs = 0.0;
+        slotFreed.notify_all();
+    } else if (backend->breaker->GetState() == CircuitBreaker::State::Open) {
+        ScheduleHealthCheckLocked(backend);
+    }
+}
+
+void BackendPool::LogStats() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (backends.size() < 2 && !g_config.adaptive_concurrency) {
+        return;
+    }
+
+    for (const auto& backend : backends) {
+        std::wstring limit;
+        if (backend->concurrency.Enabled()) {
+            limit = L", concurrency limit " + std::to_wstring(backend->concurrency.Limit()) + L" (peak " +
+                std::to_wstring(backend->concurrency.Peak()) + L", cut " +
+                std::to_wstring(backend->concurrency.Decreases()) + L" times)";
+        }
+        LOG_INFO(L"Backend " + Widen(backend->name) + L": " + std::to_wstring(backend->requests) + L" requests, " +
+            std::to_wstring(backend->failures) + L" failed, latency estimate " +
+            std::to_wstring(static_cast<long long>(backend->peakEwmaMs)) + L" ms" + limit);
+    }
+}
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_BACKEND_POOL_H
+#define TTS_STELLARIS_BACKEND_POOL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "rate_limiter.h"
+
+class CircuitBreaker;
+class CancellationToken;
+
+// One OpenAI-compatible server requests can be sent to
+struct Backend {
+    std::string url;             // Base URL, e.g. http://localhost:8880/v1
+    std::string name;            // host:port, for logs
+    std::string apiKey;
+    std::string model;
+    std::string voice;
+    std::string cacheGroup;      // Backends running the same voice model share cache entries
+    int weight = 1;
+    int maxInflight = 0;         // 0 = unlimited
+    int rpm = 0;                 // Requests per minute, 0 = unlimited
+    int cpm = 0;                 // Characters per minute, 0 = unlimited
+    bool metered = true;         // Counts against the speech budget
+    CircuitBreaker* breaker = nullptr;
+
+    // Routing state (guarded by the pool mutex)
+    int inflight = 0;
+    double peakEwmaMs = 0.0;
+    std::chrono::steady_clock::time_point lastSample;
+    bool healthCheckPending = false;
+    TokenBucket requestBucket;
+    TokenBucket charBucket;
+    ConcurrencyLimiter concurrency;
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+};
+
+// Parse "url [weight=N] [max_inflight=N] [rpm=N] [cpm=N] [metered=0|1] [cache_group=name]
+//        [api_key=..] [model=..] [voice=..]"
+// Options not given keep the values already in backend
+bool ParseBackendSpec(const std::string& spec, Backend& backend, std::wstring& error);
+
+// Spreads requests over the configured backends
+// Power of two choices: two backends are sampled by weight from those that are
+// up, below their concurrency limit, within their rate limits and (if metered)
+// covered by the speech budget, and the one with the lower peak-EWMA latency
+// times outstanding requests gets the request. A backend whose circuit breaker
+// opens is probed with GET /models until it answers again. With
+// adaptive_concurrency each backend's concurrency limit follows its latency
+// and overload answers (see ConcurrencyLimiter).
+class BackendPool {
+private:
+    std::vector<std::unique_ptr<Backend>> backends;
+    std::mutex poolMutex;
+    std::condition_variable slotFreed;
+
+    // Requests in Acquire; lower priority values are served first
+    struct Waiter {
+        uint64_t priority;
+        size_t chars;
+    };
+    std::vector<const Waiter*> waiters;
+
+    enum class Result {
+        Success,     // The server answered (any non-5xx status)
+        Failure,     // Connection error, 5xx or broken body
+        Cancelled    // Nothing learned about the server
+    };
+
+    bool HasRoomLocked(const Backend* backend);
+    bool IsEligibleLocked(Backend* backend, const Backend* avoid, size_t chars, bool budgetLeft,
+        std::chrono::steady_clock::time_point now);
+    Backend* PickLocked(const Backend* avoid, size_t chars);
+    bool OutrankedLocked(const Waiter& self);
+    std::chrono::milliseconds RateLimitWaitLocked(size_t chars);
+    bool BudgetExhaustedLocked();
+    void FinishLocked(Backend* backend, size_t chargedChars, size_t chars, bool overloaded, Result result,
+        std::chrono::milliseconds responseTime);
+    void ScheduleHealthCheckLocked(Backend* backend);
+    void RunHealthCheck(Backend* backend);
+
+public:
+    // A request's claim on a backend; reports back exactly once
+    class Lease {
+    private:
+        BackendPool* pool;
+        Backend* backend;
+        size_t chargedChars;     // Refunded to the speech budget unless the server answered
+        size_t chars;            // Length of the text, to judge the response time by
+        bool overloaded;
+
+        void Finish(Result result, std::chrono::milliseconds responseTime);
+
+    public:
+        Lease() : pool(nullptr), backend(nullptr), chargedChars(0), chars(0), overloaded(false) {}
+        Lease(BackendPool* p, Backend* b, size_t charged, size_t c)
+            : pool(p), backend(b), chargedChars(charged), chars(c), overloaded(false) {}
+        ~Lease() { Finish(Result::Cancelled, std::chrono::milliseconds(0)); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& other) noexcept : pool(other.pool), backend(other.backend), chargedChars(other.chargedChars),
+            chars(other.chars), overloaded(other.overloaded) {
+            other.pool = nullptr;
+            other.backend = nullptr;
+        }
+
+        explicit operator bool() const { return backend != nullptr; }
+        const Backend* Get() const { return backend; }
+
+        // The server answered 429 or 503; call before recording the result
+        void MarkOverloaded() { overloaded = true; }
+
+        // The server answered; responseTime is the wait for the response headers
+        void RecordSuccess(std::chrono::milliseconds responseTime) { Finish(Result::Success, responseTime); }
+        void RecordFailure() { Finish(Result::Failure, std::chrono::milliseconds(0)); }
+        void RecordCancelled() { Finish(Result::Cancelled, std::chrono::milliseconds(0)); }
+
+        // Nothing was synthesized: give the characters back to the speech budget
+        void RefundCharge();
+    };
+
+    // Build the list from "server" and backend1..backend8; call once before the first fetch
+    void Configure();
+
+    // Pick a backend for a text of chars characters, preferring any other than
+    // avoid. When every backend that is up is at its concurrency or rate limit,
+    // waits up to maxWait for one to have room, or until cancel fires. A slot
+    // goes to the waiting request with the lowest priority value (its priority
+    // class, then playback sequence number) that can use it. An empty lease means no backend could
+    // take the request.
+    Lease Acquire(const Backend* avoid, size_t chars, uint64_t priority, std::chrono::milliseconds maxWait,
+        CancellationToken* cancel = nullptr);
+
+    // The speech budget is used up and every backend is metered
+    bool BudgetExhausted();
+
+    // Is some backend other than this one up and below its limit
+    bool HasAlternative(const Backend* backend);
+
+    // All backends in config order; the list doesn't change after Configure
+    const std::vector<std::unique_ptr<Backend>>& Backends() const { return backends; }
+
+    void LogStats();
+};
+
+// Global backend pool instance
+extern BackendPool g_backendPool;
+
+#endif // TTS_STELLARIS_BACKEND_POOL_H
@@ -0,0 +1,62 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "cancellation.h"
+
+void CancellationToken::Cancel() {
+    // Callbacks run under the lock so Unregister can wait for one in progress
+    std::lock_guard<std::mutex> lock(tokenMutex);
+
+    if (cancelled.exchange(true)) {
+        return;
+    }
+
+    for (auto& entry : callbacks) {
+        entry.second();
+    }
+    callbacks.clear();
+}
+
+uint64_t CancellationToken::Register(std::function<void()> callback) {
+    std::unique_lock<std::mutex> lock(tokenMutex);
+
+    if (cancelled.load()) {
+        lock.unlock();
+        callback();
+        return 0;
+    }
+
+    uint64_t id = nextId++;
+    callbacks.emplace_back(id, std::move(callback));
+    return id;
+}
+
+void CancellationToken::Unregister(uint64_t id) {
+    std::lock_guard<std::mutex> lock(tokenMutex);
+
+    for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+        if (it->first == id) {
+            callbacks.erase(it);
+            return;
+        }
+    }
+}
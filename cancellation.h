@@ -0,0 +1,71 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_CANCELLATION_H
+#define TTS_STELLARIS_CANCELLATION_H
+
+#include <functional>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Cooperative cancellation shared between whoever owns a request and the
+// code doing the work. Blocking operations register a callback that aborts
+// them (e.g. closing a request handle), so Cancel() unblocks them promptly
+// instead of waiting for a timeout.
+class CancellationToken {
+private:
+    std::atomic<bool> cancelled{ false };
+    std::mutex tokenMutex;
+    std::vector<std::pair<uint64_t, std::function<void()>>> callbacks;
+    uint64_t nextId = 1;
+
+public:
+    bool IsCancelled() const { return cancelled.load(); }
+
+    // Runs every registered callback once; later calls do nothing
+    void Cancel();
+
+    // Returns 0 and runs the callback immediately if already cancelled
+    uint64_t Register(std::function<void()> callback);
+
+    // Once this returns the callback is not running and will never run
+    void Unregister(uint64_t id);
+};
+
+// Scoped callback registration - unregisters on destruction
+class CancellationRegistration {
+private:
+    CancellationToken* token;
+    uint64_t id;
+
+public:
+    CancellationRegistration(CancellationToken* t, std::function<void()> callback)
+        : token(t), id(t ? t->Register(std::move(callback)) : 0) {}
+    ~CancellationRegistration() { if (token && id) token->Unregister(id); }
+
+    CancellationRegistration(const CancellationRegistration&) = delete;
+    CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+};
+
+#endif // TTS_STELLARIS_CANCELLATION_H
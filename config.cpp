@@ -27,6 +27,7 @@
 #include <fstream>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
 
 // DLL Best Practices: Global config now only contains const char* and POD types
 // No std::string members means no complex static initialization
@@ -35,7 +36,11 @@ TTSConfig g_config;
 // Helper to copy string to buffer and update pointer
 void TTSConfig::SetString(const char* value, char* buffer, const char*& ptr) {
     if (value && value[0] != '\0') {
+#ifdef _WIN32
         strncpy_s(buffer, MAX_CONFIG_STRING_SIZE, value, _TRUNCATE);
+#else
+        strncpy(buffer, value, MAX_CONFIG_STRING_SIZE - 1);
+#endif
         buffer[MAX_CONFIG_STRING_SIZE - 1] = '\0';  // Ensure null termination
     } else {
         buffer[0] = '\0';
@@ -71,6 +76,42 @@ void TTSConfig::SetLogLevel(const char* value) {
     SetString(value, log_level_buf, log_level);
 }
 
+void TTSConfig::SetDiskAdmission(const char* value) {
+    SetString(value, disk_admission_buf, disk_admission);
+}
+
+void TTSConfig::SetStreamFormat(const char* value) {
+    SetString(value, stream_format_buf, stream_format);
+}
+
+void TTSConfig::SetTransport(const char* value) {
+    SetString(value, transport_buf, transport);
+}
+
+void TTSConfig::SetBackend(int index, const char* value) {
+    SetString(value, backends_buf[index], backends[index]);
+}
+
+void TTSConfig::SetBudgetExhausted(const char* value) {
+    SetString(value, budget_exhausted_buf, budget_exhausted);
+}
+
+void TTSConfig::SetWarmup(const char* value) {
+    SetString(value, warmup_buf, warmup);
+}
+
+void TTSConfig::SetWireFormat(const char* value) {
+    SetString(value, wire_format_buf, wire_format);
+}
+
+void TTSConfig::SetLocalVoice(const char* value) {
+    SetString(value, local_voice_buf, local_voice);
+}
+
+void TTSConfig::SetPriorityRule(int index, const char* value) {
+    SetString(value, priority_rules_buf[index], priority_rules[index]);
+}
+
 void TTSConfig::SetDefaults() {
     SetServer("http://localhost:5050/v1");
     SetModel("tts-1");
@@ -79,6 +120,19 @@ void TTSConfig::SetDefaults() {
     SetFormat("wav");
     SetCancelKey("F9");
     SetLogLevel("info");
+    SetDiskAdmission("always");
+    SetStreamFormat("audio");
+    for (int i = 0; i < MAX_BACKENDS; ++i) {
+        SetBackend(i, "");
+    }
+    SetTransport("wininet");
+    SetBudgetExhausted("cache_only");
+    SetWarmup("off");
+    SetWireFormat("");
+    SetLocalVoice("");
+    for (int i = 0; i < MAX_PRIORITY_RULES; ++i) {
+        SetPriorityRule(i, "");
+    }
 
     volume = 90;
     mute_original = true;
@@ -89,6 +143,44 @@ void TTSConfig::SetDefaults() {
     log_to_file = true;
     max_fetch_threads = 4;
     max_pending_fetches = 20;
+    disk_admission_min_chars = 40;
+    disk_admission_min_hits = 3;
+    keep_alive = true;
+    keep_alive_idle_seconds = 60;
+    progressive_playback = true;
+    progressive_prebuffer_ms = 300;
+    http2 = true;
+    http2_max_streams = 16;
+    max_retries = 3;
+    circuit_breaker_threshold = 5;
+    circuit_breaker_cooldown_seconds = 30;
+    hedging = false;
+    hedge_percentile = 90;
+    hedge_budget_percent = 10;
+    hedge_min_delay_ms = 500;
+    health_check_seconds = 10;
+    max_chunk_chars = 400;
+    first_chunk_chars = 120;
+    rate_limit_rpm = 0;
+    rate_limit_cpm = 0;
+    budget_session_chars = 0;
+    budget_daily_chars = 0;
+    async_fetch = false;
+    async_max_requests = 32;
+    line_timeout_seconds = 120;
+    adaptive_concurrency = 1;
+    adaptive_max_concurrency = 16;
+    adaptive_latency_tolerance = 200;
+    batch_max_chars = 0;
+    batch_window_ms = 80;
+    local_fallback = 0;
+    local_threads = 1;
+    slow_requests_logged = 5;
+    priority_classes = 0;
+    priority_low_max_chars = 80;
+    priority_high_min_chars = 300;
+    priority_low_timeout_seconds = 30;
+    priority_interrupt = 0;
 }
 
 bool ValidateConfig() {
@@ -114,12 +206,255 @@ bool ValidateConfig() {
 
     if (strcmp(g_config.format, "wav") != 0 && strcmp(g_config.format, "mp3") != 0 &&
         strcmp(g_config.format, "opus") != 0 && strcmp(g_config.format, "aac") != 0 &&
-        strcmp(g_config.format, "flac") != 0) {
+        strcmp(g_config.format, "flac") != 0 && strcmp(g_config.format, "pcm") != 0) {
         LOG_WARNING(L"Unknown format, defaulting to wav");
         g_config.SetFormat("wav");
         valid = false;
     }
 
+    // Decoding only produces PCM, so a compact wire format needs a wav or pcm player format
+    if (g_config.wire_format[0] != '\0') {
+        if (strcmp(g_config.wire_format, "mp3") != 0 && strcmp(g_config.wire_format, "opus") != 0 &&
+            strcmp(g_config.wire_format, "aac") != 0 && strcmp(g_config.wire_format, "flac") != 0) {
+            LOG_WARNING(L"Unknown wire_format, using the playback format");
+            g_config.SetWireFormat("");
+            valid = false;
+        } else if (strcmp(g_config.format, "wav") != 0 && strcmp(g_config.format, "pcm") != 0) {
+            LOG_WARNING(L"wire_format only applies with format=wav or format=pcm, ignoring it");
+            g_config.SetWireFormat("");
+            valid = false;
+        } else if (strcmp(g_config.stream_format, "sse") == 0) {
+            LOG_WARNING(L"wire_format can't be combined with stream_format=sse, ignoring it");
+            g_config.SetWireFormat("");
+            valid = false;
+        }
+    }
+
+    if (strcmp(g_config.stream_format, "audio") != 0 && strcmp(g_config.stream_format, "sse") != 0) {
+        LOG_WARNING(L"Unknown stream_format, defaulting to audio");
+        g_config.SetStreamFormat("audio");
+        valid = false;
+    }
+
+    if (strcmp(g_config.transport, "wininet") != 0 && strcmp(g_config.transport, "winhttp") != 0 &&
+        strcmp(g_config.transport, "socket") != 0) {
+        LOG_WARNING(L"Unknown transport, defaulting to wininet");
+        g_config.SetTransport("wininet");
+        valid = false;
+    }
+    if (g_config.async_fetch && !g_config.TransportEquals("socket")) {
+        LOG_WARNING(L"async_fetch needs transport=socket, fetching on worker threads");
+        g_config.async_fetch = false;
+        valid = false;
+    }
+
+    if (g_config.max_fetch_threads < 1) {
+        LOG_WARNING(L"max_fetch_threads < 1, setting to 1");
+        g_config.max_fetch_threads = 1;
+        valid = false;
+    }
+
+    if (g_config.max_retries < 1) {
+        LOG_WARNING(L"max_retries < 1, setting to 1");
+        g_config.max_retries = 1;
+        valid = false;
+    }
+    if (g_config.max_retries > 10) {
+        LOG_WARNING(L"max_retries > 10, setting to 10");
+        g_config.max_retries = 10;
+        valid = false;
+    }
+
+    if (g_config.circuit_breaker_threshold < 0) {
+        LOG_WARNING(L"circuit_breaker_threshold < 0, disabling circuit breaker");
+        g_config.circuit_breaker_threshold = 0;
+        valid = false;
+    }
+    if (g_config.circuit_breaker_cooldown_seconds < 1) {
+        LOG_WARNING(L"circuit_breaker_cooldown_seconds < 1, setting to 1");
+        g_config.circuit_breaker_cooldown_seconds = 1;
+        valid = false;
+    }
+
+    if (g_config.hedge_percentile < 50 || g_config.hedge_percentile > 99) {
+        LOG_WARNING(L"hedge_percentile must be 50-99, setting to 90");
+        g_config.hedge_percentile = 90;
+        valid = false;
+    }
+    if (g_config.hedge_budget_percent < 1 || g_config.hedge_budget_percent > 100) {
+        LOG_WARNING(L"hedge_budget_percent must be 1-100, setting to 10");
+        g_config.hedge_budget_percent = 10;
+        valid = false;
+    }
+    if (g_config.hedge_min_delay_ms < 0) {
+        LOG_WARNING(L"hedge_min_delay_ms < 0, setting to 0");
+        g_config.hedge_min_delay_ms = 0;
+        valid = false;
+    }
+
+    if (g_config.max_chunk_chars < 50 || g_config.max_chunk_chars > 4000) {
+        LOG_WARNING(L"max_chunk_chars must be 50-4000, setting to 400");
+        g_config.max_chunk_chars = 400;
+        valid = false;
+    }
+    if (g_config.first_chunk_chars < 20 || g_config.first_chunk_chars > g_config.max_chunk_chars) {
+        LOG_WARNING(L"first_chunk_chars must be between 20 and max_chunk_chars, setting to " +
+            std::to_wstring(std::min(120, g_config.max_chunk_chars)));
+        g_config.first_chunk_chars = std::min(120, g_config.max_chunk_chars);
+        valid = false;
+    }
+    if (g_config.batch_max_chars < 0 || g_config.batch_max_chars > g_config.max_chunk_chars) {
+        LOG_WARNING(L"batch_max_chars must be between 0 and max_chunk_chars, setting to 0 (no batching)");
+        g_config.batch_max_chars = 0;
+        valid = false;
+    }
+    if (g_config.local_threads < 1 || g_config.local_threads > 4) {
+        LOG_WARNING(L"local_threads must be 1-4, setting to 1");
+        g_config.local_threads = 1;
+        valid = false;
+    }
+    if (g_config.slow_requests_logged < 0 || g_config.slow_requests_logged > 50) {
+        LOG_WARNING(L"slow_requests_logged must be 0-50, setting to 5");
+        g_config.slow_requests_logged = 5;
+        valid = false;
+    }
+    if (g_config.batch_window_ms < 0 || g_config.batch_window_ms > 1000) {
+        LOG_WARNING(L"batch_window_ms must be 0-1000, setting to 80");
+        g_config.batch_window_ms = 80;
+        valid = false;
+    }
+
+    if (g_config.rate_limit_rpm < 0) {
+        LOG_WARNING(L"rate_limit_rpm < 0, setting to 0 (unlimited)");
+        g_config.rate_limit_rpm = 0;
+        valid = false;
+    }
+    if (g_config.rate_limit_cpm < 0) {
+        LOG_WARNING(L"rate_limit_cpm < 0, setting to 0 (unlimited)");
+        g_config.rate_limit_cpm = 0;
+        valid = false;
+    }
+    if (g_config.budget_session_chars < 0) {
+        LOG_WARNING(L"budget_session_chars < 0, setting to 0 (unlimited)");
+        g_config.budget_session_chars = 0;
+        valid = false;
+    }
+    if (g_config.budget_daily_chars < 0) {
+        LOG_WARNING(L"budget_daily_chars < 0, setting to 0 (unlimited)");
+        g_config.budget_daily_chars = 0;
+        valid = false;
+    }
+    if (strcmp(g_config.budget_exhausted, "cache_only") != 0 && strcmp(g_config.budget_exhausted, "original_voice") != 0) {
+        LOG_WARNING(L"Invalid budget_exhausted value, using cache_only");
+        g_config.SetBudgetExhausted("cache_only");
+        valid = false;
+    }
+    if (strcmp(g_config.warmup, "off") != 0 && strcmp(g_config.warmup, "connect") != 0 &&
+        strcmp(g_config.warmup, "synthesize") != 0) {
+        LOG_WARNING(L"Invalid warmup value, using off");
+        g_config.SetWarmup("off");
+        valid = false;
+    }
+
+    if (g_config.health_check_seconds < 1) {
+        LOG_WARNING(L"health_check_seconds < 1, setting to 1");
+        g_config.health_check_seconds = 1;
+        valid = false;
+    }
+
+    if (g_config.async_max_requests < 1) {
+        LOG_WARNING(L"async_max_requests < 1, setting to 1");
+        g_config.async_max_requests = 1;
+        valid = false;
+    }
+    if (g_config.async_max_requests > 256) {
+        LOG_WARNING(L"async_max_requests > 256, setting to 256");
+        g_config.async_max_requests = 256;
+        valid = false;
+    }
+
+    if (g_config.http2_max_streams < 1) {
+        LOG_WARNING(L"http2_max_streams < 1, setting to 1");
+        g_config.http2_max_streams = 1;
+        valid = false;
+    }
+    if (g_config.http2_max_streams > 64) {
+        LOG_WARNING(L"http2_max_streams > 64, setting to 64");
+        g_config.http2_max_streams = 64;
+        valid = false;
+    }
+
+    if (strcmp(g_config.disk_admission, "always") != 0 && strcmp(g_config.disk_admission, "second_access") != 0 &&
+        strcmp(g_config.disk_admission, "min_length") != 0 && strcmp(g_config.disk_admission, "frequency") != 0) {
+        LOG_WARNING(L"Unknown disk_admission policy, defaulting to always");
+        g_config.SetDiskAdmission("always");
+        valid = false;
+    }
+
+    if (g_config.disk_admission_min_hits < 1) {
+        LOG_WARNING(L"disk_admission_min_hits < 1, setting to 1");
+        g_config.disk_admission_min_hits = 1;
+        valid = false;
+    }
+    if (g_config.disk_admission_min_hits > 15) {
+        LOG_WARNING(L"disk_admission_min_hits > 15, setting to 15");
+        g_config.disk_admission_min_hits = 15;
+        valid = false;
+    }
+
+    if (g_config.line_timeout_seconds < 0) {
+        LOG_WARNING(L"line_timeout_seconds < 0, setting to 0 (no timeout)");
+        g_config.line_timeout_seconds = 0;
+        valid = false;
+    }
+    if (g_config.priority_low_timeout_seconds < 0) {
+        LOG_WARNING(L"priority_low_timeout_seconds < 0, setting to 0 (line_timeout_seconds applies)");
+        g_config.priority_low_timeout_seconds = 0;
+        valid = false;
+    }
+    if (g_config.priority_low_max_chars < 0) {
+        LOG_WARNING(L"priority_low_max_chars < 0, setting to 0 (no line is low by length)");
+        g_config.priority_low_max_chars = 0;
+        valid = false;
+    }
+    if (g_config.priority_high_min_chars <= g_config.priority_low_max_chars) {
+        LOG_WARNING(L"priority_high_min_chars must be above priority_low_max_chars, setting to " +
+            std::to_wstring(g_config.priority_low_max_chars + 1));
+        g_config.priority_high_min_chars = g_config.priority_low_max_chars + 1;
+        valid = false;
+    }
+    if (g_config.adaptive_max_concurrency < 1) {
+        LOG_WARNING(L"adaptive_max_concurrency < 1, setting to 1");
+        g_config.adaptive_max_concurrency = 1;
+        valid = false;
+    }
+    if (g_config.adaptive_max_concurrency > 64) {
+        LOG_WARNING(L"adaptive_max_concurrency > 64, setting to 64");
+        g_config.adaptive_max_concurrency = 64;
+        valid = false;
+    }
+    if (g_config.adaptive_latency_tolerance < 110) {
+        LOG_WARNING(L"adaptive_latency_tolerance < 110, setting to 110");
+        g_config.adaptive_latency_tolerance = 110;
+        valid = false;
+    }
+    if (g_config.keep_alive_idle_seconds < 1) {
+        LOG_WARNING(L"keep_alive_idle_seconds < 1, setting to 1");
+        g_config.keep_alive_idle_seconds = 1;
+        valid = false;
+    }
+
+    if (g_config.progressive_prebuffer_ms < 0) {
+        LOG_WARNING(L"progressive_prebuffer_ms < 0, setting to 0");
+        g_config.progressive_prebuffer_ms = 0;
+        valid = false;
+    }
+    if (g_config.progressive_prebuffer_ms > 5000) {
+        LOG_WARNING(L"progressive_prebuffer_ms > 5000, setting to 5000");
+        g_config.progressive_prebuffer_ms = 5000;
+        valid = false;
+    }
+
     if (!valid) {
         LOG_WARNING(L"Configuration validation failed, some values were corrected");
     }
@@ -169,6 +504,69 @@ bool LoadConfig(const std::string& filename) {
         else if (key == "log_to_file") g_config.log_to_file = (std::stoi(value) != 0);
         else if (key == "max_fetch_threads") g_config.max_fetch_threads = std::stoi(value);
         else if (key == "max_pending_fetches") g_config.max_pending_fetches = std::stoi(value);
+        else if (key == "disk_admission") g_config.SetDiskAdmission(value.c_str());
+        else if (key == "disk_admission_min_chars") g_config.disk_admission_min_chars = std::stoi(value);
+        else if (key == "disk_admission_min_hits") g_config.disk_admission_min_hits = std::stoi(value);
+        else if (key == "keep_alive") g_config.keep_alive = (std::stoi(value) != 0);
+        else if (key == "keep_alive_idle_seconds") g_config.keep_alive_idle_seconds = std::stoi(value);
+        else if (key == "progressive_playback") g_config.progressive_playback = (std::stoi(value) != 0);
+        else if (key == "progressive_prebuffer_ms") g_config.progressive_prebuffer_ms = std::stoi(value);
+        else if (key == "stream_format") g_config.SetStreamFormat(value.c_str());
+        else if (key == "transport") g_config.SetTransport(value.c_str());
+        else if (key == "http2") g_config.http2 = (std::stoi(value) != 0);
+        else if (key == "http2_max_streams") g_config.http2_max_streams = std::stoi(value);
+        else if (key == "max_retries") g_config.max_retries = std::stoi(value);
+        else if (key == "circuit_breaker_threshold") g_config.circuit_breaker_threshold = std::stoi(value);
+        else if (key == "circuit_breaker_cooldown_seconds") g_config.circuit_breaker_cooldown_seconds = std::stoi(value);
+        else if (key == "hedging") g_config.hedging = (std::stoi(value) != 0);
+        else if (key == "hedge_percentile") g_config.hedge_percentile = std::stoi(value);
+        else if (key == "hedge_budget_percent") g_config.hedge_budget_percent = std::stoi(value);
+        else if (key == "hedge_min_delay_ms") g_config.hedge_min_delay_ms = std::stoi(value);
+        else if (key == "health_check_seconds") g_config.health_check_seconds = std::stoi(value);
+        else if (key.compare(0, 7, "backend") == 0 && key.size() > 7 && isdigit(static_cast<unsigned char>(key[7]))) {
+            int index = std::stoi(key.substr(7));
+            if (index >= 1 && index <= MAX_BACKENDS) {
+                g_config.SetBackend(index - 1, value.c_str());
+            } else {
+                LOG_WARNING(L"Ignoring " + std::wstring(key.begin(), key.end()) + L", backends are numbered 1-" +
+                    std::to_wstring(MAX_BACKENDS));
+            }
+        }
+        else if (key == "max_chunk_chars") g_config.max_chunk_chars = std::stoi(value);
+        else if (key == "first_chunk_chars") g_config.first_chunk_chars = std::stoi(value);
+        else if (key == "rate_limit_rpm") g_config.rate_limit_rpm = std::stoi(value);
+        else if (key == "rate_limit_cpm") g_config.rate_limit_cpm = std::stoi(value);
+        else if (key == "budget_session_chars") g_config.budget_session_chars = std::stoi(value);
+        else if (key == "budget_daily_chars") g_config.budget_daily_chars = std::stoi(value);
+        else if (key == "budget_exhausted") g_config.SetBudgetExhausted(value.c_str());
+        else if (key == "async_fetch") g_config.async_fetch = (std::stoi(value) != 0);
+        else if (key == "async_max_requests") g_config.async_max_requests = std::stoi(value);
+        else if (key == "warmup") g_config.SetWarmup(value.c_str());
+        else if (key == "line_timeout_seconds") g_config.line_timeout_seconds = std::stoi(value);
+        else if (key == "wire_format") g_config.SetWireFormat(value.c_str());
+        else if (key == "adaptive_concurrency") g_config.adaptive_concurrency = (std::stoi(value) != 0);
+        else if (key == "adaptive_max_concurrency") g_config.adaptive_max_concurrency = std::stoi(value);
+        else if (key == "adaptive_latency_tolerance") g_config.adaptive_latency_tolerance = std::stoi(value);
+        else if (key == "batch_max_chars") g_config.batch_max_chars = std::stoi(value);
+        else if (key == "batch_window_ms") g_config.batch_window_ms = std::stoi(value);
+        else if (key == "local_fallback") g_config.local_fallback = (std::stoi(value) != 0);
+        else if (key == "local_threads") g_config.local_threads = std::stoi(value);
+        else if (key == "local_voice") g_config.SetLocalVoice(value.c_str());
+        else if (key == "slow_requests_logged") g_config.slow_requests_logged = std::stoi(value);
+        else if (key == "priority_classes") g_config.priority_classes = (std::stoi(value) != 0);
+        else if (key == "priority_low_max_chars") g_config.priority_low_max_chars = std::stoi(value);
+        else if (key == "priority_high_min_chars") g_config.priority_high_min_chars = std::stoi(value);
+        else if (key == "priority_low_timeout_seconds") g_config.priority_low_timeout_seconds = std::stoi(value);
+        else if (key == "priority_interrupt") g_config.priority_interrupt = (std::stoi(value) != 0);
+        else if (key.compare(0, 13, "priority_rule") == 0 && key.size() > 13 && isdigit(static_cast<unsigned char>(key[13]))) {
+            int index = std::stoi(key.substr(13));
+            if (index >= 1 && index <= MAX_PRIORITY_RULES) {
+                g_config.SetPriorityRule(index - 1, value.c_str());
+            } else {
+                LOG_WARNING(L"Ignoring " + std::wstring(key.begin(), key.end()) + L", priority rules are numbered 1-" +
+                    std::to_wstring(MAX_PRIORITY_RULES));
+            }
+        }
     }
 
     // Convert config strings to wstring for logging
@@ -178,20 +576,82 @@ bool LoadConfig(const std::string& filename) {
     std::string format_str(g_config.format);
     std::string cancel_key_str(g_config.cancel_key);
     std::string log_level_str(g_config.log_level);
+    std::string disk_admission_str(g_config.disk_admission);
+    std::string stream_format_str(g_config.stream_format);
+    std::string transport_str(g_config.transport);
+    std::string budget_exhausted_str(g_config.budget_exhausted);
+    std::string warmup_str(g_config.warmup);
+    std::string wire_format_str(g_config.wire_format);
+    std::string local_voice_str(g_config.local_voice);
 
     LOG_INFO(L"Config loaded successfully");
+    // Only the URL - server settings may include an API key
+    server_str = server_str.substr(0, server_str.find(' '));
     LOG_INFO(L"  Server: " + std::wstring(server_str.begin(), server_str.end()));
     LOG_INFO(L"  Model: " + std::wstring(model_str.begin(), model_str.end()));
     LOG_INFO(L"  Voice: " + std::wstring(voice_str.begin(), voice_str.end()));
     LOG_INFO(L"  Format: " + std::wstring(format_str.begin(), format_str.end()));
     LOG_INFO(L"  Volume: " + std::to_wstring(g_config.volume) + L"%");
     LOG_INFO(L"  Mute Original: " + std::wstring(g_config.mute_original ? L"Yes" : L"No"));
+    LOG_INFO(L"  Local Fallback: " + (g_config.local_fallback
+        ? (local_voice_str.empty() ? std::wstring(L"default voice") : std::wstring(local_voice_str.begin(), local_voice_str.end())) +
+            L", " + std::to_wstring(g_config.local_threads) + L" thread(s)" : std::wstring(L"Disabled")));
     LOG_INFO(L"  Cancel Key: " + std::wstring(cancel_key_str.begin(), cancel_key_str.end()));
     LOG_INFO(L"  Max Cache Size: " + std::to_wstring(g_config.max_cache_size));
     LOG_INFO(L"  Log Level: " + std::wstring(log_level_str.begin(), log_level_str.end()));
     LOG_INFO(L"  Log to File: " + std::wstring(g_config.log_to_file ? L"Enabled" : L"Disabled"));
+    LOG_INFO(L"  Slow Requests Logged: " + std::to_wstring(g_config.slow_requests_logged));
     LOG_INFO(L"  Max Fetch Threads: " + std::to_wstring(g_config.max_fetch_threads));
+    LOG_INFO(L"  Adaptive Concurrency: " + (g_config.adaptive_concurrency
+        ? L"up to " + std::to_wstring(g_config.adaptive_max_concurrency) + L" per server (latency tolerance " +
+            std::to_wstring(g_config.adaptive_latency_tolerance) + L"%)" : std::wstring(L"Disabled")));
     LOG_INFO(L"  Max Pending Fetches: " + std::to_wstring(g_config.max_pending_fetches));
+    LOG_INFO(L"  Line Timeout: " + (g_config.line_timeout_seconds > 0
+        ? std::to_wstring(g_config.line_timeout_seconds) + L"s" : std::wstring(L"None")));
+    LOG_INFO(L"  Priority Classes: " + (g_config.priority_classes
+        ? L"low up to " + std::to_wstring(g_config.priority_low_max_chars) + L" characters, high from " +
+            std::to_wstring(g_config.priority_high_min_chars) + L", low lines dropped after " +
+            (g_config.priority_low_timeout_seconds > 0 ? std::to_wstring(g_config.priority_low_timeout_seconds) + L"s" :
+                std::wstring(L"the line timeout")) +
+            (g_config.priority_interrupt ? L", interrupting lower classes" : L"") : std::wstring(L"Disabled")));
+    LOG_INFO(L"  Disk Admission: " + std::wstring(disk_admission_str.begin(), disk_admission_str.end()) +
+        (g_config.DiskAdmissionEquals("frequency") ? L" (" + std::to_wstring(g_config.disk_admission_min_hits) + L" hits)" :
+            g_config.DiskAdmissionEquals("min_length") ? L" (" + std::to_wstring(g_config.disk_admission_min_chars) + L" chars)" :
+            std::wstring()));
+    LOG_INFO(L"  Keep-Alive: " + std::wstring(g_config.keep_alive ? L"Enabled" : L"Disabled") +
+        L" (idle " + std::to_wstring(g_config.keep_alive_idle_seconds) + L"s)");
+    LOG_INFO(L"  Progressive Playback: " + std::wstring(g_config.progressive_playback ? L"Enabled" : L"Disabled") +
+        L" (prebuffer " + std::to_wstring(g_config.progressive_prebuffer_ms) + L" ms)");
+    LOG_INFO(L"  Text Pieces: first " + std::to_wstring(g_config.first_chunk_chars) + L", then " +
+        std::to_wstring(g_config.max_chunk_chars) + L" characters");
+    LOG_INFO(L"  Batching: " + (g_config.batch_max_chars > 0
+        ? L"up to " + std::to_wstring(g_config.batch_max_chars) + L" characters, collected for " +
+            std::to_wstring(g_config.batch_window_ms) + L" ms" : std::wstring(L"Disabled")));
+    LOG_INFO(L"  Stream Format: " + std::wstring(stream_format_str.begin(), stream_format_str.end()));
+    LOG_INFO(L"  Max Attempts: " + std::to_wstring(g_config.max_retries));
+    LOG_INFO(L"  Circuit Breaker: " + (g_config.circuit_breaker_threshold > 0 ?
+        std::to_wstring(g_config.circuit_breaker_threshold) + L" failures, " +
+        std::to_wstring(g_config.circuit_breaker_cooldown_seconds) + L"s cooldown" : std::wstring(L"Disabled")));
+    LOG_INFO(L"  Hedging: " + (g_config.hedging ?
+        L"p" + std::to_wstring(g_config.hedge_percentile) + L", budget " +
+        std::to_wstring(g_config.hedge_budget_percent) + L"%" : std::wstring(L"Disabled")));
+    LOG_INFO(L"  Transport: " + std::wstring(transport_str.begin(), transport_str.end()) +
+        (g_config.TransportEquals("winhttp") && g_config.http2 ?
+            L" (HTTP/2, " + std::to_wstring(g_config.http2_max_streams) + L" streams)" : L"") +
+        (g_config.TransportEquals("socket") && g_config.async_fetch ?
+            L" (event loop, " + std::to_wstring(g_config.async_max_requests) + L" requests)" : L""));
+    LOG_INFO(L"  Rate Limit: " +
+        (g_config.rate_limit_rpm > 0 ? std::to_wstring(g_config.rate_limit_rpm) + L" requests/min" : std::wstring(L"no request limit")) + L", " +
+        (g_config.rate_limit_cpm > 0 ? std::to_wstring(g_config.rate_limit_cpm) + L" chars/min" : std::wstring(L"no character limit")));
+    if (g_config.budget_session_chars > 0 || g_config.budget_daily_chars > 0) {
+        LOG_INFO(L"  Budget: " +
+            (g_config.budget_session_chars > 0 ? std::to_wstring(g_config.budget_session_chars) : std::wstring(L"unlimited")) + L" chars/session, " +
+            (g_config.budget_daily_chars > 0 ? std::to_wstring(g_config.budget_daily_chars) : std::wstring(L"unlimited")) + L" chars/day, then " +
+            std::wstring(budget_exhausted_str.begin(), budget_exhausted_str.end()));
+    }
+    LOG_INFO(L"  Warm-up: " + std::wstring(warmup_str.begin(), warmup_str.end()));
+    LOG_INFO(L"  Wire Format: " + (wire_format_str.empty() ? std::wstring(L"same as format") :
+        std::wstring(wire_format_str.begin(), wire_format_str.end()) + L" (decoded locally)"));
 
     // Set the log level
     g_logger.SetLogLevel(std::wstring(log_level_str.begin(), log_level_str.end()));
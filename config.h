@@ -31,6 +31,12 @@
 // Maximum string sizes for config values
 constexpr size_t MAX_CONFIG_STRING_SIZE = 256;
 
+// Additional servers: backend1 .. backend8
+constexpr int MAX_BACKENDS = 8;
+
+// Priority class rules: priority_rule1 .. priority_rule8
+constexpr int MAX_PRIORITY_RULES = 8;
+
 // DLL Best Practices: Use const char* and fixed buffers instead of std::string
 // in global struct to avoid complex static initialization issues
 struct TTSConfig {
@@ -42,7 +48,16 @@ struct TTSConfig {
     const char* format;
     const char* cancel_key;
     const char* log_level;
+    const char* disk_admission;
 
+    const char* stream_format;
+    const char* transport;
+    const char* backends[MAX_BACKENDS];   // Empty entries are unused
+    const char* budget_exhausted;
+    const char* warmup;
+    const char* wire_format;
+    const char* local_voice;
+    const char* priority_rules[MAX_PRIORITY_RULES];   // Empty entries are unused
     // Non-string members
     int volume;
     bool mute_original;
@@ -53,6 +68,44 @@ struct TTSConfig {
     bool log_to_file;
     int max_fetch_threads;
     int max_pending_fetches;
+    int disk_admission_min_chars;
+    int disk_admission_min_hits;
+    bool keep_alive;
+    int keep_alive_idle_seconds;
+    bool progressive_playback;
+    int progressive_prebuffer_ms;
+    bool http2;
+    int http2_max_streams;
+    int max_retries;
+    int circuit_breaker_threshold;
+    int circuit_breaker_cooldown_seconds;
+    bool hedging;
+    int hedge_percentile;
+    int hedge_budget_percent;
+    int hedge_min_delay_ms;
+    int health_check_seconds;
+    int max_chunk_chars;
+    int first_chunk_chars;
+    int rate_limit_rpm;
+    int rate_limit_cpm;
+    int budget_session_chars;
+    int budget_daily_chars;
+    bool async_fetch;
+    int async_max_requests;
+    int line_timeout_seconds;
+    bool adaptive_concurrency;
+    int adaptive_max_concurrency;
+    int adaptive_latency_tolerance;
+    int batch_max_chars;
+    int batch_window_ms;
+    bool local_fallback;
+    int local_threads;
+    int slow_requests_logged;
+    bool priority_classes;
+    int priority_low_max_chars;
+    int priority_high_min_chars;
+    int priority_low_timeout_seconds;
+    bool priority_interrupt;
 
     // Internal storage buffers (private - use setters to modify)
     char server_buf[MAX_CONFIG_STRING_SIZE];
@@ -62,6 +115,15 @@ struct TTSConfig {
     char format_buf[MAX_CONFIG_STRING_SIZE];
     char cancel_key_buf[MAX_CONFIG_STRING_SIZE];
     char log_level_buf[MAX_CONFIG_STRING_SIZE];
+    char disk_admission_buf[MAX_CONFIG_STRING_SIZE];
+    char stream_format_buf[MAX_CONFIG_STRING_SIZE];
+    char transport_buf[MAX_CONFIG_STRING_SIZE];
+    char backends_buf[MAX_BACKENDS][MAX_CONFIG_STRING_SIZE];
+    char budget_exhausted_buf[MAX_CONFIG_STRING_SIZE];
+    char warmup_buf[MAX_CONFIG_STRING_SIZE];
+    char wire_format_buf[MAX_CONFIG_STRING_SIZE];
+    char local_voice_buf[MAX_CONFIG_STRING_SIZE];
+    char priority_rules_buf[MAX_PRIORITY_RULES][MAX_CONFIG_STRING_SIZE];
 
     // Set string value (copies to internal buffer and updates pointer)
     void SetServer(const char* value);
@@ -71,6 +133,15 @@ struct TTSConfig {
     void SetFormat(const char* value);
     void SetCancelKey(const char* value);
     void SetLogLevel(const char* value);
+    void SetDiskAdmission(const char* value);
+    void SetStreamFormat(const char* value);
+    void SetTransport(const char* value);
+    void SetBackend(int index, const char* value);
+    void SetBudgetExhausted(const char* value);
+    void SetWarmup(const char* value);
+    void SetWireFormat(const char* value);
+    void SetLocalVoice(const char* value);
+    void SetPriorityRule(int index, const char* value);
 
     // Initialize with default values
     void SetDefaults();
@@ -79,6 +150,13 @@ struct TTSConfig {
     bool ServerEquals(const char* value) const { return strcmp(server, value) == 0; }
     bool FormatEquals(const char* value) const { return strcmp(format, value) == 0; }
     bool ApiKeyEmpty() const { return api_key == nullptr || api_key[0] == '\0'; }
+    bool DiskAdmissionEquals(const char* value) const { return strcmp(disk_admission, value) == 0; }
+    bool StreamFormatEquals(const char* value) const { return strcmp(stream_format, value) == 0; }
+    bool TransportEquals(const char* value) const { return strcmp(transport, value) == 0; }
+    bool BudgetExhaustedEquals(const char* value) const { return strcmp(budget_exhausted, value) == 0; }
+    bool WarmupEquals(const char* value) const { return strcmp(warmup, value) == 0; }
+    bool WireFormatEquals(const char* value) const { return strcmp(wire_format, value) == 0; }
+    bool LocalVoiceEquals(const char* value) const { return strcmp(local_voice, value) == 0; }
 
 private:
     // Helper to copy string to buffer and update pointer
@@ -22,8 +22,12 @@
 
 #include "fetch_thread_pool.h"
 #include "logger.h"
+#ifdef _WIN32
 #include <windows.h>
 #include <objbase.h>
+#endif
+#include <algorithm>
+#include <cstring>
 
 // Global fetch thread pool instance
 FetchThreadPool g_fetchThreadPool;
@@ -41,12 +45,14 @@ FetchThreadPool::~FetchThreadPool() {
 }
 
 void FetchThreadPool::WorkerLoop() {
+#ifdef _WIN32
     // Initialize COM for this thread (required for WinINet)
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
     if (FAILED(hr)) {
         LOG_ERROR(L"Failed to initialize COM in fetch worker thread");
         return;
     }
+#endif
 
     LOG_DEBUG(L"Fetch worker thread started");
 
@@ -56,20 +62,34 @@ void FetchThreadPool::WorkerLoop() {
         {
             std::unique_lock<std::mutex> lock(poolMutex);
 
-            // Wait for task or stop signal
-            cv.wait(lock, [this] {
-                return stop.load() || !tasks.empty();
-            });
+            // Wait for a ready task, the next delayed task to fall due, or stop signal
+            while (true) {
+                PromoteDueTasksLocked(std::chrono::steady_clock::now());
+
+                if (!tasks.empty() || stop.load()) {
+                    break;
+                }
+
+                if (delayedTasks.empty()) {
+                    cv.wait(lock);
+                } else {
+                    cv.wait_until(lock, delayedTasks.front().due);
+                }
+            }
 
             // Check for shutdown
             if (stop.load() && tasks.empty()) {
                 break;
             }
 
-            // Get next task
+            // Get the most urgent task
             if (!tasks.empty()) {
-                task = std::move(tasks.front());
-                tasks.pop();
+                std::pop_heap(tasks.begin(), tasks.end(), RunsLater);
+                task = std::move(tasks.back().task);
+                if (tasks.back().group) {
+                    tasks.back().group->started = true;
+                }
+                tasks.pop_back();
             }
         }
 
@@ -85,11 +105,25 @@ void FetchThreadPool::WorkerLoop() {
         }
     }
 
+#ifdef _WIN32
     CoUninitialize();
+#endif
     LOG_DEBUG(L"Fetch worker thread stopped");
 }
 
-bool FetchThreadPool::Enqueue(std::function<void()> task) {
+void FetchThreadPool::Configure(size_t threads, size_t maxPending) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    if (initialized.load()) {
+        LOG_WARNING(L"FetchThreadPool already running, new limits ignored");
+        return;
+    }
+
+    maxThreads = threads > 0 ? threads : 1;
+    maxPendingTasks = maxPending > 0 ? maxPending : 1;
+}
+
+void FetchThreadPool::EnsureWorkers() {
     // Initialize on first use (lazy initialization)
     if (!initialized.load()) {
         std::lock_guard<std::mutex> lock(poolMutex);
@@ -107,17 +141,131 @@ bool FetchThreadPool::Enqueue(std::function<void()> task) {
             LOG_INFO(L"FetchThreadPool initialized successfully");
         }
     }
+}
+
+void FetchThreadPool::PromoteDueTasksLocked(std::chrono::steady_clock::time_point now) {
+    size_t promoted = 0;
+    while (!delayedTasks.empty() && delayedTasks.front().due <= now) {
+        std::pop_heap(delayedTasks.begin(), delayedTasks.end(), DueLater);
+        PushReadyLocked(std::move(delayedTasks.back().task), delayedTasks.back().priority);
+        delayedTasks.pop_back();
+        promoted++;
+    }
+
+    // The calling worker takes one; the rest need workers that may be in an
+    // untimed wait, which only a notify ends
+    for (size_t i = 1; i < promoted; ++i) {
+        cv.notify_one();
+    }
+}
+
+void FetchThreadPool::PushReadyLocked(std::function<void()> task, uint64_t priority, std::shared_ptr<DropGroup> group) {
+    tasks.push_back({ priority, nextOrder++, std::move(task), std::move(group) });
+    std::push_heap(tasks.begin(), tasks.end(), RunsLater);
+}
+
+bool FetchThreadPool::MakeRoomLocked(size_t count, uint64_t priority, std::vector<std::function<void()>>& displaced) {
+    size_t needed = std::min(count, maxPendingTasks);
+
+    // Pick groups by the member that would run last until enough tasks would go
+    std::vector<DropGroup*> victims;
+    size_t freed = 0;
+    while (tasks.size() - freed + needed > maxPendingTasks) {
+        const ReadyTask* latest = nullptr;
+        for (const ReadyTask& queued : tasks) {
+            if (queued.group && !queued.group->started &&
+                std::find(victims.begin(), victims.end(), queued.group.get()) == victims.end() &&
+                (!latest || RunsLater(queued, *latest))) {
+                latest = &queued;
+            }
+        }
+        if (!latest || latest->priority <= priority) {
+            return false;
+        }
+
+        victims.push_back(latest->group.get());
+        freed += std::count_if(tasks.begin(), tasks.end(),
+            [&](const ReadyTask& queued) { return queued.group.get() == victims.back(); });
+    }
+
+    if (victims.empty()) {
+        return true;
+    }
+
+    LOG_DEBUG(L"FetchThreadPool queue full, displacing " + std::to_wstring(freed) + L" task(s) of " +
+        std::to_wstring(victims.size()) + L" group(s) for one of priority " + std::to_wstring(priority));
+    for (DropGroup* victim : victims) {
+        displaced.push_back(std::move(victim->onDropped));
+    }
+    tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [&](const ReadyTask& queued) {
+        return queued.group && std::find(victims.begin(), victims.end(), queued.group.get()) != victims.end();
+    }), tasks.end());
+    std::make_heap(tasks.begin(), tasks.end(), RunsLater);
+    return true;
+}
+
+bool FetchThreadPool::Enqueue(std::function<void()> task, uint64_t priority, std::function<void()> onDropped) {
+    std::vector<GroupTask> single;
+    single.push_back({ std::move(task), priority });
+    return EnqueueGroup(std::move(single), std::move(onDropped));
+}
+
+bool FetchThreadPool::EnqueueGroup(std::vector<GroupTask> group, std::function<void()> onDropped) {
+    if (group.empty()) {
+        return true;
+    }
+    EnsureWorkers();
+
+    // A group only displaces what is less urgent than all of its members
+    uint64_t leastUrgent = 0;
+    for (const GroupTask& member : group) {
+        leastUrgent = std::max(leastUrgent, member.priority);
+    }
+
+    std::vector<std::function<void()>> displaced;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+
+        if (!MakeRoomLocked(group.size(), leastUrgent, displaced)) {
+            LOG_WARNING(L"FetchThreadPool queue full (" + std::to_wstring(tasks.size()) +
+                       L" >= " + std::to_wstring(maxPendingTasks) + L"), dropping " +
+                       std::to_wstring(group.size()) + L" task(s)");
+            return false;
+        }
+
+        std::shared_ptr<DropGroup> dropGroup;
+        if (onDropped) {
+            dropGroup = std::make_shared<DropGroup>();
+            dropGroup->onDropped = std::move(onDropped);
+        }
+        for (GroupTask& member : group) {
+            PushReadyLocked(std::move(member.run), member.priority, dropGroup);
+            cv.notify_one();
+        }
+    }
+
+    // Displaced tasks' owners learn of it outside the lock, so they may enqueue again
+    for (auto& notify : displaced) {
+        if (notify) {
+            notify();
+        }
+    }
+    return true;
+}
+
+bool FetchThreadPool::EnqueueDelayed(std::function<void()> task, std::chrono::milliseconds delay, uint64_t priority) {
+    EnsureWorkers();
 
     std::lock_guard<std::mutex> lock(poolMutex);
 
-    // Check queue size
-    if (tasks.size() >= maxPendingTasks) {
-        LOG_WARNING(L"FetchThreadPool queue full (" + std::to_wstring(tasks.size()) +
-                   L" >= " + std::to_wstring(maxPendingTasks) + L"), dropping task");
+    if (stop.load()) {
         return false;
     }
 
-    tasks.push(std::move(task));
+    delayedTasks.push_back({ std::chrono::steady_clock::now() + delay, priority, std::move(task) });
+    std::push_heap(delayedTasks.begin(), delayedTasks.end(), DueLater);
+
+    // Wake a worker so it re-arms its wait for the new earliest due time
     cv.notify_one();
 
     return true;
@@ -145,6 +293,11 @@ void FetchThreadPool::Shutdown() {
     }
 
     workers.clear();
+
+    if (!delayedTasks.empty()) {
+        LOG_INFO(L"Dropped " + std::to_wstring(delayedTasks.size()) + L" pending retries and timers");
+        delayedTasks.clear();
+    }
     LOG_INFO(L"FetchThreadPool shutdown complete");
 }
 
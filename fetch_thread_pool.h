@@ -25,19 +25,63 @@
 
 #include <functional>
 #include <vector>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <chrono>
+#include <cstdint>
+
+// Task priorities: lower runs first. Speech fetches use their priority class
+// and then their playback sequence number (FetchPriorityFor), so the line
+// that plays soonest is fetched first.
+constexpr uint64_t FETCH_PRIORITY_URGENT = 0;               // Timers, finishing requests already sent
+constexpr uint64_t FETCH_PRIORITY_BACKGROUND = UINT64_MAX;  // Health checks, warm-up
 
 // Thread pool for parallel TTS fetching
-// Uses bounded queue to prevent memory exhaustion
+// Uses bounded queue to prevent memory exhaustion. Ready tasks run in
+// priority order, first come first served within a priority. When the queue
+// is full, a new task displaces the queued droppable task with the highest
+// priority value, if that value is higher than its own. Droppable tasks come
+// in groups (the pieces of one line) that are admitted and displaced whole.
 class FetchThreadPool {
+public:
+    struct GroupTask {
+        std::function<void()> run;
+        uint64_t priority;
+    };
+
 private:
     std::vector<std::unique_ptr<std::thread>> workers;
-    std::queue<std::function<void()>> tasks;
+
+    // Tasks displaced together, so a line is dropped whole rather than cut short
+    struct DropGroup {
+        std::function<void()> onDropped;
+        bool started = false;   // A member has left the queue; the rest are kept
+    };
+
+    // Ready tasks, kept as a min-heap on (priority, order)
+    struct ReadyTask {
+        uint64_t priority;
+        uint64_t order;
+        std::function<void()> task;
+        std::shared_ptr<DropGroup> group;   // Null if the task must not be displaced
+    };
+    std::vector<ReadyTask> tasks;
+    uint64_t nextOrder = 0;
+    static bool RunsLater(const ReadyTask& a, const ReadyTask& b) {
+        return a.priority != b.priority ? a.priority > b.priority : a.order > b.order;
+    }
+
+    // Tasks waiting for a due time (retries), kept as a min-heap on due
+    struct DelayedTask {
+        std::chrono::steady_clock::time_point due;
+        uint64_t priority;
+        std::function<void()> task;
+    };
+    std::vector<DelayedTask> delayedTasks;
+    static bool DueLater(const DelayedTask& a, const DelayedTask& b) { return a.due > b.due; }
     std::mutex poolMutex;
     std::condition_variable cv;
     std::atomic<bool> stop{false};
@@ -46,14 +90,43 @@ private:
     size_t maxPendingTasks;
 
     void WorkerLoop();
+    void EnsureWorkers();
+
+    // Move due delayed tasks to the ready queue (poolMutex held)
+    void PromoteDueTasksLocked(std::chrono::steady_clock::time_point now);
+    void PushReadyLocked(std::function<void()> task, uint64_t priority, std::shared_ptr<DropGroup> group = nullptr);
+
+    // Displace whole groups less urgent than priority until count tasks fit (poolMutex held)
+    // Changes nothing and returns false if they can't be made to fit
+    bool MakeRoomLocked(size_t count, uint64_t priority, std::vector<std::function<void()>>& displaced);
 
 public:
     FetchThreadPool(size_t maxThreads = 4, size_t maxPending = 20);
     ~FetchThreadPool();
 
-    // Enqueue a task for parallel execution
+    // Set worker and queue limits; only takes effect before the first Enqueue
+    void Configure(size_t threads, size_t maxPending);
+
+    // Enqueue a task for parallel execution, ahead of queued tasks with a higher priority value
+    // A task given onDropped may later be displaced by a more urgent one while
+    // the queue is full; onDropped then runs on the enqueuing thread instead.
     // Returns false if queue is full (task dropped)
-    bool Enqueue(std::function<void()> task);
+    bool Enqueue(std::function<void()> task, uint64_t priority = FETCH_PRIORITY_BACKGROUND,
+        std::function<void()> onDropped = nullptr);
+
+    // Enqueue tasks that are admitted together - the pieces of one line
+    // Either all of them are queued or none is. With onDropped they may later
+    // be displaced, all at once and only while none has started; onDropped runs
+    // once for the group. A group larger than the whole queue needs it empty.
+    bool EnqueueGroup(std::vector<GroupTask> group, std::function<void()> onDropped = nullptr);
+
+    // Run a task after a delay without tying up a worker while waiting
+    // Not subject to the pending limit - used for retries of already admitted work
+    // Once due it queues with the given priority, so a retry of the line about
+    // to play overtakes fetches of later lines
+    // Delayed tasks that are not yet due at shutdown are dropped
+    bool EnqueueDelayed(std::function<void()> task, std::chrono::milliseconds delay,
+        uint64_t priority = FETCH_PRIORITY_URGENT);
 
     // Shutdown the thread pool gracefully
     void Shutdown();
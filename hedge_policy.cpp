@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "hedge_policy.h"
+#include "config.h"
+#include "logger.h"
+
+#include <algorithm>
+
+// Global hedge policy instance
+HedgePolicy g_hedgePolicy;
+
+static constexpr size_t LATENCY_WINDOW = 200;
+static constexpr size_t MIN_LATENCY_SAMPLES = 20;
+
+// Unused budget carries over, but only this many hedges can be sent back to back
+static constexpr double MAX_HEDGE_BURST = 3.0;
+
+void LatencyTracker::Record(std::chrono::milliseconds latency) {
+    uint32_t value = static_cast<uint32_t>(std::min<long long>(std::max<long long>(latency.count(), 0), UINT32_MAX));
+
+    std::lock_guard<std::mutex> lock(trackerMutex);
+    if (samples.size() < LATENCY_WINDOW) {
+        samples.push_back(value);
+    } else {
+        samples[next] = value;
+        next = (next + 1) % LATENCY_WINDOW;
+    }
+}
+
+bool LatencyTracker::Percentile(int percentile, std::chrono::milliseconds& value) {
+    std::vector<uint32_t> sorted;
+    {
+        std::lock_guard<std::mutex> lock(trackerMutex);
+        if (samples.size() < MIN_LATENCY_SAMPLES) {
+            return false;
+        }
+        sorted = samples;
+    }
+
+    size_t rank = (sorted.size() - 1) * static_cast<size_t>(percentile) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    value = std::chrono::milliseconds(sorted[rank]);
+    return true;
+}
+
+void HedgePolicy::RecordLatency(bool streaming, std::chrono::milliseconds latency) {
+    TrackerFor(streaming).Record(latency);
+}
+
+bool HedgePolicy::HedgeDelay(bool streaming, std::chrono::milliseconds& delay) {
+    if (!g_config.hedging) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(policyMutex);
+        requests++;
+        budget = std::min(budget + g_config.hedge_budget_percent / 100.0, MAX_HEDGE_BURST);
+    }
+
+    if (!TrackerFor(streaming).Percentile(g_config.hedge_percentile, delay)) {
+        return false;
+    }
+
+    delay = std::max(delay, std::chrono::milliseconds(g_config.hedge_min_delay_ms));
+    return true;
+}
+
+bool HedgePolicy::TryAcquireHedge() {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    if (budget < 1.0) {
+        overBudget++;
+        return false;
+    }
+    budget -= 1.0;
+    hedgesSent++;
+    return true;
+}
+
+void HedgePolicy::RecordRaceWinner(bool hedgeWon) {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    if (hedgeWon) {
+        hedgesWon++;
+    } else {
+        primariesWon++;
+    }
+}
+
+void HedgePolicy::LogStats() {
+    std::lock_guard<std::mutex> lock(policyMutex);
+    if (requests == 0) {
+        return;
+    }
+
+    uint64_t races = hedgesWon + primariesWon;
+    LOG_INFO(L"Hedging: " + std::to_wstring(hedgesSent) + L" hedges for " + std::to_wstring(requests) +
+        L" requests, hedge won " + std::to_wstring(hedgesWon) + L" of " + std::to_wstring(races) +
+        L" races (" + std::to_wstring(races > 0 ? hedgesWon * 100 / races : 0) + L"%), " +
+        std::to_wstring(overBudget) + L" skipped over budget");
+}
@@ -0,0 +1,86 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_HEDGE_POLICY_H
+#define TTS_STELLARIS_HEDGE_POLICY_H
+
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+// Hedged requests
+// A request still unanswered after the hedge_percentile latency of recent
+// requests gets a duplicate; the first to deliver wins and the other is
+// cancelled. Extra requests are limited to hedge_budget_percent of normal
+// ones so a slow server isn't hit with twice the load.
+
+// Recent latencies in a fixed window, for percentile estimates
+class LatencyTracker {
+private:
+    std::vector<uint32_t> samples;
+    size_t next = 0;
+    std::mutex trackerMutex;
+
+public:
+    void Record(std::chrono::milliseconds latency);
+
+    // False until the window has enough samples to be meaningful
+    bool Percentile(int percentile, std::chrono::milliseconds& value);
+};
+
+class HedgePolicy {
+private:
+    LatencyTracker completeLatency;     // Whole response, for buffered playback
+    LatencyTracker firstAudioLatency;   // First audio block, for progressive playback
+
+    std::mutex policyMutex;
+    double budget = 0.0;                // Hedges that may be sent right now
+    uint64_t requests = 0;
+    uint64_t hedgesSent = 0;
+    uint64_t hedgesWon = 0;
+    uint64_t primariesWon = 0;
+    uint64_t overBudget = 0;
+
+    LatencyTracker& TrackerFor(bool streaming) { return streaming ? firstAudioLatency : completeLatency; }
+
+public:
+    // Successful request latency: to the first audio block when streaming, to the end otherwise
+    void RecordLatency(bool streaming, std::chrono::milliseconds latency);
+
+    // How long to wait before hedging a new request; false if hedging is off
+    // or there is not enough history yet. Counts the request towards the budget.
+    bool HedgeDelay(bool streaming, std::chrono::milliseconds& delay);
+
+    // Take one hedge from the budget; false if it is used up
+    bool TryAcquireHedge();
+
+    // Which side of a hedged race delivered first
+    void RecordRaceWinner(bool hedgeWon);
+
+    void LogStats();
+};
+
+// Global hedge policy instance
+extern HedgePolicy g_hedgePolicy;
+
+#endif // TTS_STELLARIS_HEDGE_POLICY_H
@@ -27,7 +27,9 @@
 #include "tts_processor.h"
 #include "thread_pool.h"
 #include "audio_cache.h"
+#include "rate_limiter.h"
 #include "hotkey.h"
+#include "warmup.h"
 #include <Windows.h>
 #include <io.h>
 #include <fcntl.h>
@@ -75,23 +77,23 @@ static std::string GetGameDirectory() {
 
 HRESULT __stdcall hkSpeak(ISpVoice* This, const WCHAR* pwcs, DWORD dwFlags, ULONG* pulStreamNumber) {
     (void)This;
-    (void)dwFlags;
 
     // If hooks aren't ready yet, just pass through to original
     if (!g_sapiHooksCreated.load() || !oSpeak) {
         return oSpeak ? oSpeak(This, pwcs, dwFlags, pulStreamNumber) : S_OK;
     }
 
+    bool handled = true;
     if (IsValidStringPointer(pwcs)) {
         std::wstring textCopy(pwcs);
         // Parallel mode: non-blocking, multiple fetches happen concurrently
-        ProcessTTSRequest(textCopy);
+        handled = ProcessTTSRequest(textCopy, dwFlags);
     }
     else {
         LOG_WARNING(L"Invalid string pointer in hkSpeak");
     }
 
-    if (g_config.mute_original) {
+    if (g_config.mute_original && handled) {
         if (pulStreamNumber) {
             *pulStreamNumber = 0;
         }
@@ -148,6 +150,9 @@ static void CreateSAPIHooks() {
     pDummyVoice->Release();
     g_sapiHooksCreated.store(true);
     LOG_INFO(L"SAPI hooks created successfully - TTS interception active!");
+
+    // Pay DNS, connection and model load costs now rather than on the first line
+    StartWarmup();
 }
 
 // Create hotkey thread in a deferred manner (safe for launcher)
@@ -214,6 +219,8 @@ void SetupHooks() {
     g_audioCache.SetMaxSize(g_config.max_cache_size);
     g_audioCache.Initialize();
 
+    g_spendGovernor.Load(gameDir.empty() ? "tts_usage.txt" : gameDir + "\\tts_usage.txt");
+
     // Initialize parallel TTS system if enabled
     InitializeParallelSystem();
 
@@ -0,0 +1,151 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "http_session_pool.h"
+#include "config.h"
+#include "utils.h"
+#include "logger.h"
+
+#include <algorithm>
+
+// Global session pool instance
+HttpSessionPool g_httpSessionPool;
+
+// DLL Best Practices: the destructor runs during DLL_PROCESS_DETACH, when WinINet
+// may already be unloaded. Abandon the handles and let the OS reclaim them.
+HttpSessionPool::~HttpSessionPool() {
+    for (auto& entry : sessions) {
+        entry->connection.release();
+    }
+    internet.release();
+}
+
+bool HttpSessionPool::EnsureInternetHandleLocked() {
+    if (internet) {
+        return true;
+    }
+
+    internet.reset(InternetOpenA("StellarTTS/1.0", INTERNET_OPEN_TYPE_DIRECT, NULL, NULL, 0));
+    if (!internet) {
+        LOG_ERROR(L"Failed to initialize WinINet: " + GetWindowsErrorMessage(GetLastError()));
+        return false;
+    }
+
+    // Timeouts set on the root handle are inherited by every session and request
+    DWORD dwTimeout = 15000;
+    InternetSetOptionA(internet, INTERNET_OPTION_CONNECT_TIMEOUT, &dwTimeout, sizeof(DWORD));
+    dwTimeout = 30000;
+    InternetSetOptionA(internet, INTERNET_OPTION_RECEIVE_TIMEOUT, &dwTimeout, sizeof(DWORD));
+
+    return true;
+}
+
+void HttpSessionPool::ExpireIdleLocked(std::chrono::steady_clock::time_point now) {
+    auto idleLimit = std::chrono::seconds(g_config.keep_alive_idle_seconds);
+
+    sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+        [&](const std::unique_ptr<SessionEntry>& entry) {
+            if (entry->inUse || now - entry->lastUsed < idleLimit) {
+                return false;
+            }
+            LOG_DEBUG(L"Closing idle session to " + std::wstring(entry->host.begin(), entry->host.end()) +
+                L" after " + std::to_wstring(entry->uses) + L" requests");
+            return true;
+        }), sessions.end());
+}
+
+HttpSessionPool::Lease HttpSessionPool::Acquire(const std::string& host, INTERNET_PORT port) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    if (!EnsureInternetHandleLocked()) {
+        return Lease();
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    ExpireIdleLocked(now);
+
+    // Prefer the most recently used idle session - its connection is the least likely to be stale
+    if (g_config.keep_alive && !shuttingDown) {
+        SessionEntry* best = nullptr;
+        for (auto& entry : sessions) {
+            if (!entry->inUse && entry->port == port && entry->host == host) {
+                if (!best || entry->lastUsed > best->lastUsed) {
+                    best = entry.get();
+                }
+            }
+        }
+
+        if (best) {
+            best->inUse = true;
+            best->uses++;
+            sessionsReused++;
+            return Lease(this, best, true);
+        }
+    }
+
+    auto entry = std::make_unique<SessionEntry>();
+    entry->host = host;
+    entry->port = port;
+    entry->connection.reset(InternetConnectA(internet, host.c_str(), port,
+        NULL, NULL, INTERNET_SERVICE_HTTP, 0, 0));
+
+    if (!entry->connection) {
+        LOG_ERROR(L"Failed to create session: " + GetWindowsErrorMessage(GetLastError()));
+        return Lease();
+    }
+
+    entry->lastUsed = now;
+    entry->uses = 1;
+    entry->inUse = true;
+    entry->pooled = g_config.keep_alive && !shuttingDown;
+    sessionsCreated++;
+
+    LOG_DEBUG(L"Opened new session to " + std::wstring(host.begin(), host.end()) + L":" + std::to_wstring(port) +
+        L" (" + std::to_wstring(sessionsCreated) + L" created, " + std::to_wstring(sessionsReused) + L" reused)");
+
+    SessionEntry* raw = entry.get();
+    sessions.push_back(std::move(entry));
+    return Lease(this, raw, false);
+}
+
+void HttpSessionPool::Release(SessionEntry* entry, bool reusable) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    if (reusable && entry->pooled && !shuttingDown) {
+        entry->inUse = false;
+        entry->lastUsed = std::chrono::steady_clock::now();
+        return;
+    }
+
+    // Unhealthy or unpooled - drop it so the next request reconnects
+    sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+        [entry](const std::unique_ptr<SessionEntry>& e) { return e.get() == entry; }), sessions.end());
+}
+
+// Stop pooling; sessions are closed as their leases end
+// Idle handles are left to process teardown for the same reason as the destructor
+void HttpSessionPool::Shutdown() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    shuttingDown = true;
+    LOG_INFO(L"HTTP session pool: " + std::to_wstring(sessionsCreated) + L" sessions created, " +
+        std::to_wstring(sessionsReused) + L" reused");
+}
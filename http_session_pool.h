@@ -0,0 +1,167 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_HTTP_SESSION_POOL_H
+#define TTS_STELLARIS_HTTP_SESSION_POOL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <windows.h>
+#include <wininet.h>
+
+// RAII wrapper for Windows handles
+template<typename T, BOOL(WINAPI* Closer)(T)>
+class WinHandle {
+    T handle;
+public:
+    WinHandle(T h = nullptr) : handle(h) {}
+    ~WinHandle() { if (handle) Closer(handle); }
+
+    WinHandle(const WinHandle&) = delete;
+    WinHandle& operator=(const WinHandle&) = delete;
+
+    WinHandle(WinHandle&& other) noexcept : handle(other.handle) {
+        other.handle = nullptr;
+    }
+    WinHandle& operator=(WinHandle&& other) noexcept {
+        if (this != &other) {
+            if (handle) Closer(handle);
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+
+    operator T() const { return handle; }
+    explicit operator bool() const { return handle != nullptr; }
+    T* operator&() { return &handle; }
+    const T* operator&() const { return &handle; }
+
+    void reset(T h = nullptr) {
+        if (handle) Closer(handle);
+        handle = h;
+    }
+
+    // Give up ownership without closing
+    T release() {
+        T h = handle;
+        handle = nullptr;
+        return h;
+    }
+};
+
+using InternetHandle = WinHandle<HINTERNET, InternetCloseHandle>;
+using FileHandle = WinHandle<HANDLE, CloseHandle>;
+
+// Pool of long-lived WinINet sessions, one or more per server
+// Keeps a single InternetOpen handle for the process and reuses InternetConnect
+// handles between requests so keep-alive connections (and their TLS sessions)
+// survive from one utterance to the next
+class HttpSessionPool {
+private:
+    struct SessionEntry {
+        std::string host;
+        INTERNET_PORT port = 0;
+        InternetHandle connection;
+        std::chrono::steady_clock::time_point lastUsed;
+        uint64_t uses = 0;
+        bool inUse = false;
+        bool pooled = true;
+    };
+
+    InternetHandle internet;
+    std::vector<std::unique_ptr<SessionEntry>> sessions;
+    std::mutex poolMutex;
+    uint64_t sessionsCreated = 0;
+    uint64_t sessionsReused = 0;
+    bool shuttingDown = false;
+
+    // Must be called with poolMutex held
+    bool EnsureInternetHandleLocked();
+    void ExpireIdleLocked(std::chrono::steady_clock::time_point now);
+
+    void Release(SessionEntry* entry, bool reusable);
+
+public:
+    // Exclusive use of one session for the duration of a request
+    // Returned to the pool on destruction if marked reusable, closed otherwise
+    class Lease {
+    private:
+        HttpSessionPool* pool;
+        SessionEntry* entry;
+        bool reused;
+        bool reusable;
+
+    public:
+        Lease() : pool(nullptr), entry(nullptr), reused(false), reusable(false) {}
+        Lease(HttpSessionPool* p, SessionEntry* e, bool wasReused)
+            : pool(p), entry(e), reused(wasReused), reusable(false) {}
+        ~Lease() { if (pool && entry) pool->Release(entry, reusable); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& other) noexcept
+            : pool(other.pool), entry(other.entry), reused(other.reused), reusable(other.reusable) {
+            other.pool = nullptr;
+            other.entry = nullptr;
+        }
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                if (pool && entry) pool->Release(entry, reusable);
+                pool = other.pool;
+                entry = other.entry;
+                reused = other.reused;
+                reusable = other.reusable;
+                other.pool = nullptr;
+                other.entry = nullptr;
+            }
+            return *this;
+        }
+
+        explicit operator bool() const { return entry != nullptr; }
+        HINTERNET Connection() const { return entry ? static_cast<HINTERNET>(entry->connection) : nullptr; }
+
+        // True if this session already served an earlier request
+        bool IsReused() const { return reused; }
+
+        // Call once the response has been read completely and the connection is healthy
+        void MarkReusable() { reusable = true; }
+    };
+
+    HttpSessionPool() = default;
+    ~HttpSessionPool();
+
+    // Lease a session to host:port, reusing an idle one when keep-alive is enabled
+    Lease Acquire(const std::string& host, INTERNET_PORT port);
+
+    // Stop returning sessions to the pool
+    void Shutdown();
+};
+
+// Global session pool instance
+extern HttpSessionPool g_httpSessionPool;
+
+#endif // TTS_STELLARIS_HTTP_SESSION_POOL_H
@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "http_transport.h"
+#include "socket_transport.h"
+#include "socket_event_loop.h"
+#ifdef _WIN32
+#include "wininet_transport.h"
+#include "winhttp_transport.h"
+#endif
+#include "config.h"
+
+#include <cstdlib>
+
+bool ParseHttpUrl(const std::string& url, HttpRequest& request) {
+    size_t hostStart;
+    if (url.compare(0, 7, "http://") == 0) {
+        request.secure = false;
+        request.port = 80;
+        hostStart = 7;
+    } else if (url.compare(0, 8, "https://") == 0) {
+        request.secure = true;
+        request.port = 443;
+        hostStart = 8;
+    } else {
+        return false;
+    }
+
+    size_t pathStart = url.find('/', hostStart);
+    std::string authority = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    request.path = (pathStart == std::string::npos) ? "/" : url.substr(pathStart);
+
+    // [IPv6]:port, host:port or bare host
+    size_t portSep = authority.rfind(':');
+    if (portSep != std::string::npos && authority.find(']', portSep) == std::string::npos) {
+        int port = atoi(authority.c_str() + portSep + 1);
+        if (port <= 0 || port > 65535) {
+            return false;
+        }
+        request.port = static_cast<uint16_t>(port);
+        authority.resize(portSep);
+    }
+    if (authority.size() >= 2 && authority.front() == '[' && authority.back() == ']') {
+        authority = authority.substr(1, authority.size() - 2);
+    }
+
+    request.host = authority;
+    return !request.host.empty();
+}
+
+// Sockets are the only transport outside Windows
+HttpTransport& GetHttpTransport() {
+#ifdef _WIN32
+    if (g_config.TransportEquals("winhttp")) {
+        return g_winHttpTransport;
+    }
+    if (!g_config.TransportEquals("socket")) {
+        return g_winInetTransport;
+    }
+#endif
+    return g_socketTransport;
+}
+
+void ShutdownHttpTransports() {
+#ifdef _WIN32
+    g_winInetTransport.Shutdown();
+#endif
+    g_socketEventLoop.Shutdown();   // Before the pool it returns connections to
+    g_socketTransport.Shutdown();
+#ifdef _WIN32
+    g_winHttpTransport.Shutdown();
+#endif
+}
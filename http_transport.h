@@ -0,0 +1,133 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_HTTP_TRANSPORT_H
+#define TTS_STELLARIS_HTTP_TRANSPORT_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+class CancellationToken;
+
+// Transport-neutral HTTP layer used by the fetcher
+// This header deliberately has no Windows dependencies, so the socket
+// backend and anything built on it compile on other platforms too.
+
+// When each phase of a request ended, filled in by the transport as it goes
+// Phases a request skipped stay unset: a reused connection needs no resolve
+// or connect, plain http no TLS handshake
+struct HttpTimings {
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    TimePoint start;          // Request handed to the transport
+    TimePoint resolved;       // Host name looked up
+    TimePoint connected;      // TCP connection established
+    TimePoint tlsDone;        // TLS handshake finished
+    TimePoint requestSent;    // Request written out
+    TimePoint firstByte;      // First byte of the response arrived
+    TimePoint lastByte;       // Body received (set by the caller)
+};
+
+using HttpPhase = HttpTimings::TimePoint HttpTimings::*;
+
+// Record now as the end of a phase; timings may be null
+inline void MarkPhase(HttpTimings* timings, HttpPhase phase) {
+    if (timings) {
+        timings->*phase = std::chrono::steady_clock::now();
+    }
+}
+
+// Same, but keeps the first time a phase is reported
+inline void MarkPhaseOnce(HttpTimings* timings, HttpPhase phase) {
+    if (timings && timings->*phase == HttpTimings::TimePoint()) {
+        timings->*phase = std::chrono::steady_clock::now();
+    }
+}
+
+struct HttpRequest {
+    const char* method = "POST";
+    std::string host;
+    uint16_t port = 80;
+    std::string path;
+    bool secure = false;
+    std::string headers;          // Extra "Name: value\r\n" lines
+    const char* body = nullptr;   // Request body, owned by the caller
+    size_t bodySize = 0;
+    CancellationToken* cancel = nullptr;   // Cancelling aborts a blocked send or read
+    HttpTimings* timings = nullptr;        // Phase timestamps, if wanted; must outlive the response
+};
+
+// An in-flight response; the connection stays leased until it is destroyed
+class HttpResponse {
+public:
+    virtual ~HttpResponse() = default;
+
+    virtual int StatusCode() const = 0;
+
+    // Value of a response header, empty if absent
+    virtual std::string Header(const char* name) const = 0;
+
+    // Declared body length, 0 if unknown (chunked or close-delimited)
+    virtual uint64_t ContentLength() const = 0;
+
+    // True if the connection already served an earlier request
+    virtual bool ConnectionReused() const = 0;
+
+    // Block until body bytes are available; available == 0 means end of body
+    virtual bool QueryAvailable(size_t& available) = 0;
+
+    // Block until size bytes are read or the body ends; bytesRead == 0 means end of body
+    virtual bool Read(uint8_t* dest, size_t size, size_t& bytesRead) = 0;
+
+    // Call once the body has been read completely - the connection may be reused
+    virtual void MarkComplete() = 0;
+};
+
+class HttpTransport {
+public:
+    virtual ~HttpTransport() = default;
+
+    virtual const wchar_t* Name() const = 0;
+
+    // Send the request and wait for the response headers
+    // Returns nullptr on connection or send failure, with the reason in error
+    // If request.cancel fires, the blocked call fails promptly; the response
+    // stays cancellable until it is destroyed
+    virtual std::unique_ptr<HttpResponse> Send(const HttpRequest& request, std::wstring& error) = 0;
+
+    // Stop pooling connections (called during shutdown)
+    virtual void Shutdown() = 0;
+};
+
+// Split an http:// or https:// URL into host, port, path and scheme
+bool ParseHttpUrl(const std::string& url, HttpRequest& request);
+
+// Transport selected by the "transport" config key
+HttpTransport& GetHttpTransport();
+
+// Shut down every transport that may have been used
+void ShutdownHttpTransports();
+
+#endif // TTS_STELLARIS_HTTP_TRANSPORT_H
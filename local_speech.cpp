@@ -0,0 +1,214 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "local_speech.h"
+#include "hooks.h"
+#include "fetch_thread_pool.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include <Windows.h>
+#include <mmsystem.h>
+#include <Shlwapi.h>
+#include <sapi.h>
+#include <sphelper.h>
+#include <chrono>
+#include <mutex>
+#include <cstring>
+
+#pragma comment(lib, "sapi.lib")
+#pragma comment(lib, "shlwapi.lib")
+
+// Threads of their own, so a slow local voice never holds up a server fetch
+static FetchThreadPool g_localSpeechPool;
+static std::once_flag g_localSpeechStarted;
+
+// SAPI voices render 22 kHz natively
+static const DWORD LOCAL_SAMPLE_RATE = 22050;
+
+// Real-time factor, for the log
+static std::mutex g_localStatsMutex;
+static uint64_t g_localLines = 0;
+static uint64_t g_localWallMs = 0;
+static uint64_t g_localCpuMs = 0;
+static uint64_t g_localAudioMs = 0;
+
+// User plus kernel time this thread has used
+static uint64_t ThreadCpuMs() {
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) {
+        return 0;
+    }
+    ULARGE_INTEGER kernelTime, userTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+    return (kernelTime.QuadPart + userTime.QuadPart) / 10000;
+}
+
+static std::wstring FormatFactor(uint64_t partMs, uint64_t wholeMs) {
+    wchar_t text[16];
+    swprintf_s(text, L"%.2f", wholeMs > 0 ? static_cast<double>(partMs) / wholeMs : 0.0);
+    return text;
+}
+
+FetchResult SynthesizeLocally(const std::string& text) {
+    FetchResult result;
+    std::wstring wide = UTF8ToWide(text);
+    ISpVoice* voice = nullptr;
+    ISpStream* spStream = nullptr;
+    IStream* memory = nullptr;
+    WAVEFORMATEX format = {};
+    STATSTG stat = {};
+    LARGE_INTEGER start = {};
+    ULONG bytesRead = 0;
+    std::vector<uint8_t> pcm;
+    HRESULT hr;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t cpuStart = ThreadCpuMs();
+
+    hr = CoCreateInstance(CLSID_SpVoice, NULL, CLSCTX_ALL, IID_ISpVoice, (void**)&voice);
+    if (FAILED(hr) || !voice) {
+        LOG_ERROR(L"Failed to create SAPI voice for local synthesis");
+        goto cleanup;
+    }
+
+    if (g_config.local_voice[0] != '\0') {
+        std::wstring attributes = L"Name=" + UTF8ToWide(g_config.local_voice);
+        ISpObjectToken* token = nullptr;
+        if (SUCCEEDED(SpFindBestToken(SPCAT_VOICES, attributes.c_str(), nullptr, &token)) && token) {
+            voice->SetVoice(token);
+            token->Release();
+        } else {
+            LOG_WARNING(L"Local voice " + attributes + L" is not installed, using the default voice");
+        }
+    }
+
+    format.wFormatTag = WAVE_FORMAT_PCM;
+    format.nChannels = 1;
+    format.nSamplesPerSec = LOCAL_SAMPLE_RATE;
+    format.wBitsPerSample = 16;
+    format.nBlockAlign = 2;
+    format.nAvgBytesPerSec = LOCAL_SAMPLE_RATE * 2;
+
+    memory = SHCreateMemStream(nullptr, 0);
+    hr = memory ? CoCreateInstance(CLSID_SpStream, NULL, CLSCTX_ALL, IID_ISpStream, (void**)&spStream) : E_OUTOFMEMORY;
+    if (SUCCEEDED(hr)) hr = spStream->SetBaseStream(memory, SPDFID_WaveFormatEx, &format);
+    if (SUCCEEDED(hr)) hr = voice->SetOutput(spStream, TRUE);
+    if (FAILED(hr)) {
+        LOG_ERROR(L"Failed to route the local voice into memory");
+        goto cleanup;
+    }
+
+    // Straight to the original Speak: the hooked one would hand the text back to us
+    hr = oSpeak ? oSpeak(voice, wide.c_str(), SPF_IS_NOT_XML, nullptr) : voice->Speak(wide.c_str(), SPF_IS_NOT_XML, nullptr);
+    if (FAILED(hr)) {
+        LOG_ERROR(L"Local synthesis failed");
+        goto cleanup;
+    }
+
+    // The stream holds bare samples; the player wants a WAV header
+    if (FAILED(memory->Stat(&stat, STATFLAG_NONAME)) || stat.cbSize.QuadPart == 0 ||
+        FAILED(memory->Seek(start, STREAM_SEEK_SET, nullptr))) {
+        LOG_ERROR(L"Local synthesis produced no audio");
+        goto cleanup;
+    }
+    pcm.resize(static_cast<size_t>(stat.cbSize.QuadPart));
+    if (FAILED(memory->Read(pcm.data(), static_cast<ULONG>(pcm.size()), &bytesRead))) {
+        LOG_ERROR(L"Failed to read local synthesis output");
+        goto cleanup;
+    }
+    pcm.resize(bytesRead);
+
+    {
+        uint32_t dataSize = static_cast<uint32_t>(pcm.size());
+        uint32_t riffSize = dataSize + 36;
+        uint32_t fmtSize = 16;
+        result.audio.resize(44);
+        memcpy(&result.audio[0], "RIFF", 4);
+        memcpy(&result.audio[4], &riffSize, 4);
+        memcpy(&result.audio[8], "WAVE", 4);
+        memcpy(&result.audio[12], "fmt ", 4);
+        memcpy(&result.audio[16], &fmtSize, 4);
+        memcpy(&result.audio[20], &format, 16);   // WAVEFORMATEX up to cbSize is the PCM fmt chunk
+        memcpy(&result.audio[36], "data", 4);
+        memcpy(&result.audio[40], &dataSize, 4);
+        result.audio.insert(result.audio.end(), pcm.begin(), pcm.end());
+    }
+    result.outcome = FetchOutcome::Success;
+
+    {
+        uint64_t wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - wallStart).count();
+        uint64_t cpuMs = ThreadCpuMs() - cpuStart;
+        uint64_t audioMs = pcm.size() * 1000 / format.nAvgBytesPerSec;
+        LOG_DEBUG(L"Local synthesis: " + std::to_wstring(audioMs) + L" ms of audio in " + std::to_wstring(wallMs) +
+            L" ms (real-time factor " + FormatFactor(wallMs, audioMs) + L", " + FormatFactor(cpuMs, audioMs) +
+            L" of a core)");
+
+        std::lock_guard<std::mutex> lock(g_localStatsMutex);
+        g_localLines++;
+        g_localWallMs += wallMs;
+        g_localCpuMs += cpuMs;
+        g_localAudioMs += audioMs;
+    }
+
+cleanup:
+    if (voice) {
+        voice->SetOutput(nullptr, FALSE);
+        voice->Release();
+    }
+    if (spStream) spStream->Release();
+    if (memory) memory->Release();
+    return result;
+}
+
+bool SpeakLocally(const std::string& text, uint64_t priority, std::function<void(FetchResult& result)> done) {
+    if (!g_config.local_fallback) {
+        return false;
+    }
+
+    std::call_once(g_localSpeechStarted, []() {
+        g_localSpeechPool.Configure(g_config.local_threads, g_config.max_pending_fetches);
+    });
+
+    return g_localSpeechPool.Enqueue([text, done]() {
+        // Below the game's threads, so synthesis only takes spare CPU
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+        FetchResult result = SynthesizeLocally(text);
+        done(result);
+    }, priority);
+}
+
+void ShutdownLocalSpeech() {
+    g_localSpeechPool.Shutdown();
+
+    std::lock_guard<std::mutex> lock(g_localStatsMutex);
+    if (g_localLines > 0) {
+        LOG_INFO(L"Local voice: " + std::to_wstring(g_localLines) + L" lines, " +
+            std::to_wstring(g_localAudioMs / 1000) + L" s of audio; real-time factor " +
+            FormatFactor(g_localWallMs, g_localAudioMs) + L", " + FormatFactor(g_localCpuMs, g_localAudioMs) +
+            L" of a core on " + std::to_wstring(g_config.local_threads) + L" thread(s)");
+    }
+}
@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_LOCAL_SPEECH_H
+#define TTS_STELLARIS_LOCAL_SPEECH_H
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "tts_fetcher.h"
+
+// In-process fallback voice (local_fallback) for lines no server could synthesize
+// Renders with an installed SAPI voice into memory, on a small pool of
+// below-normal priority threads separate from the fetch workers. This is
+// Windows' own voice; there is no neural engine here.
+
+// Synthesize text to a PCM WAV clip on the calling thread; same result as a fetch
+FetchResult SynthesizeLocally(const std::string& text);
+
+// Synthesize text on the local voice's threads and pass the result to done there
+// priority orders waiting lines as on the fetch pool. Returns false if
+// local_fallback is off or too many lines are already waiting.
+bool SpeakLocally(const std::string& text, uint64_t priority, std::function<void(FetchResult& result)> done);
+
+// Stop the local voice's threads and log its real-time factor
+void ShutdownLocalSpeech();
+
+#endif // TTS_STELLARIS_LOCAL_SPEECH_H
@@ -23,10 +23,16 @@
 #include "logger.h"
 
 #include <iostream>
+#ifdef _WIN32
 #include <windows.h>
 #include <Shlwapi.h>
 
 #pragma comment(lib, "shlwapi.lib")
+#else
+#include <chrono>
+#include <ctime>
+#include <cwchar>
+#endif
 
 Logger g_logger;
 
@@ -41,11 +47,21 @@ const wchar_t* Logger::LevelToString(LogLevel level) {
 }
 
 std::wstring Logger::GetTimestamp() {
+    wchar_t buf[32];
+#ifdef _WIN32
     SYSTEMTIME st;
     GetLocalTime(&st);
-    wchar_t buf[32];
     swprintf_s(buf, L"%02d:%02d:%02d.%03d",
         st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+#else
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    std::tm local{};
+    localtime_r(&seconds, &local);
+    swprintf(buf, 32, L"%02d:%02d:%02d.%03d",
+        local.tm_hour, local.tm_min, local.tm_sec, static_cast<int>(ms));
+#endif
     return buf;
 }
 
@@ -63,6 +79,7 @@ Logger::~Logger() {
     }
 }
 
+#ifdef _WIN32
 // Helper to get the game executable directory
 static std::wstring GetGameDirectory() {
     wchar_t modulePath[MAX_PATH];
@@ -72,10 +89,12 @@ static std::wstring GetGameDirectory() {
     PathRemoveFileSpecW(modulePath);
     return std::wstring(modulePath);
 }
+#endif
 
 // Lazy initialization of log file - called on first Log() call
 void Logger::InitializeLogFile() {
     if (!fileLoggingInitialized) {
+#ifdef _WIN32
         // Build absolute path to log file in game directory
         std::wstring logPath = GetGameDirectory();
         if (!logPath.empty()) {
@@ -85,6 +104,8 @@ void Logger::InitializeLogFile() {
         }
 
         logFile.open(logPath, std::ios::app);
+#endif
+        // Portable builds (tests and tools) only log to the console
         fileLoggingInitialized = true;
         if (logFile.is_open() && fileLoggingEnabled) {
             // Write session start marker
@@ -21,8 +21,12 @@
 // SOFTWARE.
 
 #include "playback_queue.h"
+#include "audio_stream.h"
+#include "audio_player.h"
 #include "logger.h"
 
+#include <algorithm>
+
 // Global playback queue instance
 PlaybackQueue g_playbackQueue;
 
@@ -46,12 +50,52 @@ uint64_t PlaybackQueue::AddRequest(const std::wstring& text) {
     return seq;
 }
 
-void PlaybackQueue::MarkReady(uint64_t seq, const std::vector<uint8_t>& audio, const std::string* cachePath) {
+bool SpeechLine::BeginPlayback() {
+    if (std::chrono::steady_clock::now() >= deadline) {
+        Expire();
+    }
+
+    int expected = 0;
+    phase.compare_exchange_strong(expected, 1);
+    return expected != 2 && !cancel.IsCancelled();
+}
+
+bool SpeechLine::Expire() {
+    int expected = 0;
+    if (!phase.compare_exchange_strong(expected, 2)) {
+        return false;
+    }
+    cancel.Cancel();
+    return true;
+}
+
+uint64_t PlaybackQueue::AddRequests(const std::vector<std::wstring>& texts, std::shared_ptr<SpeechLine> line) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    // Reserve the whole range at once so another text can't land in the middle
+    uint64_t first = nextSequenceNumber.fetch_add(texts.size());
+    uint64_t last = first + texts.size() - 1;
+
+    for (size_t i = 0; i < texts.size(); ++i) {
+        AudioItem item;
+        item.sequenceNumber = first + i;
+        item.text = texts[i];
+        item.line = line;
+        pendingItems[item.sequenceNumber] = std::move(item);
+    }
+
+    LOG_DEBUG(L"Enqueued TTS requests #" + std::to_wstring(first) + L"-" + std::to_wstring(last) +
+        L" (" + std::to_wstring(texts.size()) + L" pieces, " +
+        (line ? SpeechPriorityName(line->priority) : L"normal") + L" priority)");
+    return first;
+}
+
+void PlaybackQueue::MarkReady(uint64_t seq, std::vector<uint8_t> audio, const std::string* cachePath) {
     std::lock_guard<std::mutex> lock(queueMutex);
 
     auto it = pendingItems.find(seq);
     if (it != pendingItems.end()) {
-        it->second.audioData = audio;
+        it->second.audioData = std::move(audio);
         if (cachePath) {
             it->second.cachePath = *cachePath;
         }
@@ -64,6 +108,21 @@ void PlaybackQueue::MarkReady(uint64_t seq, const std::vector<uint8_t>& audio, c
     }
 }
 
+void PlaybackQueue::MarkStreaming(uint64_t seq, std::shared_ptr<AudioStream> stream) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    auto it = pendingItems.find(seq);
+    if (it != pendingItems.end()) {
+        it->second.stream = std::move(stream);
+        it->second.isReady = true;
+
+        LOG_DEBUG(L"Marked request #" + std::to_wstring(seq) + L" as streaming");
+        cv.notify_all();
+    } else {
+        LOG_WARNING(L"Attempted to stream unknown request #" + std::to_wstring(seq));
+    }
+}
+
 void PlaybackQueue::MarkFailed(uint64_t seq) {
     std::lock_guard<std::mutex> lock(queueMutex);
 
@@ -77,6 +136,85 @@ void PlaybackQueue::MarkFailed(uint64_t seq) {
     }
 }
 
+static SpeechPriority PriorityOf(const AudioItem& item) {
+    return item.line ? item.line->priority : SpeechPriority::Normal;
+}
+
+std::map<uint64_t, AudioItem>::iterator PlaybackQueue::NextItemLocked() {
+    std::shared_ptr<SpeechLine> started = startedLine.lock();
+    auto next = pendingItems.end();
+    auto cancelled = pendingItems.end();
+
+    for (auto it = pendingItems.begin(); it != pendingItems.end(); ++it) {
+        const AudioItem& item = it->second;
+
+        // A cancelled line's items are cleared out once ready, but nothing waits for them
+        if (item.line && item.line->cancel.IsCancelled()) {
+            if (item.isReady) {
+                return it;
+            }
+            if (cancelled == pendingItems.end()) {
+                cancelled = it;
+            }
+            continue;
+        }
+
+        // The rest of a line that has started playing isn't cut in two by another line
+        if (started && item.line == started) {
+            return it;
+        }
+
+        // Items are in arrival order, so the first of the highest class wins
+        if (next == pendingItems.end() || PriorityOf(item) > PriorityOf(next->second)) {
+            next = it;
+        }
+    }
+    return next != pendingItems.end() ? next : cancelled;
+}
+
+size_t PlaybackQueue::MakeWayFor(SpeechPriority priority, bool purge, bool interrupt) {
+    std::vector<std::shared_ptr<SpeechLine>> lines;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        std::shared_ptr<SpeechLine> started = startedLine.lock();
+        bool startedQueued = false;
+
+        for (const auto& entry : pendingItems) {
+            const std::shared_ptr<SpeechLine>& line = entry.second.line;
+            if (!line || line->cancel.IsCancelled()) {
+                continue;
+            }
+            if (line == started) {
+                startedQueued = true;
+            } else if (purge && line->priority <= priority &&
+                std::find(lines.begin(), lines.end(), line) == lines.end()) {
+                lines.push_back(line);
+            }
+        }
+
+        // A line already playing is only stopped with priority_interrupt
+        if (interrupt && started && !started->cancel.IsCancelled() &&
+            (started->priority < priority || (purge && started->priority == priority))) {
+            if (started == playingLine) {
+                // Still handed out, so this stops its clip and not the next one
+                g_shouldCancel = true;
+                lines.push_back(started);
+            } else if (startedQueued) {
+                lines.push_back(started);
+            }
+        }
+    }
+
+    // Outside the lock - cancelling aborts transfers through their callbacks
+    for (const auto& line : lines) {
+        line->cancel.Cancel();
+    }
+    if (!lines.empty()) {
+        cv.notify_all();
+    }
+    return lines.size();
+}
+
 bool PlaybackQueue::WaitForNextReady(AudioItem& outItem) {
     std::unique_lock<std::mutex> lock(queueMutex);
 
@@ -87,20 +225,19 @@ bool PlaybackQueue::WaitForNextReady(AudioItem& outItem) {
             return false;
         }
 
-        // Look for the next item in sequence
-        uint64_t expectedSeq = nextToPlay.load();
-        auto it = pendingItems.find(expectedSeq);
-
-        if (it != pendingItems.end()) {
-            // Item exists - check if it's ready
-            if (it->second.isReady) {
-                outItem = std::move(it->second);
-                pendingItems.erase(it);
-                return true;
+        // Only the item whose turn it is may play; until it is ready, wait
+        auto it = NextItemLocked();
+        if (it != pendingItems.end() && it->second.isReady) {
+            // Stop requests from here on are for this item; clearing the flag
+            // under the lock MakeWayFor sets it under means none is lost
+            g_shouldCancel = false;
+            playingLine = it->second.line;
+            if (playingLine) {
+                startedLine = playingLine;
             }
-            // Item exists but not ready yet - wait
-        } else {
-            // Item doesn't exist yet - wait for it to be added
+            outItem = std::move(it->second);
+            pendingItems.erase(it);
+            return true;
         }
 
         // Wait for notification
@@ -110,24 +247,27 @@ bool PlaybackQueue::WaitForNextReady(AudioItem& outItem) {
 
 void PlaybackQueue::Remove(uint64_t seq) {
     std::lock_guard<std::mutex> lock(queueMutex);
+    playingLine.reset();
+    LOG_DEBUG(L"Done with request #" + std::to_wstring(seq));
+}
 
-    // Advance the sequence pointer
-    uint64_t currentNext = nextToPlay.load();
-    if (seq == currentNext) {
-        nextToPlay.store(seq + 1);
-        LOG_DEBUG(L"Advanced playback pointer to #" + std::to_wstring(seq + 1));
+void PlaybackQueue::CancelAll() {
+    std::vector<std::shared_ptr<SpeechLine>> lines;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (playingLine) {
+            lines.push_back(playingLine);
+        }
+        for (const auto& entry : pendingItems) {
+            if (entry.second.line) {
+                lines.push_back(entry.second.line);
+            }
+        }
     }
 
-    // Clean up any old items that might have been missed
-    // (this shouldn't happen in normal operation)
-    auto it = pendingItems.begin();
-    while (it != pendingItems.end()) {
-        if (it->first < seq) {
-            LOG_WARNING(L"Removing stale item #" + std::to_wstring(it->first));
-            it = pendingItems.erase(it);
-        } else {
-            ++it;
-        }
+    // Outside the lock - cancelling aborts transfers through their callbacks
+    for (const auto& line : lines) {
+        line->cancel.Cancel();
     }
 }
 
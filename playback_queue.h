@@ -30,6 +30,32 @@
 #include <condition_variable>
 #include <atomic>
 #include <cstdint>
+#include <memory>
+#include <chrono>
+#include "cancellation.h"
+#include "speech_priority.h"
+
+class AudioStream;
+
+// One line handed to Speak; every piece of a split text shares it. Cancelling
+// it aborts the pieces still downloading and drops those not yet played.
+struct SpeechLine {
+    CancellationToken cancel;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    std::chrono::steady_clock::time_point spokenAt = std::chrono::steady_clock::now();   // Speak handed it over
+    SpeechPriority priority = SpeechPriority::Normal;
+
+    // False if the line was cancelled or missed its deadline; once a piece
+    // has started playing the deadline no longer applies
+    bool BeginPlayback();
+
+    // Deadline passed: cancel the line unless it is already playing
+    // Returns true if this call cancelled it
+    bool Expire();
+
+private:
+    std::atomic<int> phase{ 0 };   // 0 = waiting, 1 = playing, 2 = expired
+};
 
 // Audio item in the playback queue
 struct AudioItem {
@@ -37,6 +63,8 @@ struct AudioItem {
     std::wstring text;
     std::vector<uint8_t> audioData;
     std::string cachePath;
+    std::shared_ptr<AudioStream> stream;  // Set for progressive playback, audioData stays empty
+    std::shared_ptr<SpeechLine> line;     // Shared by the pieces of a split text, null if not tracked
     bool isReady;
     bool failed;
 
@@ -48,15 +76,21 @@ struct AudioItem {
 };
 
 // Thread-safe priority queue for ordered playback
-// Ensures items are played in sequence even when fetched out of order
+// Ensures items are played in sequence even when fetched out of order.
+// Higher priority classes go first; within a class, and for the rest of
+// a line that has started playing, items play in arrival order.
 class PlaybackQueue {
 private:
     std::map<uint64_t, AudioItem> pendingItems;
     std::mutex queueMutex;
     std::condition_variable cv;
     std::atomic<uint64_t> nextSequenceNumber{1};
-    std::atomic<uint64_t> nextToPlay{1};
     std::atomic<bool> shutdownRequested{false};
+    std::shared_ptr<SpeechLine> playingLine;   // Line of the item handed out for playback
+    std::weak_ptr<SpeechLine> startedLine;     // Line played last; its remaining pieces come next
+
+    // Item to play next, whether or not it is ready (queueMutex held)
+    std::map<uint64_t, AudioItem>::iterator NextItemLocked();
 
 public:
     PlaybackQueue() = default;
@@ -65,19 +99,34 @@ public:
     // Add a new request to the queue, returns the assigned sequence number
     uint64_t AddRequest(const std::wstring& text);
 
-    // Mark an item as ready with audio data
-    void MarkReady(uint64_t seq, const std::vector<uint8_t>& audio, const std::string* cachePath);
+    // Add the pieces of one split text under consecutive sequence numbers, returns the first
+    uint64_t AddRequests(const std::vector<std::wstring>& texts, std::shared_ptr<SpeechLine> line);
+
+    // Mark an item as ready with audio data (moved in, not copied)
+    void MarkReady(uint64_t seq, std::vector<uint8_t> audio, const std::string* cachePath);
+
+    // Hand an item over to progressive playback - it becomes playable before the download finishes
+    void MarkStreaming(uint64_t seq, std::shared_ptr<AudioStream> stream);
 
     // Mark an item as failed (will be skipped during playback)
     void MarkFailed(uint64_t seq);
 
-    // Wait for the next item in sequence to be ready
+    // Make way for a new line of the given class: with purge, drop queued
+    // lines of that class or lower; with interrupt, stop the playing line if
+    // its class is lower (or the same, with purge). Returns the lines dropped.
+    size_t MakeWayFor(SpeechPriority priority, bool purge, bool interrupt);
+
+    // Wait for the next item in playing order to be ready, and clear
+    // g_shouldCancel for it; the players no longer clear it themselves
     // Returns false if shutdown requested, true if item is ready
     bool WaitForNextReady(AudioItem& outItem);
 
-    // Remove an item from the queue after playback
+    // Done with the item handed out for playback
     void Remove(uint64_t seq);
 
+    // Cancel every line still queued or playing (shutdown)
+    void CancelAll();
+
     // Signal shutdown and wake all waiting threads
     void Shutdown();
 
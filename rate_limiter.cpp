@@ -0,0 +1,231 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rate_limiter.h"
+#include "config.h"
+#include "logger.h"
+
+#include <fstream>
+#include <algorithm>
+#include <ctime>
+
+// Global spend governor instance
+SpendGovernor g_spendGovernor;
+
+void TokenBucket::Configure(double ratePerMinute) {
+    perMinute = ratePerMinute;
+    tokens = ratePerMinute;
+    lastRefill = std::chrono::steady_clock::now();
+}
+
+void TokenBucket::Refill(std::chrono::steady_clock::time_point now) {
+    double minutes = std::chrono::duration<double, std::ratio<60>>(now - lastRefill).count();
+    tokens = std::min(perMinute, tokens + minutes * perMinute);
+    lastRefill = now;
+}
+
+std::chrono::milliseconds TokenBucket::TimeUntil(double amount, std::chrono::steady_clock::time_point now) {
+    if (perMinute <= 0.0) {
+        return std::chrono::milliseconds(0);
+    }
+
+    Refill(now);
+    double needed = std::min(amount, perMinute) - tokens;
+    if (needed <= 0.0) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::milliseconds(static_cast<long long>(needed / perMinute * 60000.0) + 1);
+}
+
+void TokenBucket::Take(double amount) {
+    if (perMinute > 0.0) {
+        tokens -= std::min(amount, perMinute);
+    }
+}
+
+// Characters' worth of fixed cost in every request (connection, model warm-up, first frame)
+static constexpr double FIXED_COST_CHARS = 50.0;
+
+// Share of the limit kept after an overload answer, and after latency inflation
+static constexpr double OVERLOAD_BACKOFF = 0.5;
+static constexpr double LATENCY_BACKOFF = 0.9;
+
+// The baseline creeps this fraction of the way towards each slower sample, so
+// a best case that was never repeated stops holding the limit down
+static constexpr double BASELINE_DRIFT = 0.01;
+
+void ConcurrencyLimiter::Configure(int initial, int maximum, int tolerancePercent) {
+    maxLimit = std::max(1, maximum);
+    limit = std::max(minLimit, std::min(maxLimit, static_cast<double>(initial)));
+    peak = limit;
+    tolerance = std::max(101, tolerancePercent) / 100.0;
+    baselineMsPerChar = 0.0;
+    lastDecrease = std::chrono::steady_clock::time_point();
+}
+
+void ConcurrencyLimiter::Decrease(double factor, std::chrono::milliseconds responseTime) {
+    // Answers to requests sent before the last cut say nothing about the new limit
+    auto now = std::chrono::steady_clock::now();
+    if (now - responseTime < lastDecrease) {
+        return;
+    }
+
+    limit = std::max(minLimit, limit * factor);
+    lastDecrease = now;
+    decreases++;
+}
+
+void ConcurrencyLimiter::OnResponse(std::chrono::milliseconds responseTime, size_t chars, int inflight) {
+    if (!Enabled()) {
+        return;
+    }
+
+    double sample = responseTime.count() / (static_cast<double>(chars) + FIXED_COST_CHARS);
+    if (baselineMsPerChar <= 0.0 || sample < baselineMsPerChar) {
+        baselineMsPerChar = sample;
+    } else {
+        baselineMsPerChar += (sample - baselineMsPerChar) * BASELINE_DRIFT;
+    }
+
+    if (sample > baselineMsPerChar * tolerance) {
+        Decrease(LATENCY_BACKOFF, responseTime);
+    } else if (inflight * 2 >= limit && limit < maxLimit) {
+        // Only grow a limit that is being used; an idle one proves nothing
+        limit = std::min(maxLimit, limit + 1.0 / limit);
+        peak = std::max(peak, limit);
+    }
+}
+
+void ConcurrencyLimiter::OnOverload(std::chrono::milliseconds responseTime) {
+    if (Enabled()) {
+        Decrease(OVERLOAD_BACKOFF, responseTime);
+    }
+}
+
+static int Today() {
+    time_t now = time(nullptr);
+    tm local = {};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    return (local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday;
+}
+
+void SpendGovernor::Load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(governorMutex);
+    usagePath = path;
+    day = Today();
+
+    // "yyyymmdd characters"
+    std::ifstream file(path);
+    int savedDay = 0;
+    uint64_t savedChars = 0;
+    if (file >> savedDay >> savedChars && savedDay == day) {
+        dayChars = savedChars;
+    }
+
+    if (g_config.budget_daily_chars > 0) {
+        LOG_INFO(L"Speech budget: " + std::to_wstring(dayChars) + L" of " +
+            std::to_wstring(g_config.budget_daily_chars) + L" characters used today");
+    }
+}
+
+void SpendGovernor::RollDayLocked() {
+    int today = Today();
+    if (today != day) {
+        day = today;
+        dayChars = 0;
+        exhaustedLogged = false;
+        unsaved = true;
+    }
+}
+
+void SpendGovernor::Save() {
+    std::lock_guard<std::mutex> saveLock(saveMutex);
+    std::string path;
+    int savedDay = 0;
+    uint64_t savedChars = 0;
+    {
+        std::lock_guard<std::mutex> lock(governorMutex);
+        if (!unsaved || usagePath.empty() || g_config.budget_daily_chars <= 0) {
+            return;
+        }
+        unsaved = false;
+        path = usagePath;
+        savedDay = day;
+        savedChars = dayChars;
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    if (file) {
+        file << savedDay << ' ' << savedChars << '\n';
+    }
+}
+
+bool SpendGovernor::ExhaustedLocked() {
+    RollDayLocked();
+
+    bool sessionOut = g_config.budget_session_chars > 0 && sessionChars >= static_cast<uint64_t>(g_config.budget_session_chars);
+    bool dayOut = g_config.budget_daily_chars > 0 && dayChars >= static_cast<uint64_t>(g_config.budget_daily_chars);
+
+    if ((sessionOut || dayOut) && !exhaustedLogged) {
+        exhaustedLogged = true;
+        std::string action(g_config.budget_exhausted);
+        LOG_WARNING(std::wstring(dayOut ? L"Daily" : L"Session") + L" speech budget used up, " +
+            (action == "original_voice" ? L"uncached lines use the original voice" : L"playing cached lines only"));
+    }
+    return sessionOut || dayOut;
+}
+
+bool SpendGovernor::Exhausted() {
+    std::lock_guard<std::mutex> lock(governorMutex);
+    return ExhaustedLocked();
+}
+
+bool SpendGovernor::TryCharge(size_t chars) {
+    std::lock_guard<std::mutex> lock(governorMutex);
+    if (ExhaustedLocked()) {
+        return false;
+    }
+
+    sessionChars += chars;
+    dayChars += chars;
+    unsaved = true;
+    return true;
+}
+
+void SpendGovernor::Refund(size_t chars) {
+    std::lock_guard<std::mutex> lock(governorMutex);
+    sessionChars -= std::min<uint64_t>(chars, sessionChars);
+    dayChars -= std::min<uint64_t>(chars, dayChars);
+    unsaved = true;
+}
+
+void SpendGovernor::LogStats() {
+    std::lock_guard<std::mutex> lock(governorMutex);
+    if (sessionChars > 0) {
+        LOG_INFO(L"Speech characters sent: " + std::to_wstring(sessionChars) + L" this session, " +
+            std::to_wstring(dayChars) + L" today");
+    }
+}
@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_RATE_LIMITER_H
+#define TTS_STELLARIS_RATE_LIMITER_H
+
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Client-side limits on what is sent to the speech API
+
+// Token bucket refilled continuously, holding at most one minute's worth
+// Not thread-safe - the backend pool guards its buckets with its own mutex
+class TokenBucket {
+private:
+    double perMinute = 0.0;   // 0 = unlimited
+    double tokens = 0.0;
+    std::chrono::steady_clock::time_point lastRefill;
+
+    void Refill(std::chrono::steady_clock::time_point now);
+
+public:
+    // Starts full
+    void Configure(double ratePerMinute);
+
+    // How long until amount tokens are available, 0 if they are now
+    // Amounts above a full bucket only wait for a full bucket
+    std::chrono::milliseconds TimeUntil(double amount, std::chrono::steady_clock::time_point now);
+
+    // Call after TimeUntil returned 0
+    void Take(double amount);
+};
+
+// Adaptive limit on one server's concurrent requests (AIMD)
+// Grows by one request per limit's worth of answers while latency stays near
+// the best seen, and is cut by a fraction on 429/503 or when latency inflates,
+// as TCP congestion control does. Latency is compared per character of text
+// plus a fixed overhead, so a long line doesn't read as congestion.
+// Not thread-safe - the backend pool guards its limiters with its own mutex
+class ConcurrencyLimiter {
+private:
+    double limit = 0.0;            // 0 = not adaptive
+    double minLimit = 1.0;
+    double maxLimit = 0.0;
+    double tolerance = 2.0;        // Latency this many times the baseline is congestion
+    double baselineMsPerChar = 0.0;
+    std::chrono::steady_clock::time_point lastDecrease;
+    double peak = 0.0;
+    uint64_t decreases = 0;
+
+    void Decrease(double factor, std::chrono::milliseconds responseTime);
+
+public:
+    // Start at initial requests, never above maximum
+    void Configure(int initial, int maximum, int tolerancePercent);
+
+    bool Enabled() const { return limit > 0.0; }
+
+    // Requests allowed in flight now
+    int Limit() const { return static_cast<int>(limit); }
+
+    // A response arrived after responseTime for a text of chars characters,
+    // with inflight requests outstanding when it was sent
+    void OnResponse(std::chrono::milliseconds responseTime, size_t chars, int inflight);
+
+    // The server said it is overloaded (429 or 503)
+    void OnOverload(std::chrono::milliseconds responseTime);
+
+    // Highest limit reached, and how many times it was cut
+    int Peak() const { return static_cast<int>(peak); }
+    uint64_t Decreases() const { return decreases; }
+};
+
+// Character budgets for this session and for the calendar day
+// The day's total is kept in a small file so it survives restarts. A request
+// is allowed while some budget remains, so the last one may overshoot by its size.
+// Charges only update the counts in memory; Save writes the file, from a
+// timer and at shutdown, so no request waits on disk I/O.
+class SpendGovernor {
+private:
+    std::mutex governorMutex;
+    std::mutex saveMutex;         // Keeps saves in order; taken before governorMutex
+    std::string usagePath;
+    uint64_t sessionChars = 0;
+    uint64_t dayChars = 0;
+    int day = 0;                  // yyyymmdd of dayChars
+    bool exhaustedLogged = false;
+    bool unsaved = false;         // dayChars changed since the last Save
+
+    void RollDayLocked();
+    bool ExhaustedLocked();
+
+public:
+    // Read today's usage so far
+    void Load(const std::string& path);
+
+    // Write today's usage if it changed since the last save
+    void Save();
+
+    // True once the session or daily budget is used up
+    bool Exhausted();
+
+    // Count characters about to be sent; false if a budget is already used up
+    // Checked and charged under one lock, so concurrent requests can't all slip in
+    bool TryCharge(size_t chars);
+
+    // Give back characters of a request that didn't go through
+    void Refund(size_t chars);
+
+    void LogStats();
+};
+
+// Global spend governor instance
+extern SpendGovernor g_spendGovernor;
+
+#endif // TTS_STELLARIS_RATE_LIMITER_H
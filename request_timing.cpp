@@ -0,0 +1,192 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "request_timing.h"
+#include "config.h"
+#include "logger.h"
+
+#include <algorithm>
+
+// Global request timing statistics
+RequestTimingStats g_requestTimings;
+
+static const wchar_t* const PHASE_NAMES[REQUEST_PHASE_COUNT] = {
+    L"resolve", L"connect", L"tls", L"send", L"wait", L"download"
+};
+
+static std::wstring Widen(const std::string& s) {
+    return std::wstring(s.begin(), s.end());
+}
+
+RequestBreakdown RequestBreakdown::FromTimings(const HttpTimings& timings) {
+    // End of each phase, in order
+    const HttpTimings::TimePoint ends[REQUEST_PHASE_COUNT] = {
+        timings.resolved, timings.connected, timings.tlsDone,
+        timings.requestSent, timings.firstByte, timings.lastByte
+    };
+
+    RequestBreakdown breakdown;
+    HttpTimings::TimePoint previous = timings.start;
+    for (size_t i = 0; i < REQUEST_PHASE_COUNT; ++i) {
+        if (ends[i] == HttpTimings::TimePoint() || ends[i] < previous) {
+            continue;
+        }
+        breakdown.phaseMs[i] = std::chrono::duration_cast<std::chrono::milliseconds>(ends[i] - previous).count();
+        breakdown.present[i] = true;
+        previous = ends[i];
+    }
+    breakdown.totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(previous - timings.start).count();
+    return breakdown;
+}
+
+std::wstring RequestBreakdown::Describe() const {
+    std::wstring text;
+    for (size_t i = 0; i < REQUEST_PHASE_COUNT; ++i) {
+        if (!present[i]) continue;
+        if (!text.empty()) text += L", ";
+        text += std::wstring(PHASE_NAMES[i]) + L" " + std::to_wstring(phaseMs[i]);
+    }
+    return text + L" ms";
+}
+
+void RequestTimingStats::Histogram::Add(int64_t ms) {
+    size_t bucket = 0;
+    for (int64_t bound = 1; bucket < BUCKET_COUNT - 1 && ms >= bound; bound *= 2) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    count++;
+    maxMs = std::max(maxMs, ms);
+}
+
+// Upper end of the bucket holding the percentile, or the maximum if that is lower
+int64_t RequestTimingStats::Histogram::PercentileBound(int percentile) const {
+    uint64_t rank = (count * static_cast<uint64_t>(percentile) + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0) {
+            int64_t bound = (i == BUCKET_COUNT - 1) ? maxMs : (int64_t(1) << i) - 1;
+            return std::min(bound, maxMs);
+        }
+    }
+    return maxMs;
+}
+
+std::wstring RequestTimingStats::Histogram::Describe() const {
+    std::wstring text = L"p50 <= " + std::to_wstring(PercentileBound(50)) + L" ms, p90 <= " +
+        std::to_wstring(PercentileBound(90)) + L" ms, max " + std::to_wstring(maxMs) + L" ms [";
+
+    bool first = true;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        if (buckets[i] == 0) continue;
+        if (!first) text += L" ";
+        first = false;
+
+        if (i == 0) {
+            text += L"<1";
+        } else if (i == BUCKET_COUNT - 1) {
+            text += std::to_wstring(int64_t(1) << (i - 1)) + L"+";
+        } else {
+            text += std::to_wstring(int64_t(1) << (i - 1)) + L"-" + std::to_wstring((int64_t(1) << i) - 1);
+        }
+        text += L":" + std::to_wstring(buckets[i]);
+    }
+    return text + L"]";
+}
+
+void RequestTimingStats::Record(const std::string& server, size_t chars, int statusCode, bool reused,
+    const HttpTimings& timings) {
+    RequestBreakdown breakdown = RequestBreakdown::FromTimings(timings);
+    LOG_DEBUG(L"Request to " + Widen(server) + L" took " + std::to_wstring(breakdown.totalMs) + L" ms: " +
+        breakdown.Describe());
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    ServerTimings& stats = servers[server];
+    stats.requests++;
+    if (reused) {
+        stats.reused++;
+    }
+    for (size_t i = 0; i < REQUEST_PHASE_COUNT; ++i) {
+        if (breakdown.present[i]) {
+            stats.phases[i].Add(breakdown.phaseMs[i]);
+        }
+    }
+    stats.total.Add(breakdown.totalMs);
+
+    size_t keep = static_cast<size_t>(std::max(g_config.slow_requests_logged, 0));
+    if (keep == 0 || (slowest.size() == keep && breakdown.totalMs <= slowest.back().breakdown.totalMs)) {
+        return;
+    }
+    SlowRequest entry = { server, chars, statusCode, reused, breakdown };
+    auto position = std::upper_bound(slowest.begin(), slowest.end(), entry,
+        [](const SlowRequest& a, const SlowRequest& b) { return a.breakdown.totalMs > b.breakdown.totalMs; });
+    slowest.insert(position, std::move(entry));
+    if (slowest.size() > keep) {
+        slowest.pop_back();
+    }
+}
+
+void RequestTimingStats::RecordLineLatency(int64_t ms) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (lineLatencies.size() < MAX_LINE_SAMPLES) {
+        lineLatencies.push_back(ms);
+    }
+}
+
+void RequestTimingStats::LogStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (!lineLatencies.empty()) {
+        std::vector<int64_t> sorted(lineLatencies);
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](uint64_t p) {
+            return std::to_wstring(sorted[(sorted.size() * p + 99) / 100 - 1]);
+        };
+        LOG_INFO(L"Speak to first sound: " + std::to_wstring(sorted.size()) + L" lines, p50 " + percentile(50) +
+            L" ms, p90 " + percentile(90) + L" ms, p99 " + percentile(99) + L" ms, max " +
+            std::to_wstring(sorted.back()) + L" ms");
+    }
+
+    for (const auto& server : servers) {
+        const ServerTimings& stats = server.second;
+        LOG_INFO(L"Request phases for " + Widen(server.first) + L": " + std::to_wstring(stats.requests) +
+            L" requests, " + std::to_wstring(stats.reused) + L" on reused connections");
+        for (size_t i = 0; i < REQUEST_PHASE_COUNT; ++i) {
+            if (stats.phases[i].count > 0) {
+                LOG_INFO(L"  " + std::wstring(PHASE_NAMES[i]) + L": " + stats.phases[i].Describe());
+            }
+        }
+        LOG_INFO(L"  total: " + stats.total.Describe());
+    }
+
+    if (!slowest.empty()) {
+        LOG_INFO(L"Slowest requests this session:");
+        for (size_t i = 0; i < slowest.size(); ++i) {
+            const SlowRequest& request = slowest[i];
+            LOG_INFO(L"  " + std::to_wstring(i + 1) + L". " + std::to_wstring(request.breakdown.totalMs) + L" ms, " +
+                Widen(request.server) + L", " + std::to_wstring(request.chars) + L" chars, status " +
+                std::to_wstring(request.statusCode) + (request.reused ? L", reused connection: " : L", new connection: ") +
+                request.breakdown.Describe());
+        }
+    }
+}
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TTS_STELLARIS_REQUEST_TIMING_H
+#define TTS_STELLARIS_REQUEST_TIMING_H
+
+#include "http_transport.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+// Where the time of each server request went
+// The fetcher records every request that got a response. Per server, each
+// phase's duration goes into a histogram with power-of-two millisecond
+// buckets, and the slowest requests of the session are kept with their full
+// breakdown. Both are logged at shutdown, so a slow line can be pinned on
+// DNS, the connection, the server's synthesis or the download.
+// Alongside, each line's wait from Speak to its first sound is kept, the
+// end-to-end figure benchmark runs against tools/tts_standin compare.
+
+enum class RequestPhase {
+    Resolve,    // Start to host name resolved
+    Connect,    // To TCP connection established
+    Tls,        // To TLS handshake done
+    Send,       // To request written out
+    Wait,       // To first byte of the response - the server's think time
+    Download,   // To last byte of the body
+    Count
+};
+
+constexpr size_t REQUEST_PHASE_COUNT = static_cast<size_t>(RequestPhase::Count);
+
+// Phase durations of one request; phases it skipped are absent
+struct RequestBreakdown {
+    int64_t phaseMs[REQUEST_PHASE_COUNT] = {};
+    bool present[REQUEST_PHASE_COUNT] = {};
+    int64_t totalMs = 0;
+
+    static RequestBreakdown FromTimings(const HttpTimings& timings);
+
+    // "resolve 3, connect 12, send 0, wait 840, download 95 ms"
+    std::wstring Describe() const;
+};
+
+class RequestTimingStats {
+private:
+    // Bucket 0 is under 1 ms, bucket k is 2^(k-1) to 2^k - 1 ms, the last one open-ended
+    static constexpr size_t BUCKET_COUNT = 17;
+
+    struct Histogram {
+        uint64_t buckets[BUCKET_COUNT] = {};
+        uint64_t count = 0;
+        int64_t maxMs = 0;
+
+        void Add(int64_t ms);
+        int64_t PercentileBound(int percentile) const;
+        std::wstring Describe() const;
+    };
+
+    struct ServerTimings {
+        Histogram phases[REQUEST_PHASE_COUNT];
+        Histogram total;
+        uint64_t requests = 0;
+        uint64_t reused = 0;
+    };
+
+    struct SlowRequest {
+        std::string server;
+        size_t chars;
+        int statusCode;
+        bool reused;
+        RequestBreakdown breakdown;
+    };
+
+    // Line latencies kept for exact percentiles; a session never gets near this many lines
+    static constexpr size_t MAX_LINE_SAMPLES = 100000;
+
+    std::mutex statsMutex;
+    std::map<std::string, ServerTimings> servers;
+    std::vector<SlowRequest> slowest;    // Longest first, at most slow_requests_logged
+    std::vector<int64_t> lineLatencies;
+
+public:
+    // A request to server that got a response; timings.lastByte must be set
+    void Record(const std::string& server, size_t chars, int statusCode, bool reused, const HttpTimings& timings);
+
+    // A line started playing ms after Speak handed it over
+    void RecordLineLatency(int64_t ms);
+
+    void LogStats();
+};
+
+// Global request timing statistics
+extern RequestTimingStats g_requestTimings;
+
+#endif // TTS_STELLARIS_REQUEST_TIMING_H
@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "response_body.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+// Bytes held in the pools of all instances
+static std::atomic<size_t> g_totalPooledBytes{ 0 };
+
+ResponseBody::ResponseBody()
+    : contiguousUsed(0), pooledBytes(0), nextBlockSize(FIRST_BLOCK_SIZE), totalSize(0) {
+}
+
+ResponseBody::~ResponseBody() {
+    g_totalPooledBytes -= pooledBytes;
+}
+
+void ResponseBody::Reset(size_t expectedLength) {
+    RecycleChain();
+    contiguous.clear();
+    contiguousUsed = 0;
+    nextBlockSize = FIRST_BLOCK_SIZE;
+    totalSize = 0;
+
+    if (expectedLength > 0) {
+        contiguous.resize(expectedLength);
+    }
+}
+
+ResponseBody::Block ResponseBody::AcquireBlock(size_t minBytes) {
+    // Reuse the first pooled block that is large enough
+    for (size_t i = 0; i < pool.size(); ++i) {
+        if (pool[i].capacity >= minBytes) {
+            Block block = std::move(pool[i]);
+            pool.erase(pool.begin() + i);
+            pooledBytes -= block.capacity;
+            g_totalPooledBytes -= block.capacity;
+            block.used = 0;
+            return block;
+        }
+    }
+
+    size_t capacity = std::max(minBytes, nextBlockSize);
+    nextBlockSize = std::min(nextBlockSize * 2, MAX_BLOCK_SIZE);
+    return Block{ std::unique_ptr<uint8_t[]>(new uint8_t[capacity]), capacity, 0 };
+}
+
+void ResponseBody::RecycleChain() {
+    for (auto& block : chain) {
+        if (pooledBytes + block.capacity > MAX_POOLED_BYTES) {
+            continue;  // Freed when chain is cleared
+        }
+        // Other workers' pools count against the shared limit too
+        if (g_totalPooledBytes.fetch_add(block.capacity) + block.capacity > MAX_TOTAL_POOLED_BYTES) {
+            g_totalPooledBytes -= block.capacity;
+            continue;
+        }
+        pooledBytes += block.capacity;
+        pool.push_back(std::move(block));
+    }
+    chain.clear();
+}
+
+uint8_t* ResponseBody::Prepare(size_t wantBytes, size_t& space) {
+    if (chain.empty() && contiguousUsed < contiguous.size()) {
+        space = contiguous.size() - contiguousUsed;
+        return contiguous.data() + contiguousUsed;
+    }
+
+    // Unknown length, or the server sent more than Content-Length promised
+    if (chain.empty() || chain.back().used == chain.back().capacity) {
+        chain.push_back(AcquireBlock(std::max<size_t>(wantBytes, 1)));
+    }
+
+    Block& block = chain.back();
+    space = block.capacity - block.used;
+    return block.data.get() + block.used;
+}
+
+void ResponseBody::Commit(size_t bytes) {
+    if (chain.empty()) {
+        contiguousUsed += bytes;
+    } else {
+        chain.back().used += bytes;
+    }
+    totalSize += bytes;
+}
+
+void ResponseBody::Append(const uint8_t* data, size_t size) {
+    while (size > 0) {
+        size_t space = 0;
+        uint8_t* dest = Prepare(size, space);
+        size_t n = std::min(size, space);
+        memcpy(dest, data, n);
+        Commit(n);
+        data += n;
+        size -= n;
+    }
+}
+
+std::vector<uint8_t> ResponseBody::Take() {
+    std::vector<uint8_t> result;
+
+    if (chain.empty()) {
+        contiguous.resize(contiguousUsed);
+        result = std::move(contiguous);
+    } else {
+        // Reserve and append rather than resize, which would zero the whole body first
+        result.reserve(totalSize);
+        result.insert(result.end(), contiguous.begin(), contiguous.begin() + contiguousUsed);
+        for (const auto& block : chain) {
+            result.insert(result.end(), block.data.get(), block.data.get() + block.used);
+        }
+    }
+
+    Reset(0);
+    return result;
+}
@@ -0,0 +1,87 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_RESPONSE_BODY_H
+#define TTS_STELLARIS_RESPONSE_BODY_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Receive buffer for HTTP response bodies
+// With a known Content-Length the body is read straight into one exact-size
+// vector that is later moved out. Unknown lengths (chunked/streamed replies)
+// go into a chain of growing blocks, so nothing is reallocated or copied
+// while downloading; the chain is flattened once at the end.
+// Blocks are kept for reuse, so one instance per worker thread avoids
+// allocating for every response. What all instances keep together is capped,
+// so a burst of large replies doesn't leave every worker holding its maximum.
+class ResponseBody {
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t capacity;
+        size_t used;
+    };
+
+    static constexpr size_t FIRST_BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;
+    static constexpr size_t MAX_POOLED_BYTES = 8 * 1024 * 1024;         // Per instance
+    static constexpr size_t MAX_TOTAL_POOLED_BYTES = 16 * 1024 * 1024;  // All instances together
+
+    std::vector<uint8_t> contiguous;   // Exact-size destination when the length is known
+    size_t contiguousUsed;
+    std::vector<Block> chain;          // Overflow / unknown-length storage
+    std::vector<Block> pool;           // Spare blocks from previous responses
+    size_t pooledBytes;
+    size_t nextBlockSize;
+    size_t totalSize;
+
+    Block AcquireBlock(size_t minBytes);
+    void RecycleChain();
+
+public:
+    ResponseBody();
+    ~ResponseBody();
+
+    ResponseBody(const ResponseBody&) = delete;
+    ResponseBody& operator=(const ResponseBody&) = delete;
+
+    // Start a new response; expectedLength 0 means unknown
+    void Reset(size_t expectedLength);
+
+    // Writable space for the next read, sized for about wantBytes
+    // The pointer stays valid until the matching Commit
+    uint8_t* Prepare(size_t wantBytes, size_t& space);
+    void Commit(size_t bytes);
+
+    // Copy in data produced elsewhere (e.g. decoded SSE deltas)
+    void Append(const uint8_t* data, size_t size);
+
+    size_t Size() const { return totalSize; }
+
+    // Hand out the whole body: moved when contiguous, one exact-size copy from a chain
+    std::vector<uint8_t> Take();
+};
+
+#endif // TTS_STELLARIS_RESPONSE_BODY_H
@@ -0,0 +1,219 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "retry_policy.h"
+#include "config.h"
+#include "logger.h"
+
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+
+// Global circuit breaker registry
+CircuitBreakerRegistry g_circuitBreakers;
+
+static constexpr std::chrono::milliseconds BASE_RETRY_DELAY{ 250 };
+
+std::chrono::milliseconds NextRetryDelay(std::chrono::milliseconds previous) {
+    static thread_local std::mt19937 rng(std::random_device{}());
+
+    long long upper = std::max(BASE_RETRY_DELAY.count(), previous.count() * 3);
+    std::uniform_int_distribution<long long> dist(BASE_RETRY_DELAY.count(), upper);
+    return std::min(std::chrono::milliseconds(dist(rng)), MAX_RETRY_DELAY);
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static long long DaysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+bool ParseRetryAfter(const std::string& value, std::chrono::milliseconds& delay) {
+    if (value.empty()) {
+        return false;
+    }
+
+    // delta-seconds
+    if (isdigit(static_cast<unsigned char>(value[0]))) {
+        long long seconds = atoll(value.c_str());
+        delay = std::chrono::milliseconds(seconds * 1000);
+        return true;
+    }
+
+    // IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+    char monthName[4] = { 0 };
+    int day, year, hour, minute, second;
+    if (sscanf(value.c_str(), "%*3s, %d %3s %d %d:%d:%d", &day, monthName, &year, &hour, &minute, &second) != 6) {
+        return false;
+    }
+
+    static const char* months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    int month = 0;
+    for (int i = 0; i < 12; ++i) {
+        if (strcmp(monthName, months[i]) == 0) {
+            month = i + 1;
+            break;
+        }
+    }
+    if (month == 0) {
+        return false;
+    }
+
+    long long target = DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    long long now = static_cast<long long>(time(nullptr));
+    delay = std::chrono::milliseconds(std::max(0LL, target - now) * 1000);
+    return true;
+}
+
+bool CircuitBreaker::AllowRequest() {
+    if (g_config.circuit_breaker_threshold <= 0) {
+        return true;  // Disabled
+    }
+
+    std::lock_guard<std::mutex> lock(breakerMutex);
+
+    switch (state) {
+    case State::Closed:
+        return true;
+
+    case State::Open:
+        if (std::chrono::steady_clock::now() < openUntil) {
+            rejected++;
+            return false;
+        }
+        LOG_INFO(L"Circuit breaker for " + std::wstring(name.begin(), name.end()) + L" half-open, probing server");
+        state = State::HalfOpen;
+        probeInFlight = true;
+        return true;
+
+    case State::HalfOpen:
+        // Only the single probe may go through until it reports back
+        if (probeInFlight) {
+            rejected++;
+            return false;
+        }
+        probeInFlight = true;
+        return true;
+    }
+
+    return true;
+}
+
+void CircuitBreaker::RecordSuccess() {
+    std::lock_guard<std::mutex> lock(breakerMutex);
+
+    if (state != State::Closed) {
+        LOG_INFO(L"Circuit breaker for " + std::wstring(name.begin(), name.end()) + L" closed, server recovered");
+    }
+    state = State::Closed;
+    consecutiveFailures = 0;
+    probeInFlight = false;
+}
+
+void CircuitBreaker::RecordFailure() {
+    if (g_config.circuit_breaker_threshold <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(breakerMutex);
+
+    consecutiveFailures++;
+    probeInFlight = false;
+
+    bool trip = (state == State::HalfOpen) ||
+        (state == State::Closed && consecutiveFailures >= g_config.circuit_breaker_threshold);
+    if (!trip) {
+        return;
+    }
+
+    state = State::Open;
+    openUntil = std::chrono::steady_clock::now() + std::chrono::seconds(g_config.circuit_breaker_cooldown_seconds);
+    trips++;
+    LOG_WARNING(L"Circuit breaker for " + std::wstring(name.begin(), name.end()) + L" opened after " +
+        std::to_wstring(consecutiveFailures) + L" consecutive failures, failing fast for " +
+        std::to_wstring(g_config.circuit_breaker_cooldown_seconds) + L"s");
+}
+
+void CircuitBreaker::RecordCancelled() {
+    std::lock_guard<std::mutex> lock(breakerMutex);
+
+    // A cancelled probe frees the slot for the next request to probe
+    probeInFlight = false;
+}
+
+bool CircuitBreaker::IsAvailable() {
+    if (g_config.circuit_breaker_threshold <= 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(breakerMutex);
+    switch (state) {
+    case State::Open:
+        return std::chrono::steady_clock::now() >= openUntil;
+    case State::HalfOpen:
+        return !probeInFlight;
+    default:
+        return true;
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::GetState() {
+    std::lock_guard<std::mutex> lock(breakerMutex);
+    return state;
+}
+
+void CircuitBreaker::LogStats() {
+    std::lock_guard<std::mutex> lock(breakerMutex);
+    if (trips > 0 || rejected > 0) {
+        LOG_INFO(L"Circuit breaker " + std::wstring(name.begin(), name.end()) + L": tripped " +
+            std::to_wstring(trips) + L" times, " + std::to_wstring(rejected) + L" requests failed fast");
+    }
+}
+
+CircuitBreaker& CircuitBreakerRegistry::For(const std::string& host, uint16_t port) {
+    std::string key = host + ":" + std::to_string(port);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == key) {
+            return *breakers[i];
+        }
+    }
+
+    keys.push_back(key);
+    breakers.push_back(std::make_unique<CircuitBreaker>(key));
+    return *breakers.back();
+}
+
+void CircuitBreakerRegistry::LogStats() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& breaker : breakers) {
+        breaker->LogStats();
+    }
+}
@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_RETRY_POLICY_H
+#define TTS_STELLARIS_RETRY_POLICY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+// Retry timing and failure isolation for server requests
+
+// Decorrelated jitter backoff: random between the base delay and three times
+// the previous delay, capped. Spreads retries from many workers apart instead
+// of having them hit a recovering server in lockstep.
+std::chrono::milliseconds NextRetryDelay(std::chrono::milliseconds previous);
+
+// Longest delay a retry is allowed to wait (including server-requested Retry-After)
+constexpr std::chrono::milliseconds MAX_RETRY_DELAY{ 30000 };
+
+// Parse a Retry-After header: delta-seconds or an IMF-fixdate HTTP date
+bool ParseRetryAfter(const std::string& value, std::chrono::milliseconds& delay);
+
+// Per-server circuit breaker
+// Closed:   requests flow; consecutive failures are counted
+// Open:     after circuit_breaker_threshold failures, requests fail immediately
+//           for circuit_breaker_cooldown_seconds
+// HalfOpen: after the cooldown one probe request is let through; its result
+//           closes the breaker again or re-opens it
+class CircuitBreaker {
+public:
+    enum class State {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+private:
+    std::string name;
+    std::mutex breakerMutex;
+    State state = State::Closed;
+    int consecutiveFailures = 0;
+    bool probeInFlight = false;
+    std::chrono::steady_clock::time_point openUntil;
+    uint64_t rejected = 0;
+    uint64_t trips = 0;
+
+public:
+    explicit CircuitBreaker(const std::string& serverName) : name(serverName) {}
+
+    // False while open - the caller should fail fast without contacting the server
+    bool AllowRequest();
+
+    // Every allowed request must end in exactly one of these
+    void RecordSuccess();
+    void RecordFailure();
+
+    // We gave up on the request ourselves - says nothing about the server
+    void RecordCancelled();
+
+    // Would AllowRequest let a request through right now (without claiming the probe)
+    bool IsAvailable();
+
+    State GetState();
+    void LogStats();
+};
+
+// Breakers keyed by host:port
+class CircuitBreakerRegistry {
+private:
+    std::vector<std::unique_ptr<CircuitBreaker>> breakers;
+    std::vector<std::string> keys;
+    std::mutex registryMutex;
+
+public:
+    CircuitBreaker& For(const std::string& host, uint16_t port);
+    void LogStats();
+};
+
+// Global circuit breaker registry
+extern CircuitBreakerRegistry g_circuitBreakers;
+
+#endif // TTS_STELLARIS_RETRY_POLICY_H
@@ -0,0 +1,697 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "socket_event_loop.h"
+#include "socket_platform.h"
+#include "cancellation.h"
+#include "config.h"
+#include "logger.h"
+
+#include <chrono>
+#include <cstdlib>
+
+// Global socket event loop instance
+SocketEventLoop g_socketEventLoop;
+
+namespace {
+
+constexpr size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+constexpr size_t MAX_LINE_SIZE = 16 * 1024;   // Status, header or chunk-size line
+constexpr int MAX_READS_PER_EVENT = 4;        // Then give the other connections a turn
+constexpr int MAX_POLL_WAIT_MS = 1000;
+
+struct ResolvedAddress {
+    sockaddr_storage storage;
+    socklen_t length;
+    int family;
+    int socktype;
+    int protocol;
+};
+
+} // namespace
+
+std::string HttpResponseHead::Header(const char* name) const {
+    for (const auto& header : headers) {
+        if (EqualsIgnoreCase(header.first, name)) {
+            return header.second;
+        }
+    }
+    return std::string();
+}
+
+// A request between Start and its connection
+struct SocketEventLoop::Pending {
+    std::string host;
+    uint16_t port = 80;
+    std::string requestBytes;      // Head and body, ready to send
+    std::vector<ResolvedAddress> addresses;
+    std::shared_ptr<AsyncHttpHandler> handler;
+    HttpTimings* timings = nullptr;   // Owned by the handler
+
+    // Cancelling only raises the flag and wakes the loop, which closes the connection
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    std::unique_ptr<CancellationRegistration> cancelRegistration;
+};
+
+struct SocketEventLoop::Connection {
+    enum class State { Connecting, Sending, Receiving };
+    enum class Parse { StatusLine, Headers, Body, ChunkSize, ChunkData, ChunkEnd, Trailers, Done };
+    enum class BodyMode { Length, Chunked, UntilClose };
+
+    std::unique_ptr<Pending> request;
+    SocketHandle socket = BAD_SOCKET;
+    bool reused = false;
+    bool staleRetried = false;
+    size_t nextAddress = 0;
+    int lastError = 0;             // Why the last connect attempt failed
+    State state = State::Connecting;
+    size_t sent = 0;
+    std::chrono::steady_clock::time_point deadline;
+    bool paused = false;           // Consumer full; not polled for reading
+    bool finished = false;
+
+    // Response parser
+    Parse parse = Parse::StatusLine;
+    BodyMode mode = BodyMode::UntilClose;
+    std::string line;
+    HttpResponseHead head;
+    uint64_t remaining = 0;
+    bool closeAfter = false;
+    bool gotBytes = false;
+};
+
+// DLL Best Practices: like the transports, open sockets are left to process teardown
+SocketEventLoop::~SocketEventLoop() {
+    Shutdown();
+}
+
+void SocketEventLoop::Configure(size_t maxInflight) {
+    std::lock_guard<std::mutex> lock(loopMutex);
+    if (started) {
+        LOG_WARNING(L"Socket event loop already running, new limit ignored");
+        return;
+    }
+    maxActive = maxInflight > 0 ? maxInflight : 1;
+}
+
+bool SocketEventLoop::EnsureStarted(std::wstring& error) {
+    if (!g_socketTransport.EnsureStarted(error)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(loopMutex);
+    if (started) {
+        return true;
+    }
+    if (stop.load()) {
+        error = L"Socket event loop is shut down";
+        return false;
+    }
+
+    // poll can't wait on a condition variable, so other threads wake it with a datagram
+    wakeSocket = static_cast<SocketHandle>(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (wakeSocket == BAD_SOCKET) {
+        error = L"Failed to create event loop wake socket (socket error " + std::to_wstring(LastSocketError()) + L")";
+        return false;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(wakeSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        getsockname(wakeSocket, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        connect(wakeSocket, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+        !SetNonBlocking(wakeSocket, true)) {
+        error = L"Failed to set up event loop wake socket (socket error " + std::to_wstring(LastSocketError()) + L")";
+        CloseSocket(wakeSocket);
+        wakeSocket = BAD_SOCKET;
+        return false;
+    }
+
+    LOG_INFO(L"Starting socket event loop, up to " + std::to_wstring(maxActive) + L" requests in flight");
+    loopThread = std::make_unique<std::thread>(&SocketEventLoop::Run, this);
+    started = true;
+    return true;
+}
+
+void SocketEventLoop::Wake() {
+    char signal = 1;
+    send(wakeSocket, &signal, 1, 0);
+}
+
+void SocketEventLoop::Start(const HttpRequest& request, std::shared_ptr<AsyncHttpHandler> handler) {
+    std::wstring error;
+    if (request.secure) {
+        handler->OnComplete(false, L"The socket transport only supports http://, use transport=wininet for https");
+        return;
+    }
+    if (!EnsureStarted(error)) {
+        handler->OnComplete(false, error);
+        return;
+    }
+
+    auto pending = std::make_unique<Pending>();
+    pending->host = request.host;
+    pending->port = request.port;
+    pending->handler = std::move(handler);
+    pending->timings = request.timings;
+    pending->requestBytes = FormatRequestHead(request, g_config.keep_alive);
+    pending->requestBytes.append(request.body, request.bodySize);
+
+    // Resolved here on the caller's thread, since getaddrinfo blocks
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    std::string portStr = std::to_string(request.port);
+    int result = getaddrinfo(request.host.c_str(), portStr.c_str(), &hints, &addresses);
+    if (result != 0 || !addresses) {
+        pending->handler->OnComplete(false, L"Failed to resolve " +
+            std::wstring(request.host.begin(), request.host.end()) + L" (" + std::to_wstring(result) + L")");
+        return;
+    }
+    for (addrinfo* addr = addresses; addr; addr = addr->ai_next) {
+        ResolvedAddress resolved = {};
+        memcpy(&resolved.storage, addr->ai_addr, addr->ai_addrlen);
+        resolved.length = static_cast<socklen_t>(addr->ai_addrlen);
+        resolved.family = addr->ai_family;
+        resolved.socktype = addr->ai_socktype;
+        resolved.protocol = addr->ai_protocol;
+        pending->addresses.push_back(resolved);
+    }
+    freeaddrinfo(addresses);
+    MarkPhase(pending->timings, &HttpTimings::resolved);
+
+    pending->cancelled = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<bool>> flag = pending->cancelled;
+    pending->cancelRegistration = std::make_unique<CancellationRegistration>(request.cancel, [this, flag]() {
+        flag->store(true);
+        Wake();
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(loopMutex);
+        incoming.push_back(std::move(pending));
+    }
+    Wake();
+}
+
+// Loop thread: give the request a connection, or a place in line
+void SocketEventLoop::Admit(std::unique_ptr<Pending> pending) {
+    if (pending->cancelled->load()) {
+        pending->cancelRegistration.reset();
+        pending->handler->OnComplete(false, L"Request cancelled");
+        return;
+    }
+    if (active.size() >= maxActive) {
+        requestsQueued++;
+        waiting.push_back(std::move(pending));
+        return;
+    }
+
+    auto connection = std::make_unique<Connection>();
+    connection->request = std::move(pending);
+    Connection& c = *connection;
+    active.push_back(std::move(connection));
+    requestsStarted++;
+    peakActive = std::max(peakActive, active.size());
+
+    c.socket = g_config.keep_alive ? g_socketTransport.TakeIdle(c.request->host, c.request->port) : BAD_SOCKET;
+    if (c.socket != BAD_SOCKET && SetNonBlocking(c.socket, true)) {
+        c.reused = true;
+        c.state = Connection::State::Sending;
+        c.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CONNECT_SEND_TIMEOUT_MS);
+        return;
+    }
+    if (c.socket != BAD_SOCKET) {
+        CloseSocket(c.socket);
+        c.socket = BAD_SOCKET;
+    }
+
+    std::wstring error;
+    if (!BeginConnect(c, error)) {
+        Finish(c, false, error);
+    }
+}
+
+// Start a non-blocking connect to the next address that takes one
+bool SocketEventLoop::BeginConnect(Connection& c, std::wstring& error) {
+    int& lastError = c.lastError;
+    const std::vector<ResolvedAddress>& addresses = c.request->addresses;
+
+    while (c.nextAddress < addresses.size()) {
+        const ResolvedAddress& address = addresses[c.nextAddress++];
+        SocketHandle s = static_cast<SocketHandle>(::socket(address.family, address.socktype, address.protocol));
+        if (s == BAD_SOCKET) {
+            lastError = LastSocketError();
+            continue;
+        }
+
+        // Timeouts matter once the socket is pooled and used by the blocking transport
+        SetSocketTimeout(s, SO_SNDTIMEO, CONNECT_SEND_TIMEOUT_MS);
+        SetSocketTimeout(s, SO_RCVTIMEO, RECEIVE_TIMEOUT_MS);
+        int noDelay = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        if (!SetNonBlocking(s, true)) {
+            lastError = LastSocketError();
+            CloseSocket(s);
+            continue;
+        }
+
+        c.socket = s;
+        c.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CONNECT_SEND_TIMEOUT_MS);
+        if (connect(s, reinterpret_cast<const sockaddr*>(&address.storage), address.length) == 0) {
+            c.state = Connection::State::Sending;
+            MarkPhase(c.request->timings, &HttpTimings::connected);
+        } else if (IsConnectPending(LastSocketError())) {
+            c.state = Connection::State::Connecting;
+        } else {
+            lastError = LastSocketError();
+            CloseSocket(s);
+            c.socket = BAD_SOCKET;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(g_socketTransport.poolMutex);
+        g_socketTransport.connectionsCreated++;
+        return true;
+    }
+
+    error = L"Failed to connect to " + std::wstring(c.request->host.begin(), c.request->host.end()) + L":" +
+        std::to_wstring(c.request->port) + L" (socket error " + std::to_wstring(lastError) + L")";
+    return false;
+}
+
+void SocketEventLoop::HandleEvents(Connection& c, short events) {
+    if (c.state == Connection::State::Connecting) {
+        int socketError = 0;
+        socklen_t length = sizeof(socketError);
+        getsockopt(c.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&socketError), &length);
+
+        if (socketError != 0) {
+            c.lastError = socketError;
+            CloseSocket(c.socket);
+            c.socket = BAD_SOCKET;
+
+            std::wstring error;
+            if (!BeginConnect(c, error)) {
+                Finish(c, false, error);
+            }
+            return;
+        }
+        c.state = Connection::State::Sending;
+        MarkPhase(c.request->timings, &HttpTimings::connected);
+    }
+
+    if (c.state == Connection::State::Sending) {
+        HandleWritable(c);
+    } else if (events != 0) {
+        HandleReadable(c);
+    }
+}
+
+void SocketEventLoop::HandleWritable(Connection& c) {
+    const std::string& bytes = c.request->requestBytes;
+    while (c.sent < bytes.size()) {
+        int chunk = static_cast<int>(std::min<size_t>(bytes.size() - c.sent, 1 << 20));
+        int n = send(c.socket, bytes.data() + c.sent, chunk, SEND_FLAGS);
+        if (n > 0) {
+            c.sent += n;
+            continue;
+        }
+
+        int error = LastSocketError();
+        if (n < 0 && IsWouldBlock(error)) {
+            return;  // Socket buffer full; poll says when there is room
+        }
+
+        // A pooled connection may have been closed by the server; retry once on a fresh one
+        if (c.reused && !c.staleRetried) {
+            LOG_DEBUG(L"Pooled connection went stale, reconnecting");
+            CloseSocket(c.socket);
+            c.socket = BAD_SOCKET;
+            c.reused = false;
+            c.staleRetried = true;
+            c.sent = 0;
+
+            std::wstring connectError;
+            if (!BeginConnect(c, connectError)) {
+                Finish(c, false, connectError);
+            }
+            return;
+        }
+        Finish(c, false, L"Failed to send request (socket error " + std::to_wstring(error) + L")");
+        return;
+    }
+
+    c.state = Connection::State::Receiving;
+    MarkPhase(c.request->timings, &HttpTimings::requestSent);
+    c.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RECEIVE_TIMEOUT_MS);
+}
+
+void SocketEventLoop::HandleReadable(Connection& c) {
+    // Only the loop thread receives, so one buffer serves every connection
+    static std::vector<uint8_t> buffer(RECEIVE_BUFFER_SIZE);
+
+    for (int reads = 0; reads < MAX_READS_PER_EVENT && !c.finished; ++reads) {
+        if (reads > 0 && !c.request->handler->ReadyForBody()) {
+            return;
+        }
+        int n = recv(c.socket, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0);
+        if (n > 0) {
+            MarkPhaseOnce(c.request->timings, &HttpTimings::firstByte);
+            c.gotBytes = true;
+            c.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RECEIVE_TIMEOUT_MS);
+            if (!FeedResponse(c, buffer.data(), static_cast<size_t>(n))) {
+                return;
+            }
+            continue;
+        }
+
+        int error = LastSocketError();
+        if (n < 0 && IsWouldBlock(error)) {
+            return;
+        }
+
+        // Closed or reset: the end of a close-delimited body, a stale pooled connection, or a failure
+        if (n == 0 && c.parse == Connection::Parse::Body && c.mode == Connection::BodyMode::UntilClose) {
+            c.parse = Connection::Parse::Done;
+            Finish(c, true, L"");
+        } else if (c.reused && !c.gotBytes && !c.staleRetried) {
+            LOG_DEBUG(L"Pooled connection went stale, reconnecting");
+            CloseSocket(c.socket);
+            c.socket = BAD_SOCKET;
+            c.reused = false;
+            c.staleRetried = true;
+            c.sent = 0;
+
+            std::wstring connectError;
+            if (!BeginConnect(c, connectError)) {
+                Finish(c, false, connectError);
+            }
+        } else if (c.parse == Connection::Parse::StatusLine || c.parse == Connection::Parse::Headers) {
+            Finish(c, false, L"Connection closed before response headers");
+        } else {
+            Finish(c, false, L"Connection lost inside the response body");
+        }
+        return;
+    }
+}
+
+// Push received bytes through the response parser; false once the request is finished
+bool SocketEventLoop::FeedResponse(Connection& c, const uint8_t* data, size_t size) {
+    using Parse = Connection::Parse;
+    using BodyMode = Connection::BodyMode;
+    size_t pos = 0;
+
+    while (pos < size) {
+        if (c.parse == Parse::Body || c.parse == Parse::ChunkData) {
+            size_t n = size - pos;
+            if (c.parse == Parse::ChunkData || c.mode == BodyMode::Length) {
+                n = static_cast<size_t>(std::min<uint64_t>(n, c.remaining));
+                c.remaining -= n;
+            }
+            if (!c.request->handler->OnBody(data + pos, n)) {
+                Finish(c, false, L"Request stopped by the consumer");
+                return false;
+            }
+            pos += n;
+
+            if (c.remaining == 0 && c.mode != BodyMode::UntilClose) {
+                c.parse = (c.parse == Parse::ChunkData) ? Parse::ChunkEnd : Parse::Done;
+            }
+        } else if (c.parse == Parse::Done) {
+            // Bytes after the end of the response: the connection can't be trusted for reuse
+            c.closeAfter = true;
+            break;
+        } else {
+            // Line-oriented states
+            const uint8_t* newline = static_cast<const uint8_t*>(memchr(data + pos, '\n', size - pos));
+            size_t take = newline ? static_cast<size_t>(newline - (data + pos)) + 1 : size - pos;
+            c.line.append(reinterpret_cast<const char*>(data + pos), take);
+            pos += take;
+
+            if (c.line.size() > MAX_LINE_SIZE) {
+                Finish(c, false, L"Response line too long");
+                return false;
+            }
+            if (!newline) {
+                break;
+            }
+
+            c.line.pop_back();
+            if (!c.line.empty() && c.line.back() == '\r') {
+                c.line.pop_back();
+            }
+
+            std::string line;
+            line.swap(c.line);
+
+            if (c.parse == Parse::StatusLine) {
+                size_t space = line.find(' ');
+                if (line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+                    Finish(c, false, L"Malformed status line");
+                    return false;
+                }
+                c.head.statusCode = atoi(line.c_str() + space + 1);
+                c.closeAfter = line.compare(0, 8, "HTTP/1.0") == 0;
+                c.head.headers.clear();
+                c.parse = Parse::Headers;
+            } else if (c.parse == Parse::Headers && !line.empty()) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+                    c.head.headers.emplace_back(line.substr(0, colon),
+                        valueStart == std::string::npos ? std::string() : line.substr(valueStart));
+                }
+            } else if (c.parse == Parse::Headers) {
+                // Skip interim 1xx responses
+                if (c.head.statusCode >= 100 && c.head.statusCode < 200) {
+                    c.parse = Parse::StatusLine;
+                    continue;
+                }
+
+                std::string connection = c.head.Header("Connection");
+                if (ContainsIgnoreCase(connection, "close")) {
+                    c.closeAfter = true;
+                } else if (ContainsIgnoreCase(connection, "keep-alive")) {
+                    c.closeAfter = false;
+                }
+
+                std::string length = c.head.Header("Content-Length");
+                if (ContainsIgnoreCase(c.head.Header("Transfer-Encoding"), "chunked")) {
+                    c.mode = BodyMode::Chunked;
+                    c.parse = Parse::ChunkSize;
+                } else if (!length.empty()) {
+                    c.mode = BodyMode::Length;
+                    c.head.contentLength = c.remaining = strtoull(length.c_str(), nullptr, 10);
+                    c.parse = (c.remaining == 0) ? Parse::Done : Parse::Body;
+                } else {
+                    c.mode = BodyMode::UntilClose;
+                    c.closeAfter = true;
+                    c.parse = Parse::Body;
+                }
+                if (c.head.statusCode == 204 || c.head.statusCode == 304) {
+                    c.parse = Parse::Done;
+                }
+
+                c.head.connectionReused = c.reused;
+                if (!c.request->handler->OnResponse(c.head)) {
+                    Finish(c, false, L"Request stopped by the consumer");
+                    return false;
+                }
+            } else if (c.parse == Parse::ChunkSize) {
+                char* end = nullptr;
+                c.remaining = strtoull(line.c_str(), &end, 16);
+                if (end == line.c_str()) {
+                    Finish(c, false, L"Malformed chunk size");
+                    return false;
+                }
+                c.parse = (c.remaining == 0) ? Parse::Trailers : Parse::ChunkData;
+            } else if (c.parse == Parse::ChunkEnd) {
+                if (!line.empty()) {
+                    Finish(c, false, L"Malformed chunk");
+                    return false;
+                }
+                c.parse = Parse::ChunkSize;
+            } else if (c.parse == Parse::Trailers && line.empty()) {
+                c.parse = Parse::Done;
+            }
+        }
+    }
+
+    if (c.parse == Parse::Done) {
+        Finish(c, true, L"");
+        return false;
+    }
+    return true;
+}
+
+void SocketEventLoop::Finish(Connection& c, bool ok, const std::wstring& error) {
+    if (c.finished) {
+        return;
+    }
+    c.finished = true;
+    c.request->cancelRegistration.reset();
+
+    if (c.socket != BAD_SOCKET) {
+        bool reusable = ok && c.parse == Connection::Parse::Done && !c.closeAfter;
+        if (reusable && SetNonBlocking(c.socket, false)) {
+            g_socketTransport.Recycle(c.request->host, c.request->port, c.socket);
+        } else {
+            CloseSocket(c.socket);
+        }
+        c.socket = BAD_SOCKET;
+    }
+
+    std::shared_ptr<AsyncHttpHandler> handler = std::move(c.request->handler);
+    try {
+        handler->OnComplete(ok, error);
+    } catch (...) {
+        LOG_ERROR(L"Exception in socket event loop completion");
+    }
+}
+
+void SocketEventLoop::Run() {
+    LOG_DEBUG(L"Socket event loop started");
+
+    std::vector<pollfd> fds;
+    std::vector<Connection*> polled;
+    std::deque<std::unique_ptr<Pending>> arrived;
+
+    while (!stop.load()) {
+        {
+            std::lock_guard<std::mutex> lock(loopMutex);
+            arrived.swap(incoming);
+        }
+        while (!arrived.empty()) {
+            Admit(std::move(arrived.front()));
+            arrived.pop_front();
+        }
+
+        // Cancellations and timeouts
+        auto now = std::chrono::steady_clock::now();
+        auto nextDeadline = now + std::chrono::milliseconds(MAX_POLL_WAIT_MS);
+        for (auto& connection : active) {
+            Connection& c = *connection;
+            if (c.finished) continue;
+
+            c.paused = false;
+            if (c.request->cancelled->load()) {
+                Finish(c, false, L"Request cancelled");
+            } else if (c.state == Connection::State::Receiving && !c.request->handler->ReadyForBody()) {
+                // Waiting on the consumer, not the server
+                c.paused = true;
+                c.deadline = now + std::chrono::milliseconds(RECEIVE_TIMEOUT_MS);
+            } else if (now >= c.deadline) {
+                Finish(c, false, c.state == Connection::State::Receiving
+                    ? L"Timed out waiting for the server" : L"Timed out connecting to the server");
+            } else {
+                nextDeadline = std::min(nextDeadline, c.deadline);
+            }
+        }
+        for (auto it = waiting.begin(); it != waiting.end();) {
+            if ((*it)->cancelled->load()) {
+                std::unique_ptr<Pending> pending = std::move(*it);
+                it = waiting.erase(it);
+                Admit(std::move(pending));   // Completes it as cancelled
+            } else {
+                ++it;
+            }
+        }
+
+        // Drop finished connections and let waiting requests into the freed slots
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [](const std::unique_ptr<Connection>& c) { return c->finished; }), active.end());
+        while (active.size() < maxActive && !waiting.empty()) {
+            std::unique_ptr<Pending> pending = std::move(waiting.front());
+            waiting.pop_front();
+            Admit(std::move(pending));
+        }
+        if (std::any_of(active.begin(), active.end(), [](const std::unique_ptr<Connection>& c) { return c->finished; })) {
+            continue;  // A connect failed at once; sweep again before polling
+        }
+
+        fds.clear();
+        polled.clear();
+        pollfd wake = {};
+        wake.fd = wakeSocket;
+        wake.events = POLLIN;
+        fds.push_back(wake);
+        for (auto& connection : active) {
+            if (connection->paused) {
+                continue;
+            }
+            pollfd entry = {};
+            entry.fd = connection->socket;
+            entry.events = (connection->state == Connection::State::Receiving) ? POLLIN : POLLOUT;
+            fds.push_back(entry);
+            polled.push_back(connection.get());
+        }
+
+        // WSAPoll on older Windows never reports a refused connect; the
+        // connect deadline above still ends such a request
+        int timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            nextDeadline - std::chrono::steady_clock::now()).count());
+        int ready = PollSockets(fds.data(), fds.size(), std::max(0, timeoutMs) + 1);
+        if (ready < 0) {
+            LOG_ERROR(L"Socket event loop poll failed (socket error " + std::to_wstring(LastSocketError()) + L")");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        if (fds[0].revents != 0) {
+            char drain[64];
+            while (recv(wakeSocket, drain, sizeof(drain), 0) > 0) {}
+        }
+        for (size_t i = 0; i < polled.size(); ++i) {
+            if (fds[i + 1].revents != 0 && !polled[i]->finished) {
+                HandleEvents(*polled[i], fds[i + 1].revents);
+            }
+        }
+    }
+
+    LOG_DEBUG(L"Socket event loop stopped");
+}
+
+void SocketEventLoop::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(loopMutex);
+        if (!started || stop.load()) {
+            stop.store(true);
+            return;
+        }
+        stop.store(true);
+    }
+
+    Wake();
+    if (loopThread && loopThread->joinable()) {
+        loopThread->join();
+    }
+
+    LOG_INFO(L"Socket event loop: " + std::to_wstring(requestsStarted) + L" requests, peak " +
+        std::to_wstring(peakActive) + L" in flight, " + std::to_wstring(requestsQueued) + L" waited for a slot");
+}
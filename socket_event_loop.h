@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_SOCKET_EVENT_LOOP_H
+#define TTS_STELLARIS_SOCKET_EVENT_LOOP_H
+
+#include "http_transport.h"
+#include "socket_transport.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// Status line and headers of a response on the event loop
+struct HttpResponseHead {
+    int statusCode = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    uint64_t contentLength = 0;    // 0 if unknown (chunked or close-delimited)
+    bool connectionReused = false;
+
+    // Value of a response header, empty if absent
+    std::string Header(const char* name) const;
+};
+
+// Receives the events of one request; all calls come from the event loop thread
+// and must not block, since every other request waits meanwhile
+class AsyncHttpHandler {
+public:
+    virtual ~AsyncHttpHandler() = default;
+
+    // Final (non-1xx) status and headers; return false to stop the request
+    virtual bool OnResponse(const HttpResponseHead& head) = 0;
+
+    // Next block of the body, chunked framing removed; return false to stop the request
+    virtual bool OnBody(const uint8_t* data, size_t size) = 0;
+
+    // False while the consumer has no room for more body: the loop stops
+    // reading the socket, so TCP flow control holds the server back, and
+    // asks again after a Wake (or within a second). The receive timeout
+    // doesn't run meanwhile.
+    virtual bool ReadyForBody() { return true; }
+
+    // Called exactly once; ok is false if the request failed or was stopped
+    virtual void OnComplete(bool ok, const std::wstring& error) = 0;
+};
+
+// Runs many plain-http requests on one thread
+// Sockets are non-blocking and multiplexed with poll (WSAPoll on Windows), so
+// a request in flight costs a small connection record instead of a worker
+// thread blocked in recv. Connections come from and go back to the socket
+// transport's keep-alive pool. Requests beyond the in-flight limit wait in
+// line for a free slot.
+class SocketEventLoop {
+private:
+    struct Connection;
+    struct Pending;
+
+    std::unique_ptr<std::thread> loopThread;
+    std::mutex loopMutex;
+    std::deque<std::unique_ptr<Pending>> incoming;   // Started, not yet picked up by the loop
+    SocketHandle wakeSocket;                         // Loopback UDP socket connected to itself
+    bool started = false;
+    std::atomic<bool> stop{ false };
+
+    // Loop thread only
+    std::vector<std::unique_ptr<Connection>> active;
+    std::deque<std::unique_ptr<Pending>> waiting;    // Over the in-flight limit
+    size_t maxActive = 32;
+    size_t peakActive = 0;
+    uint64_t requestsStarted = 0;
+    uint64_t requestsQueued = 0;
+
+    bool EnsureStarted(std::wstring& error);
+    void Run();
+
+    void Admit(std::unique_ptr<Pending> pending);
+    bool BeginConnect(Connection& connection, std::wstring& error);
+    void HandleEvents(Connection& connection, short events);
+    void HandleWritable(Connection& connection);
+    void HandleReadable(Connection& connection);
+    bool FeedResponse(Connection& connection, const uint8_t* data, size_t size);
+    void Finish(Connection& connection, bool ok, const std::wstring& error);
+
+public:
+    SocketEventLoop() = default;
+    ~SocketEventLoop();
+
+    // In-flight limit; only takes effect before the first request
+    void Configure(size_t maxInflight);
+
+    // Queue a request (the body is copied) and return at once. OnComplete
+    // is called on the loop thread, or before Start returns if the request
+    // can't be started at all. Cancelling request.cancel stops it wherever it is.
+    void Start(const HttpRequest& request, std::shared_ptr<AsyncHttpHandler> handler);
+
+    // Have the loop look at its requests again, e.g. after a consumer made room
+    void Wake();
+
+    // Stop the loop; requests still running are dropped without callbacks
+    void Shutdown();
+};
+
+// Global socket event loop instance
+extern SocketEventLoop g_socketEventLoop;
+
+#endif // TTS_STELLARIS_SOCKET_EVENT_LOOP_H
@@ -0,0 +1,132 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_SOCKET_PLATFORM_H
+#define TTS_STELLARIS_SOCKET_PLATFORM_H
+
+// Winsock / BSD socket differences and small HTTP helpers, shared by the
+// socket transport and its event loop
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "socket_transport.h"
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+#ifdef _WIN32
+const SocketHandle BAD_SOCKET = static_cast<SocketHandle>(INVALID_SOCKET);
+inline void CloseSocket(SocketHandle s) { closesocket(static_cast<SOCKET>(s)); }
+inline void ShutdownSocket(SocketHandle s) { shutdown(static_cast<SOCKET>(s), SD_BOTH); }
+inline int LastSocketError() { return WSAGetLastError(); }
+inline bool IsWouldBlock(int error) { return error == WSAEWOULDBLOCK; }
+inline bool IsConnectPending(int error) { return error == WSAEWOULDBLOCK; }
+
+inline bool SetNonBlocking(SocketHandle s, bool nonBlocking) {
+    u_long mode = nonBlocking ? 1 : 0;
+    return ioctlsocket(static_cast<SOCKET>(s), FIONBIO, &mode) == 0;
+}
+
+inline int PollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+#else
+const SocketHandle BAD_SOCKET = -1;
+inline void CloseSocket(SocketHandle s) { close(s); }
+inline void ShutdownSocket(SocketHandle s) { shutdown(s, SHUT_RDWR); }
+inline int LastSocketError() { return errno; }
+inline bool IsWouldBlock(int error) { return error == EAGAIN || error == EWOULDBLOCK; }
+inline bool IsConnectPending(int error) { return error == EINPROGRESS; }
+
+inline bool SetNonBlocking(SocketHandle s, bool nonBlocking) {
+    int flags = fcntl(s, F_GETFL, 0);
+    if (flags < 0) return false;
+    return fcntl(s, F_SETFL, nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
+}
+
+inline int PollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+#endif
+
+// Blocking sockets give up after these; the event loop applies the same limits
+constexpr int CONNECT_SEND_TIMEOUT_MS = 15000;
+constexpr int RECEIVE_TIMEOUT_MS = 30000;
+
+inline void SetSocketTimeout(SocketHandle s, int option, int milliseconds) {
+#ifdef _WIN32
+    DWORD value = static_cast<DWORD>(milliseconds);
+#else
+    timeval value = { milliseconds / 1000, (milliseconds % 1000) * 1000 };
+#endif
+    setsockopt(s, SOL_SOCKET, option, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;   // Report a dropped peer as an error, not SIGPIPE
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+// Request line and headers for an HTTP/1.1 request with a Content-Length body
+inline std::string FormatRequestHead(const HttpRequest& request, bool keepAlive) {
+    return std::string(request.method) + " " + request.path + " HTTP/1.1\r\n"
+        "Host: " + request.host + (request.port != 80 ? ":" + std::to_string(request.port) : std::string()) + "\r\n"
+        "Content-Length: " + std::to_string(request.bodySize) + "\r\n"
+        "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n" +
+        request.headers + "\r\n";
+}
+
+inline bool EqualsIgnoreCase(const std::string& a, const char* b) {
+    size_t len = strlen(b);
+    if (a.size() != len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+inline bool ContainsIgnoreCase(const std::string& haystack, const char* needle) {
+    std::string lower(haystack);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return lower.find(needle) != std::string::npos;
+}
+
+#endif // TTS_STELLARIS_SOCKET_PLATFORM_H
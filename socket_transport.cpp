@@ -0,0 +1,481 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "socket_transport.h"
+#include "socket_platform.h"
+#include "cancellation.h"
+#include "config.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+
+// Global socket transport instance
+SocketTransport g_socketTransport;
+
+namespace {
+
+constexpr size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+
+bool SendAll(SocketHandle s, const char* data, size_t size) {
+    while (size > 0) {
+        int chunk = static_cast<int>(std::min<size_t>(size, 1 << 20));
+        int sent = send(s, data, chunk, SEND_FLAGS);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+class SocketResponse : public HttpResponse {
+private:
+    enum class BodyMode {
+        Length,       // Content-Length
+        Chunked,      // Transfer-Encoding: chunked
+        UntilClose    // Neither - body ends when the server closes
+    };
+
+    SocketTransport* transport;
+    std::string host;
+    uint16_t port;
+    SocketHandle socket;
+    bool reused;
+    HttpTimings* timings;
+
+    // Cancelling shuts the socket down, which wakes a blocked send or recv;
+    // it is only closed (and its number reused) after unregistering
+    std::shared_ptr<std::atomic<bool>> aborted;
+    std::unique_ptr<CancellationRegistration> cancelRegistration;
+
+    std::vector<uint8_t> buffer;
+    size_t bufPos = 0;
+    size_t bufEnd = 0;
+
+    int statusCode = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    BodyMode mode = BodyMode::UntilClose;
+    uint64_t contentLength = 0;
+    uint64_t remaining = 0;        // Left in the body (Length) or current chunk (Chunked)
+    bool chunkCrlfPending = false;
+    bool bodyDone = false;
+    bool closeAfter = false;
+    bool failed = false;
+    bool complete = false;
+
+    // Receive more bytes; returns the count, 0 if the peer closed, -1 on error
+    int Fill() {
+        if (bufPos > 0) {
+            memmove(buffer.data(), buffer.data() + bufPos, bufEnd - bufPos);
+            bufEnd -= bufPos;
+            bufPos = 0;
+        }
+        if (bufEnd == buffer.size()) {
+            return -1;  // Header line or chunk size line longer than the buffer
+        }
+        if (aborted->load()) {
+            return -1;  // Don't mistake the shutdown for a close-delimited body ending
+        }
+
+        int n = recv(socket, reinterpret_cast<char*>(buffer.data() + bufEnd), static_cast<int>(buffer.size() - bufEnd), 0);
+        if (aborted->load()) {
+            return -1;
+        }
+        if (n > 0) {
+            bufEnd += n;
+            MarkPhaseOnce(timings, &HttpTimings::firstByte);
+        }
+        return n < 0 ? -1 : n;
+    }
+
+    bool ReadLine(std::string& line) {
+        while (true) {
+            for (size_t i = bufPos; i + 1 < bufEnd; ++i) {
+                if (buffer[i] == '\r' && buffer[i + 1] == '\n') {
+                    line.assign(reinterpret_cast<const char*>(buffer.data() + bufPos), i - bufPos);
+                    bufPos = i + 2;
+                    return true;
+                }
+            }
+            if (Fill() <= 0) {
+                return false;
+            }
+        }
+    }
+
+    // Read the next chunk-size line; a zero size ends the body
+    bool StartChunk() {
+        std::string line;
+        if (chunkCrlfPending) {
+            if (!ReadLine(line) || !line.empty()) return false;
+            chunkCrlfPending = false;
+        }
+
+        if (!ReadLine(line)) return false;
+        char* end = nullptr;
+        remaining = strtoull(line.c_str(), &end, 16);
+        if (end == line.c_str()) return false;
+
+        if (remaining == 0) {
+            // Skip trailers up to the blank line
+            do {
+                if (!ReadLine(line)) return false;
+            } while (!line.empty());
+            bodyDone = true;
+        }
+        return true;
+    }
+
+    void Consume(size_t n) {
+        bufPos += n;
+        if (mode == BodyMode::UntilClose) return;
+
+        remaining -= n;
+        if (remaining == 0) {
+            if (mode == BodyMode::Length) {
+                bodyDone = true;
+            } else {
+                chunkCrlfPending = true;
+            }
+        }
+    }
+
+public:
+    SocketResponse(SocketTransport* owner, const std::string& h, uint16_t p, SocketHandle s, bool wasReused,
+        CancellationToken* cancel, HttpTimings* phaseTimings)
+        : transport(owner), host(h), port(p), socket(s), reused(wasReused), timings(phaseTimings),
+          aborted(std::make_shared<std::atomic<bool>>(false)), buffer(RECEIVE_BUFFER_SIZE) {
+        std::shared_ptr<std::atomic<bool>> flag = aborted;
+        cancelRegistration = std::make_unique<CancellationRegistration>(cancel, [flag, s]() {
+            flag->store(true);
+            ShutdownSocket(s);
+        });
+    }
+
+    ~SocketResponse() override {
+        cancelRegistration.reset();
+        if (complete && bodyDone && !closeAfter && !failed && !aborted->load()) {
+            transport->Recycle(host, port, socket);
+        } else {
+            CloseSocket(socket);
+        }
+    }
+
+    // Status line and headers
+    bool ReadHead(std::wstring& error) {
+        std::string line;
+
+        // Skip interim 1xx responses
+        do {
+            if (!ReadLine(line)) {
+                error = L"Connection closed before response headers";
+                return false;
+            }
+            size_t space = line.find(' ');
+            if (line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+                error = L"Malformed status line";
+                return false;
+            }
+            statusCode = atoi(line.c_str() + space + 1);
+            closeAfter = line.compare(0, 8, "HTTP/1.0") == 0;
+
+            headers.clear();
+            while (true) {
+                if (!ReadLine(line)) {
+                    error = L"Connection closed inside response headers";
+                    return false;
+                }
+                if (line.empty()) break;
+
+                size_t colon = line.find(':');
+                if (colon == std::string::npos) continue;
+                size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+                headers.emplace_back(line.substr(0, colon),
+                    valueStart == std::string::npos ? std::string() : line.substr(valueStart));
+            }
+        } while (statusCode >= 100 && statusCode < 200);
+
+        std::string connection = Header("Connection");
+        if (ContainsIgnoreCase(connection, "close")) {
+            closeAfter = true;
+        } else if (ContainsIgnoreCase(connection, "keep-alive")) {
+            closeAfter = false;
+        }
+
+        std::string length = Header("Content-Length");
+        if (ContainsIgnoreCase(Header("Transfer-Encoding"), "chunked")) {
+            mode = BodyMode::Chunked;
+        } else if (!length.empty()) {
+            mode = BodyMode::Length;
+            contentLength = remaining = strtoull(length.c_str(), nullptr, 10);
+            bodyDone = (remaining == 0);
+        } else {
+            mode = BodyMode::UntilClose;
+            closeAfter = true;
+        }
+
+        if (statusCode == 204 || statusCode == 304) {
+            bodyDone = true;
+        }
+        return true;
+    }
+
+    int StatusCode() const override { return statusCode; }
+    uint64_t ContentLength() const override { return contentLength; }
+    bool ConnectionReused() const override { return reused; }
+
+    std::string Header(const char* name) const override {
+        for (const auto& header : headers) {
+            if (EqualsIgnoreCase(header.first, name)) {
+                return header.second;
+            }
+        }
+        return std::string();
+    }
+
+    bool QueryAvailable(size_t& available) override {
+        available = 0;
+        if (failed) return false;
+        if (bodyDone) return true;
+
+        if (mode == BodyMode::Chunked && remaining == 0) {
+            if (!StartChunk()) {
+                failed = true;
+                return false;
+            }
+            if (bodyDone) return true;
+        }
+
+        if (bufPos == bufEnd) {
+            int n = Fill();
+            if (n == 0 && mode == BodyMode::UntilClose) {
+                bodyDone = true;
+                return true;
+            }
+            if (n <= 0) {
+                failed = true;
+                return false;
+            }
+        }
+
+        size_t buffered = bufEnd - bufPos;
+        available = (mode == BodyMode::UntilClose) ? buffered : static_cast<size_t>(std::min<uint64_t>(buffered, remaining));
+        return true;
+    }
+
+    bool Read(uint8_t* dest, size_t size, size_t& bytesRead) override {
+        bytesRead = 0;
+        while (bytesRead < size) {
+            size_t available = 0;
+            if (!QueryAvailable(available)) return false;
+            if (available == 0) break;
+
+            size_t n = std::min(available, size - bytesRead);
+            memcpy(dest + bytesRead, buffer.data() + bufPos, n);
+            Consume(n);
+            bytesRead += n;
+        }
+        return true;
+    }
+
+    void MarkComplete() override { complete = true; }
+
+    bool WasAborted() const { return aborted->load(); }
+};
+
+} // namespace
+
+// DLL Best Practices: like the WinINet pool, idle sockets are left to process
+// teardown rather than closed under the loader lock
+SocketTransport::~SocketTransport() {
+    idle.clear();
+}
+
+bool SocketTransport::EnsureStarted(std::wstring& error) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (started) {
+        return true;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+    if (result != 0) {
+        error = L"WSAStartup failed: " + std::to_wstring(result);
+        return false;
+    }
+#else
+    (void)error;
+#endif
+
+    started = true;
+    return true;
+}
+
+SocketHandle SocketTransport::Connect(const std::string& host, uint16_t port, HttpTimings* timings, std::wstring& error) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    std::string portStr = std::to_string(port);
+    int result = getaddrinfo(host.c_str(), portStr.c_str(), &hints, &addresses);
+    if (result != 0 || !addresses) {
+        error = L"Failed to resolve " + std::wstring(host.begin(), host.end()) + L" (" + std::to_wstring(result) + L")";
+        return BAD_SOCKET;
+    }
+    MarkPhase(timings, &HttpTimings::resolved);
+
+    SocketHandle s = BAD_SOCKET;
+    int lastError = 0;
+
+    for (addrinfo* addr = addresses; addr; addr = addr->ai_next) {
+        s = static_cast<SocketHandle>(::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol));
+        if (s == BAD_SOCKET) {
+            lastError = LastSocketError();
+            continue;
+        }
+
+        SetSocketTimeout(s, SO_SNDTIMEO, CONNECT_SEND_TIMEOUT_MS);
+        SetSocketTimeout(s, SO_RCVTIMEO, RECEIVE_TIMEOUT_MS);
+
+        if (connect(s, addr->ai_addr, static_cast<int>(addr->ai_addrlen)) == 0) {
+            break;
+        }
+
+        lastError = LastSocketError();
+        CloseSocket(s);
+        s = BAD_SOCKET;
+    }
+    freeaddrinfo(addresses);
+
+    if (s == BAD_SOCKET) {
+        error = L"Failed to connect to " + std::wstring(host.begin(), host.end()) + L":" + std::to_wstring(port) +
+            L" (socket error " + std::to_wstring(lastError) + L")";
+        return BAD_SOCKET;
+    }
+    MarkPhase(timings, &HttpTimings::connected);
+
+    // Requests are written in two sends; don't let Nagle hold back the body
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    connectionsCreated++;
+    return s;
+}
+
+SocketHandle SocketTransport::TakeIdle(const std::string& host, uint16_t port) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    auto idleLimit = std::chrono::seconds(g_config.keep_alive_idle_seconds);
+
+    idle.erase(std::remove_if(idle.begin(), idle.end(), [&](const IdleSocket& entry) {
+        if (now - entry.lastUsed < idleLimit) {
+            return false;
+        }
+        CloseSocket(entry.socket);
+        return true;
+    }), idle.end());
+
+    // Most recently used first - the least likely to have been dropped by the server
+    for (auto it = idle.rbegin(); it != idle.rend(); ++it) {
+        if (it->port == port && it->host == host) {
+            SocketHandle s = it->socket;
+            idle.erase(std::next(it).base());
+            connectionsReused++;
+            return s;
+        }
+    }
+    return BAD_SOCKET;
+}
+
+void SocketTransport::Recycle(const std::string& host, uint16_t port, SocketHandle socket) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (shuttingDown || !g_config.keep_alive) {
+        CloseSocket(socket);
+        return;
+    }
+    idle.push_back({ host, port, socket, std::chrono::steady_clock::now() });
+}
+
+std::unique_ptr<HttpResponse> SocketTransport::Send(const HttpRequest& request, std::wstring& error) {
+    if (request.secure) {
+        error = L"The socket transport only supports http://, use transport=wininet for https";
+        return nullptr;
+    }
+    if (!EnsureStarted(error)) {
+        return nullptr;
+    }
+
+    std::string head = FormatRequestHead(request, g_config.keep_alive);
+
+    // A pooled connection may have been closed by the server; retry once on a fresh one
+    for (int tries = 0; tries < 2; ++tries) {
+        SocketHandle s = g_config.keep_alive ? TakeIdle(request.host, request.port) : BAD_SOCKET;
+        bool reused = (s != BAD_SOCKET);
+        if (!reused) {
+            s = Connect(request.host, request.port, request.timings, error);
+            if (s == BAD_SOCKET) {
+                return nullptr;
+            }
+        }
+
+        // The response owns the socket from here, so cancellation covers the send too
+        auto response = std::make_unique<SocketResponse>(this, request.host, request.port, s, reused, request.cancel,
+            request.timings);
+        if (SendAll(s, head.data(), head.size()) && SendAll(s, request.body, request.bodySize)) {
+            MarkPhase(request.timings, &HttpTimings::requestSent);
+            if (response->ReadHead(error)) {
+                return response;
+            }
+        } else {
+            error = L"Failed to send request (socket error " + std::to_wstring(LastSocketError()) + L")";
+        }
+
+        if (response->WasAborted()) {
+            error = L"Request cancelled";
+            return nullptr;
+        }
+        if (!reused) {
+            return nullptr;
+        }
+        LOG_DEBUG(L"Pooled connection went stale, reconnecting");
+    }
+
+    return nullptr;
+}
+
+void SocketTransport::Shutdown() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    shuttingDown = true;
+    if (started) {
+        LOG_INFO(L"Socket transport: " + std::to_wstring(connectionsCreated) + L" connections created, " +
+            std::to_wstring(connectionsReused) + L" reused");
+    }
+}
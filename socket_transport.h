@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_SOCKET_TRANSPORT_H
+#define TTS_STELLARIS_SOCKET_TRANSPORT_H
+
+#include "http_transport.h"
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+#ifdef _WIN32
+using SocketHandle = uintptr_t;   // SOCKET
+#else
+using SocketHandle = int;
+#endif
+
+// Portable HTTP/1.1 backend on plain BSD sockets (Winsock on Windows)
+// Builds without WinINet, so the fetch path can run off Windows and against
+// local servers. Keeps its own keep-alive pool and understands
+// Content-Length, chunked and close-delimited bodies.
+// Plain http only - https servers need the wininet transport.
+class SocketTransport : public HttpTransport {
+private:
+    struct IdleSocket {
+        std::string host;
+        uint16_t port;
+        SocketHandle socket;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    std::vector<IdleSocket> idle;
+    std::mutex poolMutex;
+    bool started = false;
+    bool shuttingDown = false;
+    uint64_t connectionsCreated = 0;
+    uint64_t connectionsReused = 0;
+
+    // The event loop shares the keep-alive pool and the counters
+    friend class SocketEventLoop;
+
+    SocketHandle Connect(const std::string& host, uint16_t port, HttpTimings* timings, std::wstring& error);
+    SocketHandle TakeIdle(const std::string& host, uint16_t port);
+
+public:
+    SocketTransport() = default;
+    ~SocketTransport() override;
+
+    const wchar_t* Name() const override { return L"socket"; }
+    std::unique_ptr<HttpResponse> Send(const HttpRequest& request, std::wstring& error) override;
+    void Shutdown() override;
+
+    // Load Winsock; needed before any getaddrinfo call
+    bool EnsureStarted(std::wstring& error);
+
+    // Hand a connection back after a fully read response
+    void Recycle(const std::string& host, uint16_t port, SocketHandle socket);
+};
+
+// Global socket transport instance
+extern SocketTransport g_socketTransport;
+
+#endif // TTS_STELLARIS_SOCKET_TRANSPORT_H
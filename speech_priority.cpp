@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "speech_priority.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <vector>
+#include <algorithm>
+#include <cwctype>
+
+namespace {
+
+// priority_ruleN=<class> <phrase>
+struct PriorityRule {
+    SpeechPriority priority;
+    std::wstring phrase;   // Lowercase
+};
+
+std::vector<PriorityRule> g_priorityRules;
+
+// Sequence numbers stay far below 2^56, so the class fits above them
+constexpr int PRIORITY_CLASS_SHIFT = 56;
+
+std::wstring Lowercase(std::wstring text) {
+    for (wchar_t& c : text) {
+        c = static_cast<wchar_t>(towlower(c));
+    }
+    return text;
+}
+
+bool ParsePriorityName(const std::string& name, SpeechPriority& priority) {
+    if (name == "low") priority = SpeechPriority::Low;
+    else if (name == "normal") priority = SpeechPriority::Normal;
+    else if (name == "high") priority = SpeechPriority::High;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+void ConfigureSpeechPriority() {
+    g_priorityRules.clear();
+    if (!g_config.priority_classes) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_PRIORITY_RULES; ++i) {
+        std::string rule = trim(g_config.priority_rules[i]);
+        if (rule.empty()) {
+            continue;
+        }
+
+        size_t space = rule.find_first_of(" \t");
+        PriorityRule parsed;
+        std::string name = rule.substr(0, space);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        std::wstring phrase = space == std::string::npos ? std::wstring() : Lowercase(UTF8ToWide(trim(rule.substr(space))));
+        if (!ParsePriorityName(name, parsed.priority) || phrase.empty()) {
+            LOG_WARNING(L"Ignoring priority_rule" + std::to_wstring(i + 1) + L", expected <low|normal|high> <phrase>");
+            continue;
+        }
+        parsed.phrase = std::move(phrase);
+
+        LOG_INFO(L"Priority rule: lines containing \"" + parsed.phrase + L"\" are " + SpeechPriorityName(parsed.priority));
+        g_priorityRules.push_back(std::move(parsed));
+    }
+}
+
+SpeechPriority ClassifySpeech(const std::wstring& text) {
+    if (!g_config.priority_classes) {
+        return SpeechPriority::Normal;
+    }
+
+    if (!g_priorityRules.empty()) {
+        std::wstring lower = Lowercase(text);
+        for (const PriorityRule& rule : g_priorityRules) {
+            if (lower.find(rule.phrase) != std::wstring::npos) {
+                return rule.priority;
+            }
+        }
+    }
+
+    if (text.size() <= static_cast<size_t>(g_config.priority_low_max_chars)) {
+        return SpeechPriority::Low;
+    }
+    if (text.size() >= static_cast<size_t>(g_config.priority_high_min_chars)) {
+        return SpeechPriority::High;
+    }
+    return SpeechPriority::Normal;
+}
+
+uint64_t FetchPriorityFor(SpeechPriority priority, uint64_t sequenceNumber) {
+    uint64_t rank = static_cast<uint64_t>(SpeechPriority::High) - static_cast<uint64_t>(priority);
+    return (rank << PRIORITY_CLASS_SHIFT) | sequenceNumber;
+}
+
+const wchar_t* SpeechPriorityName(SpeechPriority priority) {
+    switch (priority) {
+    case SpeechPriority::Low: return L"low";
+    case SpeechPriority::High: return L"high";
+    default: return L"normal";
+    }
+}
@@ -0,0 +1,55 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_SPEECH_PRIORITY_H
+#define TTS_STELLARIS_SPEECH_PRIORITY_H
+
+#include <string>
+#include <cstdint>
+
+// Priority classes of spoken lines (priority_classes). A higher class plays
+// ahead of queued lines of lower classes and is fetched before them; with
+// priority_interrupt it also cuts off a lower-class line that is playing.
+enum class SpeechPriority {
+    Low,      // Tooltips and other short texts
+    Normal,
+    High      // Event and anomaly narration
+};
+
+// SAPI's SPF_PURGEBEFORESPEAK, without pulling sapi.h into the core
+constexpr uint32_t SPEAK_PURGE_BEFORE_SPEAK = 2;
+
+// Read priority_rule1 .. priority_rule8; call once before the first ClassifySpeech
+void ConfigureSpeechPriority();
+
+// Class of a line handed to Speak: the first priority rule whose phrase the
+// text contains, otherwise by length - up to priority_low_max_chars is Low,
+// priority_high_min_chars and more is High. Always Normal with priority_classes=0.
+SpeechPriority ClassifySpeech(const std::wstring& text);
+
+// Fetch pool and backend pool priority of a line's piece: every piece of a
+// higher class before any of a lower one, then in playback order
+uint64_t FetchPriorityFor(SpeechPriority priority, uint64_t sequenceNumber);
+
+const wchar_t* SpeechPriorityName(SpeechPriority priority);
+
+#endif // TTS_STELLARIS_SPEECH_PRIORITY_H
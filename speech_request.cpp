@@ -0,0 +1,64 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "speech_request.h"
+#include "config.h"
+#include "audio_decoder.h"
+#include "utils.h"
+
+SpeechRequestBuilder::SpeechRequestBuilder() {
+    body.reserve(16 * 1024);
+}
+
+void SpeechRequestBuilder::RefreshPrefix(const std::string& requestModel, const std::string& requestVoice) {
+    if (prefix.size() > 0 && model == requestModel && voice == requestVoice &&
+        format == RequestFormat() && streamFormat == g_config.stream_format) {
+        return;
+    }
+
+    model = requestModel;
+    voice = requestVoice;
+    format = RequestFormat();
+    streamFormat = g_config.stream_format;
+
+    prefix = "{\"model\":\"";
+    AppendEscapedJSON(prefix, model.data(), model.size());
+    prefix += "\",\"voice\":\"";
+    AppendEscapedJSON(prefix, voice.data(), voice.size());
+    prefix += "\",\"response_format\":\"";
+    AppendEscapedJSON(prefix, format.data(), format.size());
+    prefix += "\"";
+    if (streamFormat == "sse") {
+        prefix += ",\"stream_format\":\"sse\"";
+    }
+    prefix += ",\"input\":\"";
+}
+
+const std::string& SpeechRequestBuilder::Build(const std::string& requestModel, const std::string& requestVoice,
+    const std::string& text) {
+    RefreshPrefix(requestModel, requestVoice);
+
+    body.assign(prefix);
+    AppendEscapedJSON(body, text.data(), text.size());
+    body += "\"}";
+    return body;
+}
@@ -0,0 +1,53 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_SPEECH_REQUEST_H
+#define TTS_STELLARIS_SPEECH_REQUEST_H
+
+#include <string>
+
+// Builds the JSON body for /audio/speech without per-request allocations
+// Everything except the input text changes rarely, so that part is escaped
+// once and cached (per model and voice); "input" goes last so each request is just
+// prefix + escaped text + suffix written into a buffer that keeps its capacity.
+// Not thread-safe - use one instance per fetch worker.
+class SpeechRequestBuilder {
+private:
+    std::string body;
+    std::string prefix;
+
+    // Values the cached prefix was built from
+    std::string model;
+    std::string voice;
+    std::string format;
+    std::string streamFormat;
+
+    void RefreshPrefix(const std::string& requestModel, const std::string& requestVoice);
+
+public:
+    SpeechRequestBuilder();
+
+    // Returned reference stays valid until the next Build call
+    const std::string& Build(const std::string& requestModel, const std::string& requestVoice, const std::string& text);
+};
+
+#endif // TTS_STELLARIS_SPEECH_REQUEST_H
@@ -0,0 +1,180 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "sse_audio_parser.h"
+#include "logger.h"
+
+#include <cstring>
+
+SseAudioParser::SseAudioParser(AudioSink sink)
+    : sink(std::move(sink)), done(false), error(false), deltas(0) {
+}
+
+bool SseAudioParser::Feed(const char* data, size_t size) {
+    const char* end = data + size;
+
+    while (data < end) {
+        const char* newline = static_cast<const char*>(memchr(data, '\n', end - data));
+        if (!newline) {
+            line.append(data, end);
+            break;
+        }
+
+        line.append(data, newline);
+        data = newline + 1;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!HandleLine()) {
+            return false;
+        }
+        line.clear();
+    }
+
+    return true;
+}
+
+bool SseAudioParser::HandleLine() {
+    // Blank line terminates the event
+    if (line.empty()) {
+        return DispatchEvent();
+    }
+
+    // Comments (": keep-alive") and event:/id:/retry: fields carry nothing we need
+    if (line.compare(0, 5, "data:") != 0) {
+        return true;
+    }
+
+    size_t valueStart = (line.size() > 5 && line[5] == ' ') ? 6 : 5;
+    if (!eventData.empty()) {
+        eventData += '\n';
+    }
+    eventData.append(line, valueStart, std::string::npos);
+    return true;
+}
+
+// Find "key":"value" in a flat JSON object without a full parser
+// Good enough for the server's own event objects; the value is returned raw (still escaped)
+static bool FindJsonString(const std::string& json, const char* key, size_t& valueStart, size_t& valueEnd) {
+    std::string needle = std::string("\"") + key + "\"";
+    size_t pos = json.find(needle);
+    if (pos == std::string::npos) return false;
+
+    pos = json.find(':', pos + needle.size());
+    if (pos == std::string::npos) return false;
+    pos = json.find('"', pos + 1);
+    if (pos == std::string::npos) return false;
+
+    size_t end = pos + 1;
+    while (end < json.size() && json[end] != '"') {
+        end += (json[end] == '\\') ? 2 : 1;
+    }
+    if (end >= json.size()) return false;
+
+    valueStart = pos + 1;
+    valueEnd = end;
+    return true;
+}
+
+bool SseAudioParser::DispatchEvent() {
+    if (eventData.empty()) {
+        return true;
+    }
+
+    // OpenAI-style terminator some servers send in addition to speech.audio.done
+    if (eventData == "[DONE]") {
+        done = true;
+        eventData.clear();
+        return true;
+    }
+
+    size_t typeStart, typeEnd;
+    if (!FindJsonString(eventData, "type", typeStart, typeEnd)) {
+        LOG_DEBUG(L"Ignoring SSE event without a type");
+        eventData.clear();
+        return true;
+    }
+
+    std::string type = eventData.substr(typeStart, typeEnd - typeStart);
+    bool keepGoing = true;
+
+    if (type == "speech.audio.delta") {
+        size_t audioStart, audioEnd;
+        if (FindJsonString(eventData, "audio", audioStart, audioEnd)) {
+            if (!Base64Decode(eventData.data() + audioStart, audioEnd - audioStart, decoded)) {
+                LOG_WARNING(L"Dropping SSE audio delta with invalid base64");
+            }
+            else if (!decoded.empty()) {
+                deltas++;
+                keepGoing = sink(reinterpret_cast<const uint8_t*>(decoded.data()), decoded.size());
+            }
+        }
+    }
+    else if (type == "speech.audio.done") {
+        done = true;
+    }
+    else if (type == "error") {
+        error = true;
+        keepGoing = false;
+        LOG_ERROR(L"Server sent error event: " + std::wstring(eventData.begin(), eventData.end()));
+    }
+
+    eventData.clear();
+    return keepGoing;
+}
+
+bool Base64Decode(const char* data, size_t size, std::string& out) {
+    static const auto table = [] {
+        struct Table { int8_t v[256]; } t;
+        memset(t.v, -1, sizeof(t.v));
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i) {
+            t.v[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+        }
+        return t;
+    }();
+
+    out.clear();
+    out.reserve(size / 4 * 3);
+
+    uint32_t accum = 0;
+    int bits = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t c = static_cast<uint8_t>(data[i]);
+        if (c == '=') break;
+        if (c == '\\' || c == ' ' || c == '\r' || c == '\n' || c == '\t') continue;
+
+        int8_t v = table.v[c];
+        if (v < 0) return false;
+
+        accum = (accum << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<char>((accum >> bits) & 0xFF));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,64 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_SSE_AUDIO_PARSER_H
+#define TTS_STELLARIS_SSE_AUDIO_PARSER_H
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+// Incremental parser for the speech endpoint's server-sent events stream
+// (stream_format=sse). Each "speech.audio.delta" event carries a base64
+// block of audio; it is decoded and handed to the sink as soon as the
+// event's blank-line terminator arrives, so only the current event is buffered.
+class SseAudioParser {
+public:
+    using AudioSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+    explicit SseAudioParser(AudioSink sink);
+
+    // Feed raw response bytes in any split; returns false if the sink aborted
+    // or the server sent an error event
+    bool Feed(const char* data, size_t size);
+
+    bool IsDone() const { return done; }          // "speech.audio.done" received
+    bool HasError() const { return error; }
+    size_t DeltaCount() const { return deltas; }
+
+private:
+    AudioSink sink;
+    std::string line;        // Current, not yet terminated line
+    std::string eventData;   // Joined "data:" lines of the current event
+    std::string decoded;     // Reused base64 output buffer
+    bool done;
+    bool error;
+    size_t deltas;
+
+    bool HandleLine();
+    bool DispatchEvent();
+};
+
+// Decode standard base64, skipping whitespace and JSON-escaped slashes
+bool Base64Decode(const char* data, size_t size, std::string& out);
+
+#endif // TTS_STELLARIS_SSE_AUDIO_PARSER_H
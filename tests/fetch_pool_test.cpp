@@ -0,0 +1,366 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Fetch pool scheduling
+// When the queue is full, a High line's fetch displaces a queued Low one, whose
+// failure path runs so the playback queue doesn't wait for it; nothing
+// displaces a more urgent task. A line's pieces are admitted and displaced
+// together, so it is never cut short. Delayed tasks that fall due together run on
+// as many workers as are idle, not one after another. The speech budget
+// admits exactly what it has room for however many workers charge it at once.
+// The adaptive concurrency limit grows only while it is used, is cut on
+// inflated latency and on overload, and is cut once per congestion event.
+
+#include "../fetch_thread_pool.h"
+#include "../speech_priority.h"
+#include "../logger.h"
+#include "../config.h"
+#include "../rate_limiter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+// stdout carries the log in wide mode, so results go to stderr
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static void CheckDisplacement() {
+    // One worker, so the queue only drains when the test lets it
+    FetchThreadPool pool(1, 2);
+    std::atomic<bool> blocking{ false };
+    std::atomic<bool> release{ false };
+    CHECK(pool.Enqueue([&]() {
+        blocking = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }, FETCH_PRIORITY_URGENT));
+    while (!blocking) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::mutex ranMutex;
+    std::vector<const char*> ran;
+    std::vector<const char*> dropped;
+    auto fetch = [&](const char* name) {
+        return [&, name]() {
+            std::lock_guard<std::mutex> lock(ranMutex);
+            ran.push_back(name);
+        };
+    };
+    auto drop = [&](const char* name) {
+        return [&, name]() { dropped.push_back(name); };
+    };
+
+    CHECK(pool.Enqueue(fetch("low"), FetchPriorityFor(SpeechPriority::Low, 1), drop("low")));
+    CHECK(pool.Enqueue(fetch("normal"), FetchPriorityFor(SpeechPriority::Normal, 2), drop("normal")));
+    CHECK(pool.GetQueueSize() == 2);
+
+    // Full: the High line takes the Low line's place
+    CHECK(pool.Enqueue(fetch("high"), FetchPriorityFor(SpeechPriority::High, 3), drop("high")));
+    CHECK(dropped.size() == 1 && dropped[0] == std::string("low"));
+    CHECK(pool.GetQueueSize() == 2);
+
+    // Nothing queued is less urgent than another Low line, so it is turned away
+    CHECK(!pool.Enqueue(fetch("low2"), FetchPriorityFor(SpeechPriority::Low, 4), drop("low2")));
+    CHECK(dropped.size() == 1);
+
+    // Tasks without onDropped stay put even for a High line
+    FetchThreadPool strictPool(1, 1);
+    std::atomic<bool> strictBlocking{ false };
+    std::atomic<bool> strictRelease{ false };
+    CHECK(strictPool.Enqueue([&]() {
+        strictBlocking = true;
+        while (!strictRelease) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }, FETCH_PRIORITY_URGENT));
+    while (!strictBlocking) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(strictPool.Enqueue(fetch("background"), FETCH_PRIORITY_BACKGROUND));
+    CHECK(!strictPool.Enqueue(fetch("high2"), FetchPriorityFor(SpeechPriority::High, 5), drop("high2")));
+
+    release = true;
+    pool.Shutdown();
+    strictRelease = true;
+    strictPool.Shutdown();
+
+    CHECK(ran.size() == 3);
+    if (ran.size() == 3) {
+        CHECK(ran[0] == std::string("high"));
+        CHECK(ran[1] == std::string("normal"));
+        CHECK(ran[2] == std::string("background"));
+    }
+}
+
+// Holds the pool's only worker until released
+struct Blocker {
+    std::atomic<bool> running{ false };
+    std::atomic<bool> release{ false };
+
+    void Occupy(FetchThreadPool& pool) {
+        CHECK(pool.Enqueue([this]() {
+            running = true;
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }, FETCH_PRIORITY_URGENT));
+        while (!running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+static std::vector<FetchThreadPool::GroupTask> Pieces(SpeechPriority priority, uint64_t firstSeq, size_t count,
+    std::atomic<int>& ran) {
+    std::vector<FetchThreadPool::GroupTask> pieces;
+    for (size_t i = 0; i < count; ++i) {
+        pieces.push_back({ [&ran]() { ran++; }, FetchPriorityFor(priority, firstSeq + i) });
+    }
+    return pieces;
+}
+
+static void CheckLineGroups() {
+    FetchThreadPool pool(1, 4);
+    Blocker blocker;
+    blocker.Occupy(pool);
+
+    std::atomic<int> ran{ 0 };
+    std::atomic<int> lowDropped{ 0 };
+    std::atomic<int> highDropped{ 0 };
+
+    // Three Low pieces fit; a High line of two needs room, so the whole Low line goes
+    CHECK(pool.EnqueueGroup(Pieces(SpeechPriority::Low, 1, 3, ran), [&]() { lowDropped++; }));
+    CHECK(pool.GetQueueSize() == 3);
+    CHECK(pool.EnqueueGroup(Pieces(SpeechPriority::High, 4, 2, ran), [&]() { highDropped++; }));
+    CHECK(lowDropped == 1);
+    CHECK(pool.GetQueueSize() == 2);
+
+    // A Normal line of three can't all fit without the more urgent High line's
+    // place, so none of it is queued rather than only its start
+    CHECK(!pool.EnqueueGroup(Pieces(SpeechPriority::Normal, 6, 3, ran), [&]() {}));
+    CHECK(pool.GetQueueSize() == 2);
+    CHECK(highDropped == 0);
+
+    // More pieces than the whole queue holds wait for it to be empty
+    CHECK(!pool.EnqueueGroup(Pieces(SpeechPriority::High, 9, 6, ran), [&]() {}));
+
+    blocker.release = true;
+    pool.Shutdown();
+    CHECK(ran == 2);
+
+    // Once a line's first piece has started, its queued pieces stay
+    FetchThreadPool startedPool(1, 2);
+    Blocker firstPiece;
+    std::atomic<int> startedDropped{ 0 };
+    std::vector<FetchThreadPool::GroupTask> line;
+    line.push_back({ [&firstPiece]() {
+        firstPiece.running = true;
+        while (!firstPiece.release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }, FetchPriorityFor(SpeechPriority::Low, 20) });
+    line.push_back({ [&ran]() { ran++; }, FetchPriorityFor(SpeechPriority::Low, 21) });
+    line.push_back({ [&ran]() { ran++; }, FetchPriorityFor(SpeechPriority::Low, 22) });
+    CHECK(startedPool.EnqueueGroup(std::move(line), [&]() { startedDropped++; }));
+    while (!firstPiece.running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(!startedPool.Enqueue([]() {}, FetchPriorityFor(SpeechPriority::High, 23), []() {}));
+    CHECK(startedDropped == 0);
+
+    firstPiece.release = true;
+    startedPool.Shutdown();
+    CHECK(ran == 4);
+}
+
+static void CheckDelayedTasksOverlap() {
+    const int TASKS = 4;
+    FetchThreadPool pool(TASKS, 8);
+
+    // Start the workers and let them all go idle
+    std::atomic<int> started{ 0 };
+    for (int i = 0; i < TASKS; ++i) {
+        CHECK(pool.Enqueue([&]() { started++; }, FETCH_PRIORITY_URGENT));
+    }
+    while (started < TASKS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // Queued a few milliseconds apart, so idle workers are already waiting on the
+    // first due time when the others arrive, but all due at the same moment
+    auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    std::atomic<int> running{ 0 };
+    std::atomic<int> mostRunning{ 0 };
+    std::atomic<int> finished{ 0 };
+    for (int i = 0; i < TASKS; ++i) {
+        auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+        CHECK(pool.EnqueueDelayed([&]() {
+            int now = ++running;
+            int most = mostRunning.load();
+            while (now > most && !mostRunning.compare_exchange_weak(most, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            running--;
+            finished++;
+        }, delay, FETCH_PRIORITY_URGENT));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    while (finished < TASKS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(mostRunning == TASKS);
+    pool.Shutdown();
+}
+
+static uint64_t SavedUsage(const char* path) {
+    std::ifstream file(path);
+    int day = 0;
+    uint64_t chars = 0;
+    return (file >> day >> chars) ? chars : UINT64_MAX;
+}
+
+static void CheckSpendGovernor() {
+    const char* path = "fetch_pool_test_usage.txt";
+    std::remove(path);
+    g_config.budget_session_chars = 100;
+    g_config.budget_daily_chars = 1000;
+    SpendGovernor governor;
+    governor.Load(path);
+
+    // Eight workers race for a budget with room for ten 10-character requests
+    std::atomic<int> charged{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < 10; ++i) {
+                if (governor.TryCharge(10)) {
+                    charged++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    CHECK(charged == 10);
+    CHECK(governor.Exhausted());
+
+    // Charges and refunds stay in memory until saved
+    CHECK(SavedUsage(path) == UINT64_MAX);
+    governor.Save();
+    CHECK(SavedUsage(path) == 100);
+    governor.Refund(30);
+    CHECK(!governor.Exhausted());
+    CHECK(SavedUsage(path) == 100);
+    governor.Save();
+    CHECK(SavedUsage(path) == 70);
+
+    std::remove(path);
+    g_config.budget_session_chars = 0;
+    g_config.budget_daily_chars = 0;
+}
+
+static void CheckConcurrencyLimiter() {
+    using std::chrono::milliseconds;
+    ConcurrencyLimiter limiter;
+
+    // Not adaptive until configured
+    limiter.OnOverload(milliseconds(0));
+    CHECK(!limiter.Enabled());
+
+    limiter.Configure(4, 8, 200);
+    CHECK(limiter.Enabled() && limiter.Limit() == 4);
+
+    // Fast answers with the limit mostly unused prove nothing
+    for (int i = 0; i < 20; ++i) {
+        limiter.OnResponse(milliseconds(15), 100, 1);
+    }
+    CHECK(limiter.Limit() == 4);
+    CHECK(limiter.Decreases() == 0);
+
+    // Under load it grows by about one request per limit's worth of answers
+    for (int i = 0; i < 5; ++i) {
+        limiter.OnResponse(milliseconds(15), 100, 4);
+    }
+    CHECK(limiter.Limit() == 5);
+    for (int i = 0; i < 200; ++i) {
+        limiter.OnResponse(milliseconds(15), 100, 8);
+    }
+    CHECK(limiter.Limit() == 8);
+    CHECK(limiter.Peak() == 8);
+
+    // Latency well past the baseline per character cuts it by a tenth
+    limiter.OnResponse(milliseconds(1000), 100, 8);
+    CHECK(limiter.Limit() == 7);
+    CHECK(limiter.Decreases() == 1);
+
+    // Answers to requests sent before that cut belong to the same congestion
+    limiter.OnResponse(milliseconds(1000), 100, 7);
+    limiter.OnOverload(milliseconds(1000));
+    CHECK(limiter.Limit() == 7);
+    CHECK(limiter.Decreases() == 1);
+
+    // An overload answer to a request sent since then halves it
+    limiter.OnOverload(milliseconds(0));
+    CHECK(limiter.Limit() == 3);
+    CHECK(limiter.Decreases() == 2);
+
+    // Never below one request
+    for (int i = 0; i < 5; ++i) {
+        limiter.OnOverload(milliseconds(0));
+    }
+    CHECK(limiter.Limit() == 1);
+    CHECK(limiter.Peak() == 8);
+}
+
+int main() {
+    g_logger.SetLogLevel(L"error");
+    g_config.SetDefaults();
+
+    CheckDisplacement();
+    CheckLineGroups();
+    CheckDelayedTasksOverlap();
+    CheckSpendGovernor();
+    CheckConcurrencyLimiter();
+
+    if (failures == 0) {
+        std::fprintf(stderr, "fetch_pool_test passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_LOOPBACK_SERVER_H
+#define TTS_STELLARIS_LOOPBACK_SERVER_H
+
+// Speech server on 127.0.0.1 for the tests and tools/fetch_bench
+// Runs in the same process on an ephemeral port. Every request is answered
+// from a handler, with Content-Length or chunked framing and optional delays,
+// over keep-alive connections unless the client asks to close.
+
+#include "../socket_platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+struct LoopbackReply {
+    int status = 200;
+    std::string contentType = "audio/wav";
+    std::string body;
+    bool chunked = false;          // Transfer-Encoding: chunked, chunkSize bytes per chunk
+    size_t chunkSize = 16 * 1024;
+    int firstByteDelayMs = 0;      // Before the status line
+    int chunkDelayMs = 0;          // Between chunks
+};
+
+// Receives the request body (the speech JSON)
+using LoopbackHandler = std::function<LoopbackReply(const std::string& requestBody)>;
+
+// "data:" events carrying audio as speech.audio.delta blocks of chunkBytes, then speech.audio.done
+inline std::string EncodeSseAudio(const std::string& audio, size_t chunkBytes) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string events;
+    for (size_t start = 0; start < audio.size(); start += chunkBytes) {
+        size_t end = std::min(audio.size(), start + chunkBytes);
+        events += "data: {\"type\":\"speech.audio.delta\",\"audio\":\"";
+        for (size_t i = start; i < end; i += 3) {
+            uint32_t block = uint32_t(uint8_t(audio[i])) << 16;
+            if (i + 1 < end) block |= uint32_t(uint8_t(audio[i + 1])) << 8;
+            if (i + 2 < end) block |= uint8_t(audio[i + 2]);
+            events += ALPHABET[(block >> 18) & 63];
+            events += ALPHABET[(block >> 12) & 63];
+            events += i + 1 < end ? ALPHABET[(block >> 6) & 63] : '=';
+            events += i + 2 < end ? ALPHABET[block & 63] : '=';
+        }
+        events += "\"}\n\n";
+    }
+    events += "data: {\"type\":\"speech.audio.done\"}\n\n";
+    return events;
+}
+
+class LoopbackServer {
+private:
+    LoopbackHandler handler;
+    SocketHandle listener = BAD_SOCKET;
+    uint16_t port = 0;
+    std::thread acceptThread;
+    std::mutex connectionsMutex;
+    std::vector<SocketHandle> sockets;
+    std::vector<std::thread> connections;
+    std::atomic<int> requests{ 0 };
+
+    static bool SendAll(SocketHandle s, const char* data, size_t size) {
+        while (size > 0) {
+            int sent = send(s, data, static_cast<int>(std::min<size_t>(size, 1 << 20)), SEND_FLAGS);
+            if (sent <= 0) return false;
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    // One request off the connection; keepAlive is false if the client asked to close
+    static bool ReadRequest(SocketHandle s, std::string& buffer, std::string& body, bool& keepAlive) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            char chunk[4096];
+            int n = recv(s, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer.append(chunk, n);
+        }
+
+        std::string head = buffer.substr(0, headerEnd);
+        std::transform(head.begin(), head.end(), head.begin(),
+            [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        keepAlive = head.find("connection: close") == std::string::npos;
+        size_t length = 0;
+        size_t field = head.find("content-length:");
+        if (field != std::string::npos) {
+            length = std::strtoul(head.c_str() + field + 15, nullptr, 10);
+        }
+
+        while (buffer.size() < headerEnd + 4 + length) {
+            char chunk[4096];
+            int n = recv(s, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer.append(chunk, n);
+        }
+        body = buffer.substr(headerEnd + 4, length);
+        buffer.erase(0, headerEnd + 4 + length);
+        return true;
+    }
+
+    static bool SendReply(SocketHandle s, const LoopbackReply& reply, bool keepAlive) {
+        if (reply.firstByteDelayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(reply.firstByteDelayMs));
+        }
+
+        std::string head = "HTTP/1.1 " + std::to_string(reply.status) + (reply.status == 200 ? " OK" : " Error") +
+            "\r\nContent-Type: " + reply.contentType + "\r\n" +
+            (reply.chunked ? std::string("Transfer-Encoding: chunked\r\n")
+                           : "Content-Length: " + std::to_string(reply.body.size()) + "\r\n") +
+            "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+        if (!reply.chunked) {
+            return SendAll(s, head.data(), head.size()) && SendAll(s, reply.body.data(), reply.body.size());
+        }
+
+        if (!SendAll(s, head.data(), head.size())) return false;
+        for (size_t start = 0; start < reply.body.size(); start += reply.chunkSize) {
+            if (start > 0 && reply.chunkDelayMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(reply.chunkDelayMs));
+            }
+            size_t count = std::min(reply.chunkSize, reply.body.size() - start);
+            char size[32];
+            snprintf(size, sizeof(size), "%zx\r\n", count);
+            if (!SendAll(s, size, strlen(size)) || !SendAll(s, reply.body.data() + start, count) ||
+                !SendAll(s, "\r\n", 2)) {
+                return false;
+            }
+        }
+        return SendAll(s, "0\r\n\r\n", 5);
+    }
+
+    void Serve(SocketHandle s) {
+        std::string buffer;
+        std::string body;
+        bool keepAlive = true;
+        while (keepAlive && ReadRequest(s, buffer, body, keepAlive)) {
+            requests++;
+            if (!SendReply(s, handler(body), keepAlive)) {
+                break;
+            }
+        }
+        ShutdownSocket(s);
+    }
+
+public:
+    explicit LoopbackServer(LoopbackHandler replyWith) : handler(std::move(replyWith)) {}
+    ~LoopbackServer() { Stop(); }
+
+    bool Start() {
+        listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == BAD_SOCKET) return false;
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addrLen = sizeof(addr);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listener, SOMAXCONN) != 0 ||
+            getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0) {
+            return false;
+        }
+        port = ntohs(addr.sin_port);
+
+        acceptThread = std::thread([this]() {
+            while (true) {
+                SocketHandle s = accept(listener, nullptr, nullptr);
+                if (s == BAD_SOCKET) break;
+                int noDelay = 1;
+                setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+                std::lock_guard<std::mutex> lock(connectionsMutex);
+                sockets.push_back(s);
+                connections.emplace_back([this, s]() { Serve(s); });
+            }
+        });
+        return true;
+    }
+
+    void Stop() {
+        if (listener == BAD_SOCKET) {
+            return;
+        }
+        ShutdownSocket(listener);
+        CloseSocket(listener);
+        listener = BAD_SOCKET;
+        acceptThread.join();
+
+        // The client keeps idle connections open until the process exits
+        for (SocketHandle s : sockets) {
+            ShutdownSocket(s);
+        }
+        for (auto& t : connections) {
+            t.join();
+        }
+        for (SocketHandle s : sockets) {
+            CloseSocket(s);
+        }
+    }
+
+    // Close every connection, as a server does with idle keep-alive ones
+    void DropConnections() {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (SocketHandle s : sockets) {
+            ShutdownSocket(s);
+        }
+    }
+
+    uint16_t Port() const { return port; }
+    std::string Url() const { return "http://127.0.0.1:" + std::to_string(port) + "/v1"; }
+    int Requests() const { return requests.load(); }
+
+    int Connections() {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        return static_cast<int>(sockets.size());
+    }
+};
+
+#endif // TTS_STELLARIS_LOOPBACK_SERVER_H
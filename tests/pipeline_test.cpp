@@ -0,0 +1,353 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Fetch -> cache -> playback queue, against a speech server on loopback
+// Lines go through the fetch pool the way ProcessTTSRequest sends them: a
+// cache hit is queued straight away, a miss is fetched over the socket
+// transport, cached and queued. The queue must hand them out in order, and
+// a repeated line must not reach the server. Long lines are split the way
+// ProcessTTSRequest splits them, and the disk cache has to follow each
+// disk_admission policy. An interrupt must stop a line handed out for
+// playback before its player has started.
+
+#include "loopback_server.h"
+#include "../config.h"
+#include "../backend_pool.h"
+#include "../tts_fetcher.h"
+#include "../audio_cache.h"
+#include "../playback_queue.h"
+#include "../fetch_thread_pool.h"
+#include "../text_splitter.h"
+#include "../http_transport.h"
+#include "../utils.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <thread>
+
+// The player lives in the Windows-only part of the proxy
+std::atomic<bool> g_isPlaying{ false };
+std::atomic<bool> g_shouldCancel{ false };
+
+// stdout carries the log in wide mode, so results go to stderr
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+// ============================================================
+// PIPELINE
+// ============================================================
+
+// What a fetch worker does with one line, less retries and hedging
+static void FetchLine(const std::string& text, uint64_t seq) {
+    BackendPool::Lease lease = g_backendPool.Acquire(nullptr, text.size(), seq, std::chrono::seconds(5));
+    if (!lease) {
+        g_playbackQueue.MarkFailed(seq);
+        return;
+    }
+    const Backend* backend = lease.Get();
+
+    std::vector<uint8_t> audio;
+    if (g_audioCache.Get(text, backend->cacheGroup, backend->voice, audio)) {
+        lease.RefundCharge();
+        lease.RecordCancelled();
+        g_playbackQueue.MarkReady(seq, std::move(audio), nullptr);
+        return;
+    }
+
+    FetchResult result = FetchTTSAudioOnce(*backend, text);
+    if (result.outcome != FetchOutcome::Success) {
+        lease.RecordFailure();
+        g_playbackQueue.MarkFailed(seq);
+        return;
+    }
+    lease.RecordSuccess(result.responseTime);
+    g_audioCache.Put(text, backend->cacheGroup, backend->voice, result.audio);
+    g_playbackQueue.MarkReady(seq, std::move(result.audio), nullptr);
+}
+
+static std::string AsString(const std::vector<uint8_t>& data) {
+    return std::string(data.begin(), data.end());
+}
+
+// ============================================================
+// TEXT SPLITTER
+// ============================================================
+
+static bool SplitsInto(const std::wstring& text, size_t firstMaxChars, size_t maxChars,
+    const std::vector<std::wstring>& expected) {
+    std::vector<std::wstring> pieces = SplitTextForSynthesis(text, firstMaxChars, maxChars);
+    if (pieces != expected) {
+        for (const std::wstring& piece : pieces) {
+            std::fprintf(stderr, "  piece: %s\n", WideToUTF8(piece).c_str());
+        }
+        return false;
+    }
+    return true;
+}
+
+static void CheckTextSplitter() {
+    // Chinese and Japanese end sentences on full-width marks without a space
+    CHECK(SplitsInto(L"我们的科学家发现了一个异常。它正在发出信号！这可能是人造的吗？我们应该继续调查。", 14, 20,
+        { L"我们的科学家发现了一个异常。", L"它正在发出信号！这可能是人造的吗？", L"我们应该继续调查。" }));
+
+    // Full-width clause marks are the next best cut
+    CHECK(SplitsInto(L"第一阶段已经完成、第二阶段正在进行，第三阶段尚未开始；我们需要更多资源。", 12, 20,
+        { L"第一阶段已经完成、", L"第二阶段正在进行，第三阶段尚未开始；", L"我们需要更多资源。" }));
+
+    // Korean spaces its words, so it follows the Western rules and a cut
+    // without a sentence end in reach goes between words
+    CHECK(SplitsInto(L"우리 과학자들이 이상 현상을 발견했습니다. 신호를 보내고 있습니다! 인공적인 것일까요?", 30, 30,
+        { L"우리 과학자들이 이상 현상을 발견했습니다.", L"신호를 보내고 있습니다! 인공적인 것일까요?" }));
+    CHECK(SplitsInto(L"우리 과학자들이 이상 현상을 발견했습니다. 신호를 보내고 있습니다!", 20, 30,
+        { L"우리 과학자들이 이상 현상을", L"발견했습니다. 신호를 보내고 있습니다!" }));
+
+    // The short first piece ends early so audio can start; "Dr." is no sentence end
+    CHECK(SplitsInto(L"The fleet is ready. Dr. Smith says the admiral hesitates, and we wait for orders from the capital.",
+        20, 60,
+        { L"The fleet is ready.", L"Dr. Smith says the admiral hesitates,", L"and we wait for orders from the capital." }));
+
+    // Batched lines need a sentence end so the server pauses between them
+    CHECK(EndsSentence(L"我们应该继续调查。"));
+    CHECK(EndsSentence(L"信号！"));
+    CHECK(EndsSentence(L"He said \"Go!\" "));
+    CHECK(EndsSentence(L"「本当ですか？」"));
+    CHECK(!EndsSentence(L"第一阶段已经完成、"));
+    CHECK(!EndsSentence(L"Fleet ready"));
+    CHECK(!EndsSentence(L""));
+
+    // Nothing but spaces is lost
+    std::wstring text = L"One.  Two, three;\nfour five six seven eight nine ten eleven twelve.";
+    std::wstring joined;
+    for (const std::wstring& piece : SplitTextForSynthesis(text, 8, 16)) {
+        CHECK(piece.size() <= 16);
+        joined += piece;
+    }
+    std::wstring compact;
+    for (wchar_t c : text) {
+        if (c != L' ' && c != L'\n') compact += c;
+    }
+    joined.erase(std::remove(joined.begin(), joined.end(), L' '), joined.end());
+    CHECK(joined == compact);
+}
+
+// ============================================================
+// DISK ADMISSION
+// ============================================================
+
+static std::vector<uint8_t> Clip(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+// A clip counts as on disk if it is still found after memory is cleared
+static bool OnDisk(const std::string& text) {
+    g_audioCache.Clear();
+    return g_audioCache.Contains(text, "group", "voice");
+}
+
+// What a fetch does with a clip: look it up, and store it on a miss
+static void Request(const std::string& text) {
+    std::vector<uint8_t> audio;
+    if (!g_audioCache.Get(text, "group", "voice", audio)) {
+        g_audioCache.Put(text, "group", "voice", Clip(text));
+    }
+}
+
+static void CheckFrequencySketch() {
+    FrequencySketch sketch(4096);
+    CHECK(sketch.Increment(1) == 1);
+    CHECK(sketch.Increment(1) == 2);
+    CHECK(sketch.Estimate(1) == 2);
+    CHECK(sketch.Estimate(2) == 0);
+
+    // Counters saturate at 15 and halve once width * 10 accesses have been recorded
+    FrequencySketch small(16);
+    for (int i = 0; i < 159; ++i) {
+        small.Increment(7);
+    }
+    CHECK(small.Estimate(7) == 15);
+    CHECK(small.Increment(7) == 15);
+    CHECK(small.Estimate(7) == 7);
+}
+
+static void CheckDiskAdmission() {
+    g_audioCache.ClearDiskCache();
+    DiskAdmissionStats before = g_audioCache.GetAdmissionStats();
+
+    // second_access: the first download stays in memory, the next hit writes it
+    g_config.SetDiskAdmission("second_access");
+    Request("Asked for twice.");
+    CHECK(g_audioCache.GetCachedFilePath("Asked for twice.", "group", "voice").empty());
+    Request("Asked for twice.");
+    CHECK(!g_audioCache.GetCachedFilePath("Asked for twice.", "group", "voice").empty());
+    CHECK(OnDisk("Asked for twice."));
+
+    Request("Asked for once.");
+    CHECK(!OnDisk("Asked for once."));
+
+    // min_length: only texts of disk_admission_min_chars or more are written
+    g_config.SetDiskAdmission("min_length");
+    g_config.disk_admission_min_chars = 20;
+    Request("Too short.");
+    Request("Long enough to be worth a disk write.");
+    CHECK(!OnDisk("Too short."));
+    CHECK(OnDisk("Long enough to be worth a disk write."));
+
+    // frequency: written once the sketch has counted disk_admission_min_hits requests
+    g_config.SetDiskAdmission("frequency");
+    g_config.disk_admission_min_hits = 3;
+    Request("Popular line.");
+    Request("Popular line.");
+    CHECK(g_audioCache.GetCachedFilePath("Popular line.", "group", "voice").empty());
+    Request("Popular line.");
+    CHECK(OnDisk("Popular line."));
+
+    DiskAdmissionStats after = g_audioCache.GetAdmissionStats();
+    CHECK(after.writesAdmitted - before.writesAdmitted == 3);
+    CHECK(after.promotedFromMemory - before.promotedFromMemory == 2);
+    CHECK(after.writesDeferred - before.writesDeferred == 4);
+
+    // A clip evicted from memory before it was admitted never costs a write
+    g_audioCache.SetMaxSize(1);
+    Request("Evicted on probation.");
+    Request("Pushes it out.");
+    DiskAdmissionStats evicted = g_audioCache.GetAdmissionStats();
+    CHECK(evicted.writesAvoided - after.writesAvoided == 1);
+    CHECK(evicted.bytesAvoided - after.bytesAvoided == std::string("Evicted on probation.").size());
+    CHECK(!OnDisk("Evicted on probation."));
+
+    g_audioCache.SetMaxSize(50);
+    g_config.SetDiskAdmission("always");
+    g_audioCache.ClearDiskCache();
+}
+
+// A High line with priority_interrupt stops the Low line just handed out,
+// even though its player has not started yet
+static void CheckInterruptBeforePlayback() {
+    auto line = std::make_shared<SpeechLine>();
+    line->priority = SpeechPriority::Low;
+    uint64_t seq = g_playbackQueue.AddRequests({ L"Low line." }, line);
+    g_playbackQueue.MarkReady(seq, Clip("Low line."), nullptr);
+
+    // A stop left over from the previous clip doesn't carry over
+    g_shouldCancel = true;
+    AudioItem item;
+    CHECK(g_playbackQueue.WaitForNextReady(item));
+    CHECK(item.sequenceNumber == seq);
+    CHECK(!g_shouldCancel);
+
+    CHECK(g_playbackQueue.MakeWayFor(SpeechPriority::High, false, true) == 1);
+    CHECK(g_shouldCancel);
+    CHECK(line->cancel.IsCancelled());
+    g_playbackQueue.Remove(seq);
+    g_shouldCancel = false;
+}
+
+int main() {
+    // Answers every POST with "audio:" plus the request body
+    LoopbackServer server([](const std::string& body) {
+        LoopbackReply reply;
+        reply.body = "audio:" + body;
+        return reply;
+    });
+    if (!server.Start()) {
+        std::fprintf(stderr, "FAILED: could not listen on loopback\n");
+        return 1;
+    }
+
+    g_config.SetDefaults();
+    g_config.SetTransport("socket");
+    g_logger.SetLogLevel(L"warning");
+    g_config.SetServer(server.Url().c_str());
+
+    g_fetchThreadPool.Configure(4, 32);
+    g_backendPool.Configure();
+    g_audioCache.Initialize();
+    g_audioCache.ClearDiskCache();
+
+    // The third line repeats the first and must come from the cache
+    std::vector<std::wstring> lines = { L"First line.", L"Second line.", L"First line." };
+    std::vector<uint64_t> seqs;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        uint64_t seq = g_playbackQueue.AddRequest(lines[i]);
+        seqs.push_back(seq);
+        std::string text = WideToUTF8(lines[i]);
+
+        // Let the first fetch finish so the repeat finds it cached
+        std::atomic<bool> done{ i != 0 };
+        CHECK(g_fetchThreadPool.Enqueue([text, seq, &done]() {
+            FetchLine(text, seq);
+            done = true;
+        }, seq));
+        while (!done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::vector<std::string> played;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        AudioItem item;
+        CHECK(g_playbackQueue.WaitForNextReady(item));
+        CHECK(!item.failed);
+        CHECK(item.sequenceNumber == seqs[i]);
+        played.push_back(AsString(item.audioData));
+        g_playbackQueue.Remove(item.sequenceNumber);
+    }
+
+    CHECK(played.size() == 3);
+    if (played.size() == 3) {
+        CHECK(played[0].compare(0, 6, "audio:") == 0);
+        CHECK(played[0].find("First line.") != std::string::npos);
+        CHECK(played[1].find("Second line.") != std::string::npos);
+        CHECK(played[2] == played[0]);
+    }
+    CHECK(server.Requests() == 2);
+
+    std::vector<uint8_t> cached;
+    const Backend& backend = *g_backendPool.Backends()[0];
+    CHECK(g_audioCache.Get("Second line.", backend.cacheGroup, backend.voice, cached));
+    CHECK(played.size() == 3 && AsString(cached) == played[1]);
+
+    CheckTextSplitter();
+    CheckFrequencySketch();
+    CheckDiskAdmission();
+    CheckInterruptBeforePlayback();
+
+    g_playbackQueue.Shutdown();
+    g_fetchThreadPool.Shutdown();
+    ShutdownHttpTransports();
+    server.Stop();
+
+    if (failures == 0) {
+        std::fprintf(stderr, "pipeline_test passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
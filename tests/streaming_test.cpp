@@ -0,0 +1,285 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Streamed responses, against a speech server on loopback
+// The server sends the same audio as chunked raw bytes and as a
+// stream_format=sse event stream, split at arbitrary points. The fetcher must
+// hand it to onChunk block by block while it arrives, and return it whole.
+// On the socket event loop (async_fetch) the same holds, a cancel stops the
+// body part way, a pooled connection the server has dropped is retried on a
+// new one, and a full AudioStream stops the loop reading until it drains.
+
+#include "loopback_server.h"
+#include "../config.h"
+#include "../backend_pool.h"
+#include "../tts_fetcher.h"
+#include "../http_transport.h"
+#include "../socket_event_loop.h"
+#include "../fetch_thread_pool.h"
+#include "../audio_stream.h"
+#include "../cancellation.h"
+#include "../logger.h"
+
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// The player lives in the Windows-only part of the proxy
+std::atomic<bool> g_isPlaying{ false };
+std::atomic<bool> g_shouldCancel{ false };
+
+// stdout carries the log in wide mode, so results go to stderr
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const int CHUNK_DELAY_MS = 40;
+
+// 100 KB that no framing bug can reproduce by accident
+static std::string MakeAudio() {
+    std::string audio(100 * 1024, '\0');
+    for (size_t i = 0; i < audio.size(); ++i) {
+        audio[i] = static_cast<char>((i * 31 + i / 251) & 0xFF);
+    }
+    return audio;
+}
+
+// The line's text picks the encoding
+static LoopbackReply Reply(const std::string& request, const std::string& audio) {
+    LoopbackReply reply;
+    reply.chunked = true;
+    reply.chunkSize = 777;   // Splits events and base64 quads across reads
+    if (request.find("[sse]") != std::string::npos) {
+        reply.contentType = "text/event-stream";
+        reply.body = EncodeSseAudio(audio, 1000);   // 1000 is not a multiple of 3, so every delta is padded
+    } else if (request.find("[sse error]") != std::string::npos) {
+        reply.contentType = "text/event-stream";
+        reply.body = EncodeSseAudio(audio.substr(0, 3000), 1000);
+        reply.body.replace(reply.body.rfind("speech.audio.done"), 17, "error");
+    } else {
+        reply.body = audio;
+        reply.contentType = "audio/pcm";
+    }
+    if (request.find("[slow]") != std::string::npos) {
+        reply.chunkSize = reply.body.size() / 4 + 1;
+        reply.chunkDelayMs = CHUNK_DELAY_MS;
+    }
+    return reply;
+}
+
+struct Streamed {
+    FetchResult result;
+    std::string chunks;   // onChunk's blocks, joined
+    int chunkCount = 0;
+    std::chrono::milliseconds firstChunkBeforeEnd{ 0 };
+};
+
+static Streamed Fetch(const std::string& text) {
+    Streamed streamed;
+    std::chrono::steady_clock::time_point firstChunk;
+    streamed.result = FetchTTSAudioOnce(*g_backendPool.Backends()[0], text, [&](const uint8_t* data, size_t size) {
+        if (streamed.chunkCount++ == 0) {
+            firstChunk = std::chrono::steady_clock::now();
+        }
+        streamed.chunks.append(reinterpret_cast<const char*>(data), size);
+        return true;
+    });
+    if (streamed.chunkCount > 0) {
+        streamed.firstChunkBeforeEnd = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - firstChunk);
+    }
+    return streamed;
+}
+
+static std::string AsString(const std::vector<uint8_t>& data) {
+    return std::string(data.begin(), data.end());
+}
+
+// A fetch on the event loop: chunks arrive on the loop thread, the result on a fetch worker
+struct AsyncFetch {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string chunks;
+    bool done = false;
+    FetchResult result;
+    CancellationToken cancel;
+
+    // Until the fetch is over or at least bytes have arrived
+    bool Wait(size_t bytes = SIZE_MAX) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done || chunks.size() >= bytes; });
+    }
+
+    bool Done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return done;
+    }
+};
+
+// With a stream, the audio goes into it the way progressive playback feeds the player
+static std::shared_ptr<AsyncFetch> StartAsync(const std::string& text, std::shared_ptr<AudioStream> stream = nullptr) {
+    auto fetch = std::make_shared<AsyncFetch>();
+    AudioChunkGate canTakeChunk;
+    if (stream) {
+        stream->SetSpaceCallback([]() { g_socketEventLoop.Wake(); });
+        canTakeChunk = [stream]() { return stream->HasSpace(); };
+    }
+
+    FetchTTSAudioAsync(*g_backendPool.Backends()[0], text, [fetch, stream](const uint8_t* data, size_t size) {
+        if (stream) {
+            return stream->Append(data, size);
+        }
+        std::lock_guard<std::mutex> lock(fetch->mutex);
+        fetch->chunks.append(reinterpret_cast<const char*>(data), size);
+        fetch->cv.notify_all();
+        return true;
+    }, &fetch->cancel, [fetch, stream](FetchResult& result) {
+        if (stream) {
+            stream->Finish(result.outcome == FetchOutcome::Success);
+        }
+        std::lock_guard<std::mutex> lock(fetch->mutex);
+        fetch->result = std::move(result);
+        fetch->done = true;
+        fetch->cv.notify_all();
+    }, std::move(canTakeChunk));
+    return fetch;
+}
+
+static void CheckEventLoop(LoopbackServer& server, const std::string& audio) {
+    g_config.async_fetch = true;
+    g_socketEventLoop.Configure(8);
+    g_fetchThreadPool.Configure(2, 32);
+
+    for (const char* text : { "Chunked audio.", "Events [sse]" }) {
+        auto fetch = StartAsync(text);
+        CHECK(fetch->Wait());
+        CHECK(fetch->result.outcome == FetchOutcome::Success);
+        CHECK(fetch->chunks == audio);
+        CHECK(AsString(fetch->result.audio) == audio);
+    }
+
+    // Cancelled after the first block, with the rest still on its way
+    auto cancelled = StartAsync("Chunked audio [slow]");
+    CHECK(cancelled->Wait(1));
+    cancelled->cancel.Cancel();
+    CHECK(cancelled->Wait());
+    CHECK(cancelled->result.outcome == FetchOutcome::Aborted);
+    CHECK(!cancelled->chunks.empty() && cancelled->chunks.size() < audio.size());
+
+    // The cancelled request's connection was closed; this one goes back to the pool
+    auto pooled = StartAsync("Chunked audio.");
+    CHECK(pooled->Wait());
+    CHECK(pooled->result.outcome == FetchOutcome::Success);
+
+    // The pooled connection the next request takes is dead; it must go out again on a new one
+    int connections = server.Connections();
+    server.DropConnections();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto retried = StartAsync("Chunked audio.");
+    CHECK(retried->Wait());
+    CHECK(retried->result.outcome == FetchOutcome::Success);
+    CHECK(retried->chunks == audio);
+    CHECK(server.Connections() == connections + 1);
+
+    // Nobody reads the stream for a while: the loop stops at about its capacity
+    // plus one receive buffer, then finishes once the player drains it
+    const size_t capacity = 16 * 1024;
+    auto stream = std::make_shared<AudioStream>(capacity);
+    auto held = StartAsync("Chunked audio.", stream);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(!held->Done());
+    CHECK(stream->TotalWritten() >= capacity);
+    CHECK(stream->TotalWritten() <= capacity + 64 * 1024);
+
+    std::string played;
+    uint8_t block[4096];
+    while (size_t n = stream->Read(block, sizeof(block), std::chrono::seconds(5))) {
+        played.append(reinterpret_cast<const char*>(block), n);
+    }
+    CHECK(held->Wait());
+    CHECK(held->result.outcome == FetchOutcome::Success);
+    CHECK(played == audio);
+
+    g_fetchThreadPool.Shutdown();
+    g_config.async_fetch = false;
+}
+
+int main() {
+    const std::string audio = MakeAudio();
+    LoopbackServer server([&audio](const std::string& body) { return Reply(body, audio); });
+    if (!server.Start()) {
+        std::fprintf(stderr, "FAILED: could not listen on loopback\n");
+        return 1;
+    }
+
+    g_config.SetDefaults();
+    g_config.SetTransport("socket");
+    g_logger.SetLogLevel(L"error");
+    g_config.SetServer(server.Url().c_str());
+    g_backendPool.Configure();
+
+    for (const char* text : { "Chunked audio.", "Events [sse]" }) {
+        Streamed streamed = Fetch(text);
+        CHECK(streamed.result.outcome == FetchOutcome::Success);
+        CHECK(streamed.result.chunksDelivered);
+        CHECK(streamed.chunkCount > 1);
+        CHECK(streamed.chunks == audio);
+        CHECK(AsString(streamed.result.audio) == audio);
+    }
+
+    // The first block must reach onChunk while the rest is still on its way
+    for (const char* text : { "Chunked audio [slow]", "Events [sse] [slow]" }) {
+        Streamed streamed = Fetch(text);
+        CHECK(streamed.result.outcome == FetchOutcome::Success);
+        CHECK(streamed.chunks == audio);
+        CHECK(streamed.firstChunkBeforeEnd >= std::chrono::milliseconds(2 * CHUNK_DELAY_MS));
+    }
+
+    // An error event fails the fetch even though the audio before it arrived
+    Streamed failed = Fetch("Events [sse error]");
+    CHECK(failed.result.outcome == FetchOutcome::RetryableError);
+    CHECK(failed.chunks == audio.substr(0, 3000));
+
+    CHECK(server.Requests() == 5);
+
+    CheckEventLoop(server, audio);
+
+    ShutdownHttpTransports();
+    server.Stop();
+
+    if (failures == 0) {
+        std::fprintf(stderr, "streaming_test passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "text_splitter.h"
+
+#include <cwctype>
+
+namespace {
+
+enum class Boundary {
+    None,
+    Character,
+    Word,
+    Clause,
+    Sentence
+};
+
+bool IsSpace(wchar_t c) {
+    return c == L' ' || c == L'\t' || c == L'\r' || c == L'\n' || c == 0x00A0 || c == 0x3000;
+}
+
+bool IsHighSurrogate(wchar_t c) {
+    return c >= 0xD800 && c <= 0xDBFF;
+}
+
+// Quotes and brackets that stay with the sentence they close
+bool IsCloser(wchar_t c) {
+    switch (c) {
+    case L'"': case L'\'': case L')': case L']':
+    case 0x2019: case 0x201D: case 0x00BB:                  // ’ ” »
+    case 0x300D: case 0x300F: case 0xFF09: case 0x3011:     // 」 』 ） 】
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool IsFullWidthSentenceEnd(wchar_t c) {
+    return c == 0x3002 || c == 0xFF01 || c == 0xFF1F || c == 0xFF0E;   // 。 ！ ？ ．
+}
+
+bool IsFullWidthClauseEnd(wchar_t c) {
+    return c == 0x3001 || c == 0xFF0C || c == 0xFF1B || c == 0xFF1A;   // 、 ， ； ：
+}
+
+// "Dr." or the "J." of an initial doesn't end a sentence
+bool IsAbbreviation(const std::wstring& text, size_t dot) {
+    size_t start = dot;
+    while (start > 0 && std::iswalpha(text[start - 1])) {
+        start--;
+    }
+
+    std::wstring word = text.substr(start, dot - start);
+    if (word.size() == 1 && std::iswupper(word[0])) {
+        return true;
+    }
+
+    static const wchar_t* abbreviations[] = { L"Mr", L"Mrs", L"Ms", L"Dr", L"St", L"Jr", L"Sr", L"vs", L"Prof", L"Gen", L"Adm", L"Capt" };
+    for (const wchar_t* abbreviation : abbreviations) {
+        if (word == abbreviation) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Strength of a cut right after text[i]
+Boundary BoundaryAfter(const std::wstring& text, size_t i) {
+    wchar_t c = text[i];
+    size_t nextIndex = i + 1;
+
+    if (IsHighSurrogate(c)) {
+        return Boundary::None;
+    }
+    if (nextIndex >= text.size()) {
+        return Boundary::Sentence;
+    }
+    wchar_t next = text[nextIndex];
+
+    // Cut after closing quotes, not between them and their punctuation
+    if (IsCloser(next)) {
+        return Boundary::Character;
+    }
+
+    if (c == L'\n' || IsFullWidthSentenceEnd(c)) {
+        return Boundary::Sentence;
+    }
+    if (IsFullWidthClauseEnd(c)) {
+        return Boundary::Clause;
+    }
+
+    // Look through closers back to the punctuation they follow
+    size_t mark = i;
+    while (mark > 0 && IsCloser(text[mark])) {
+        mark--;
+    }
+    wchar_t punctuation = text[mark];
+
+    if (IsFullWidthSentenceEnd(punctuation)) {
+        return Boundary::Sentence;
+    }
+    if (IsSpace(next)) {
+        if (punctuation == L'!' || punctuation == L'?' || punctuation == 0x2026 ||
+            (punctuation == L'.' && !IsAbbreviation(text, mark))) {
+            return Boundary::Sentence;
+        }
+        if (punctuation == L',' || punctuation == L';' || punctuation == L':' || punctuation == 0x2014) {
+            return Boundary::Clause;
+        }
+    }
+
+    if (IsSpace(c) || IsSpace(next)) {
+        return Boundary::Word;
+    }
+    return Boundary::Character;
+}
+
+std::wstring Trimmed(const std::wstring& text, size_t begin, size_t end) {
+    while (begin < end && IsSpace(text[begin])) begin++;
+    while (end > begin && IsSpace(text[end - 1])) end--;
+    return text.substr(begin, end - begin);
+}
+
+} // namespace
+
+std::vector<std::wstring> SplitTextForSynthesis(const std::wstring& text, size_t firstMaxChars, size_t maxChars) {
+    std::vector<std::wstring> pieces;
+    size_t pos = 0;
+
+    while (pos < text.size()) {
+        while (pos < text.size() && IsSpace(text[pos])) {
+            pos++;
+        }
+        if (pos >= text.size()) {
+            break;
+        }
+
+        size_t limit = pieces.empty() ? firstMaxChars : maxChars;
+        if (text.size() - pos <= limit) {
+            pieces.push_back(Trimmed(text, pos, text.size()));
+            break;
+        }
+
+        // Strongest boundary in the window; sentence and clause cuts must
+        // leave a reasonably sized piece, word and character cuts take what fits
+        size_t minPiece = limit / 4;
+        size_t cut = 0;
+        Boundary best = Boundary::None;
+
+        for (size_t i = pos + limit - 1; i >= pos; --i) {
+            Boundary boundary = BoundaryAfter(text, i);
+            bool longEnough = (i + 1 - pos) >= minPiece || boundary <= Boundary::Word;
+            if (boundary > best && longEnough) {
+                best = boundary;
+                cut = i + 1;
+                if (best == Boundary::Sentence) {
+                    break;
+                }
+            }
+            if (i == pos) {
+                break;
+            }
+        }
+
+        if (best == Boundary::None) {
+            cut = pos + limit;   // Only surrogates in the window; can't happen with valid UTF-16
+        }
+
+        std::wstring piece = Trimmed(text, pos, cut);
+        if (!piece.empty()) {
+            pieces.push_back(std::move(piece));
+        }
+        pos = cut;
+    }
+
+    return pieces;
+}
+
+bool EndsSentence(const std::wstring& text) {
+    size_t end = text.size();
+    while (end > 0 && (IsSpace(text[end - 1]) || IsCloser(text[end - 1]))) {
+        end--;
+    }
+    if (end == 0) {
+        return false;
+    }
+    wchar_t c = text[end - 1];
+    return c == L'.' || c == L'!' || c == L'?' || c == 0x2026 || IsFullWidthSentenceEnd(c);
+}
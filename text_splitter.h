@@ -0,0 +1,43 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_TEXT_SPLITTER_H
+#define TTS_STELLARIS_TEXT_SPLITTER_H
+
+#include <string>
+#include <vector>
+
+// Splits long texts into pieces that are synthesized in parallel and played
+// back to back. Cuts go at the strongest boundary that fits: end of sentence,
+// then clause, then word, and only as a last resort between two characters.
+// Full-width CJK punctuation counts without a following space, so Chinese and
+// Japanese split at 。！？ and 、，；：; Korean, which separates words with
+// spaces, follows the Western rules.
+// The first piece gets its own, smaller limit so audio can start sooner.
+// Nothing is dropped: the pieces joined together hold every non-space character.
+std::vector<std::wstring> SplitTextForSynthesis(const std::wstring& text, size_t firstMaxChars, size_t maxChars);
+
+// True if the text ends a sentence: . ! ? … or a full-width 。！？．, possibly
+// followed by closing quotes or brackets and spaces
+bool EndsSentence(const std::wstring& text);
+
+#endif // TTS_STELLARIS_TEXT_SPLITTER_H
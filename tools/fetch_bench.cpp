@@ -0,0 +1,584 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmarks for the fetch path, against a speech server on loopback
+// Each mode fetches through FetchTTSAudioOnce and the socket transport, the
+// way a fetch worker does, from a server in the same process - so the
+// numbers are the proxy's own cost rather than the network's:
+//   reuse   time to first byte with keep-alive against a new connection per request
+//   stream  time to first audio with stream_format=sse, chunked audio and a plain body
+//   body    receive throughput for 100 KB to 20 MB bodies, and ResponseBody against
+//           the 4 KB vector insert loop it replaced
+//   json    building the request body with SpeechRequestBuilder against the ostringstream
+//           path it replaced (no server)
+//   async   memory and CPU per request in flight, on the socket event loop against
+//           a thread blocked in FetchTTSAudioOnce for each
+//
+// Loopback is plain http, so reuse leaves out the TLS handshake that keep-alive
+// also saves against a real server; tts_bench measures that against https on Windows.
+//
+// Usage: fetch_bench <mode> [--requests n]
+
+#include "../tests/loopback_server.h"
+#include "../config.h"
+#include "../backend_pool.h"
+#include "../tts_fetcher.h"
+#include "../http_transport.h"
+#include "../logger.h"
+#include "../response_body.h"
+#include "../speech_request.h"
+#include "../socket_event_loop.h"
+#include "../fetch_thread_pool.h"
+#include "../utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iterator>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <functional>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// The player lives in the Windows-only part of the proxy
+std::atomic<bool> g_isPlaying{ false };
+std::atomic<bool> g_shouldCancel{ false };
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================
+// MEASUREMENT
+// ============================================================
+
+struct Timing {
+    bool ok = false;
+    double firstByteUs = 0;   // Request start to the first block of audio (decoded, for SSE)
+    double totalUs = 0;       // Request start to the end of the body
+    size_t bytes = 0;
+};
+
+static double MicrosecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static Timing TimedFetch(const Backend& backend, const std::string& text) {
+    Timing timing;
+    Clock::time_point start = Clock::now();
+    FetchResult result = FetchTTSAudioOnce(backend, text, [&](const uint8_t*, size_t) {
+        if (timing.firstByteUs == 0) {
+            timing.firstByteUs = MicrosecondsSince(start);
+        }
+        return true;
+    });
+    timing.totalUs = MicrosecondsSince(start);
+    timing.ok = result.outcome == FetchOutcome::Success;
+    timing.bytes = result.audio.size();
+    return timing;
+}
+
+static double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+// Fetches text requests times after one unmeasured warm-up; false if any failed
+static bool Run(const Backend& backend, const std::string& text, int requests,
+    std::vector<double>& firstByte, std::vector<double>& total) {
+    if (!TimedFetch(backend, text).ok) {
+        return false;
+    }
+    for (int i = 0; i < requests; ++i) {
+        Timing timing = TimedFetch(backend, text);
+        if (!timing.ok) {
+            return false;
+        }
+        firstByte.push_back(timing.firstByteUs);
+        total.push_back(timing.totalUs);
+    }
+    return true;
+}
+
+static bool StartServer(LoopbackServer& server) {
+    if (!server.Start()) {
+        fprintf(stderr, "Can't listen on loopback\n");
+        return false;
+    }
+    g_config.SetServer(server.Url().c_str());
+    g_backendPool.Configure();
+    return true;
+}
+
+// ============================================================
+// MODES
+// ============================================================
+
+static int BenchReuse(int requests) {
+    LoopbackServer server([](const std::string&) {
+        LoopbackReply reply;
+        reply.body.assign(8 * 1024, '\0');
+        return reply;
+    });
+    if (!StartServer(server)) return 1;
+    const Backend& backend = *g_backendPool.Backends()[0];
+
+    fprintf(stderr, "%d requests, 8 KB each\n", requests);
+    for (bool keepAlive : { false, true }) {
+        g_config.keep_alive = keepAlive;
+        int connections = server.Connections();
+        std::vector<double> firstByte, total;
+        if (!Run(backend, "Session reuse.", requests, firstByte, total)) {
+            fprintf(stderr, "FAILED: fetch with keep_alive=%d\n", keepAlive ? 1 : 0);
+            return 1;
+        }
+        fprintf(stderr, "keep_alive=%d  first byte p50 %7.0f us  p90 %7.0f us  total p50 %7.0f us  connections %d\n",
+            keepAlive ? 1 : 0, Percentile(firstByte, 0.5), Percentile(firstByte, 0.9), Percentile(total, 0.5),
+            server.Connections() - connections);
+    }
+    return 0;
+}
+
+// The server makes 128 KB of audio in 8 blocks, one every 5 ms. Chunked and
+// SSE send each block as it is made; a plain response waits for all of them.
+static int BenchStream(int requests) {
+    const int blocks = 8;
+    const int blockMs = 5;
+    std::string audio(blocks * 16 * 1024, '\x55');
+    LoopbackServer server([&](const std::string& request) {
+        LoopbackReply reply;
+        if (request.find("plain") != std::string::npos) {
+            reply.body = audio;
+            reply.firstByteDelayMs = blocks * blockMs;
+            return reply;
+        }
+        reply.chunked = true;
+        reply.chunkDelayMs = blockMs;
+        if (request.find("sse") != std::string::npos) {
+            reply.contentType = "text/event-stream";
+            reply.body = EncodeSseAudio(audio, 16 * 1024);
+        } else {
+            reply.contentType = "audio/pcm";
+            reply.body = audio;
+        }
+        reply.firstByteDelayMs = blockMs;
+        reply.chunkSize = reply.body.size() / blocks + 1;
+        return reply;
+    });
+    if (!StartServer(server)) return 1;
+    const Backend& backend = *g_backendPool.Backends()[0];
+
+    fprintf(stderr, "%d requests, 128 KB made in %d blocks of %d ms\n", requests, blocks, blockMs);
+    for (const char* format : { "plain", "chunked", "sse" }) {
+        std::vector<double> firstAudio, total;
+        if (!Run(backend, std::string("Streamed as ") + format, requests, firstAudio, total)) {
+            fprintf(stderr, "FAILED: %s fetch\n", format);
+            return 1;
+        }
+        fprintf(stderr, "%-8s  first audio p50 %7.0f us  p90 %7.0f us  total p50 %7.0f us\n",
+            format, Percentile(firstAudio, 0.5), Percentile(firstAudio, 0.9), Percentile(total, 0.5));
+    }
+    return 0;
+}
+
+static const size_t BODY_SIZES[] = { 100 * 1024, 1024 * 1024, 5 * 1024 * 1024, 20 * 1024 * 1024 };
+
+// About 256 MB per size, so the large bodies don't run for minutes
+static int BodyIterations(size_t size, int requests) {
+    return std::max(1, std::min(requests, static_cast<int>(256 * 1024 * 1024 / size)));
+}
+
+// The download loop before ResponseBody: 4 KB reads into a stack buffer, appended
+// to a vector that is reserved only when the length is known. The memcpy out
+// of source stands for the read in both loops.
+static size_t ReceiveByInsert(const uint8_t* source, size_t size, bool knownLength) {
+    std::vector<uint8_t> audio;
+    if (knownLength) {
+        audio.reserve(size);
+    }
+    uint8_t buffer[4096];
+    for (size_t offset = 0; offset < size; offset += sizeof(buffer)) {
+        size_t n = std::min(sizeof(buffer), size - offset);
+        memcpy(buffer, source + offset, n);
+        audio.insert(audio.end(), buffer, buffer + n);
+    }
+    return audio.size();
+}
+
+// The fetcher's loop: reads into the body's own space, the window growing from 16 KB to 256 KB
+static size_t ReceiveByResponseBody(ResponseBody& body, const uint8_t* source, size_t size, bool knownLength) {
+    body.Reset(knownLength ? size : 0);
+    size_t window = 16 * 1024;
+    for (size_t offset = 0; offset < size;) {
+        size_t space = 0;
+        uint8_t* dest = body.Prepare(window, space);
+        size_t n = std::min({ window, space, size - offset });
+        memcpy(dest, source + offset, n);
+        body.Commit(n);
+        offset += n;
+        if (n == window && window < 256 * 1024) {
+            window *= 2;
+        }
+    }
+    return body.Take().size();
+}
+
+static int BenchBody(int requests) {
+    std::string audio(BODY_SIZES[std::size(BODY_SIZES) - 1], '\x55');
+    LoopbackServer server([&](const std::string& request) {
+        LoopbackReply reply;
+        size_t size = strtoul(request.c_str() + request.find("bytes ") + 6, nullptr, 10);
+        reply.contentType = "audio/pcm";
+        reply.body = audio.substr(0, size);
+        reply.chunked = request.find("chunked") != std::string::npos;
+        reply.chunkSize = 64 * 1024;
+        return reply;
+    });
+    if (!StartServer(server)) return 1;
+    const Backend& backend = *g_backendPool.Backends()[0];
+
+    // Throughput is bytes per microsecond, which is MB/s
+    fprintf(stderr, "Fetch (MB/s, p50)\n");
+    for (size_t size : BODY_SIZES) {
+        int iterations = BodyIterations(size, requests);
+        for (const char* framing : { "length", "chunked" }) {
+            std::vector<double> firstByte, total;
+            std::string text = std::string(framing) + " bytes " + std::to_string(size);
+            if (!Run(backend, text, iterations, firstByte, total)) {
+                fprintf(stderr, "FAILED: %s fetch of %zu bytes\n", framing, size);
+                return 1;
+            }
+            fprintf(stderr, "%6zu KB  %-7s  %7.0f MB/s  (%d requests)\n",
+                size / 1024, framing, size / Percentile(total, 0.5), iterations);
+        }
+    }
+
+    // The same reads without the socket, so only the copying and allocation is left
+    fprintf(stderr, "Receive loop (MB/s, p50)\n");
+    const uint8_t* source = reinterpret_cast<const uint8_t*>(audio.data());
+    ResponseBody body;
+    for (size_t size : BODY_SIZES) {
+        int iterations = BodyIterations(size, requests);
+        for (bool knownLength : { true, false }) {
+            std::vector<double> byInsert, byBody;
+            for (int i = 0; i < iterations; ++i) {
+                Clock::time_point start = Clock::now();
+                ReceiveByInsert(source, size, knownLength);
+                byInsert.push_back(MicrosecondsSince(start));
+                start = Clock::now();
+                ReceiveByResponseBody(body, source, size, knownLength);
+                byBody.push_back(MicrosecondsSince(start));
+            }
+            fprintf(stderr, "%6zu KB  %-7s  insert %7.0f MB/s  ResponseBody %7.0f MB/s\n",
+                size / 1024, knownLength ? "length" : "chunked",
+                size / Percentile(byInsert, 0.5), size / Percentile(byBody, 0.5));
+        }
+    }
+    return 0;
+}
+
+// The request body as it was built before SpeechRequestBuilder, escape included
+static std::string EscapeByStream(const std::string& str) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < str.length(); ++i) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        switch (c) {
+        case '"':  oss << "\\\""; break;
+        case '\\': oss << "\\\\"; break;
+        case '\b': oss << "\\b"; break;
+        case '\f': oss << "\\f"; break;
+        case '\n': oss << "\\n"; break;
+        case '\r': oss << "\\r"; break;
+        case '\t': oss << "\\t"; break;
+        default:
+            if (c < 0x20) {
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            } else {
+                oss << c;
+            }
+        }
+    }
+    return oss.str();
+}
+
+static std::string BuildByStream(const std::string& model, const std::string& voice, const std::string& text) {
+    std::ostringstream jsonBody;
+    jsonBody << "{"
+        << "\"model\":\"" << EscapeByStream(model) << "\","
+        << "\"input\":\"" << EscapeByStream(text) << "\","
+        << "\"voice\":\"" << EscapeByStream(voice) << "\","
+        << "\"response_format\":\"" << EscapeByStream(g_config.format) << "\""
+        << "}";
+    return jsonBody.str();
+}
+
+// Event text the way the game sends it: mostly plain, with quotes, line breaks and UTF-8
+static std::string EventText(size_t length) {
+    static const std::string SAMPLE =
+        "The \"Shroud\" stirs.\nOur scientists report that the anomaly on Zeta Tauri II "
+        "is emitting signals at 4.2 GHz \xE2\x80\x94 possibly artificial.\t";
+    std::string text;
+    while (text.size() < length) {
+        text += SAMPLE;
+    }
+    text.resize(length);
+    return text;
+}
+
+// Nanoseconds per build: the p50 of 10 rounds, each timing many builds together
+template <typename BuildFn>
+static double NanosecondsPerBuild(int builds, BuildFn build) {
+    std::vector<double> rounds;
+    for (int round = 0; round < 10; ++round) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < builds; ++i) {
+            build();
+        }
+        rounds.push_back(MicrosecondsSince(start) * 1000 / builds);
+    }
+    return Percentile(rounds, 0.5);
+}
+
+static int BenchJson(int requests) {
+    const std::string model = g_config.model;
+    const std::string voice = g_config.voice;
+    SpeechRequestBuilder builder;
+    size_t sink = 0;   // Keeps the builds from being optimised away
+
+    fprintf(stderr, "Request body build (ns, p50)\n");
+    for (size_t length : { 100, 1000, 5000 }) {
+        std::string text = EventText(length);
+        if (builder.Build(model, voice, text).find(EscapeByStream(text)) == std::string::npos) {
+            fprintf(stderr, "FAILED: SpeechRequestBuilder escapes %zu characters differently\n", length);
+            return 1;
+        }
+
+        int builds = std::max(1, requests * 100 / static_cast<int>(length / 100));
+        double byStream = NanosecondsPerBuild(builds, [&]() { sink += BuildByStream(model, voice, text).size(); });
+        double byBuilder = NanosecondsPerBuild(builds, [&]() { sink += builder.Build(model, voice, text).size(); });
+        fprintf(stderr, "%5zu chars  ostringstream %8.0f ns  SpeechRequestBuilder %8.0f ns  (%.1fx)\n",
+            length, byStream, byBuilder, byStream / byBuilder);
+    }
+    return sink > 0 ? 0 : 1;
+}
+
+// Resident memory of the whole process, 0 where it can't be read
+static double ResidentKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize / 1024.0;
+#elif defined(__linux__)
+    long size = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    bool ok = fscanf(statm, "%ld %ld", &size, &resident) == 2;
+    fclose(statm);
+    return ok ? resident * (sysconf(_SC_PAGESIZE) / 1024.0) : 0;
+#else
+    return 0;
+#endif
+}
+
+// User plus kernel time of every thread so far
+static double ProcessCpuMs() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER kernelTime, userTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+    return (kernelTime.QuadPart + userTime.QuadPart) / 10000.0;
+#else
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#endif
+}
+
+struct InFlight {
+    bool ok = false;
+    double residentKb = 0;   // Growth while every request waits for its answer
+    double cpuMs = 0;        // Start of the first request to the end of the last
+    double totalMs = 0;
+};
+
+// Starts requests requests through start, measures memory while the server
+// holds all of them, and waits for them to finish
+static InFlight HoldRequests(int requests, int firstByteMs, const std::function<void(int)>& start,
+    std::atomic<int>& done, std::atomic<int>& succeeded) {
+    InFlight measured;
+    double residentBefore = ResidentKb();
+    double cpuBefore = ProcessCpuMs();
+    Clock::time_point begin = Clock::now();
+
+    for (int i = 0; i < requests; ++i) {
+        start(i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(firstByteMs / 2));
+    measured.residentKb = ResidentKb() - residentBefore;
+
+    while (done.load() < requests && Clock::now() - begin < std::chrono::seconds(30)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    measured.cpuMs = ProcessCpuMs() - cpuBefore;
+    measured.totalMs = MicrosecondsSince(begin) / 1000;
+    measured.ok = succeeded.load() == requests;
+    return measured;
+}
+
+// Every request is held by the server for firstByteMs, so all of them are in
+// flight at once. Each way gets a server of its own, kept until the end, so
+// neither reuses the other's connections or server threads; those threads
+// count in both.
+static int BenchAsync(int requests) {
+    const int firstByteMs = 500;
+    auto reply = [](const std::string&) {
+        LoopbackReply reply;
+        reply.body.assign(8 * 1024, '\0');
+        reply.firstByteDelayMs = firstByteMs;
+        return reply;
+    };
+    LoopbackServer loopServer(reply);
+    LoopbackServer threadServer(reply);
+
+    g_config.async_fetch = true;
+    g_socketEventLoop.Configure(requests);
+    g_fetchThreadPool.Configure(2, requests);
+
+    fprintf(stderr, "%d requests in flight at once, 8 KB each after %d ms\n", requests, firstByteMs);
+
+    // The loop thread and fetch workers start with the unmeasured first request
+    if (!StartServer(loopServer)) return 1;
+    const Backend& loopBackend = *g_backendPool.Backends()[0];
+    InFlight loop;
+    for (int round = 0; round < 2; ++round) {
+        std::atomic<int> done{ 0 }, succeeded{ 0 };
+        int count = round == 0 ? 1 : requests;
+        loop = HoldRequests(count, firstByteMs, [&](int) {
+            FetchTTSAudioAsync(loopBackend, "In flight.", nullptr, nullptr, [&](FetchResult& result) {
+                if (result.outcome == FetchOutcome::Success) succeeded++;
+                done++;
+            });
+        }, done, succeeded);
+        if (!loop.ok) {
+            fprintf(stderr, "FAILED: fetch on the event loop\n");
+            return 1;
+        }
+    }
+
+    if (!StartServer(threadServer)) return 1;
+    const Backend& threadBackend = *g_backendPool.Backends()[0];
+    std::vector<std::thread> threads;
+    std::atomic<int> done{ 0 }, succeeded{ 0 };
+    InFlight blocking = HoldRequests(requests, firstByteMs, [&](int) {
+        threads.emplace_back([&]() {
+            if (FetchTTSAudioOnce(threadBackend, "In flight.").outcome == FetchOutcome::Success) succeeded++;
+            done++;
+        });
+    }, done, succeeded);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!blocking.ok) {
+        fprintf(stderr, "FAILED: fetch on a thread per request\n");
+        return 1;
+    }
+
+    for (const auto& way : { std::make_pair("event loop", loop), std::make_pair("thread each", blocking) }) {
+        fprintf(stderr, "%-12s  memory %6.1f KB per request  CPU %5.2f ms per request  all done in %5.0f ms\n",
+            way.first, way.second.residentKb / requests, way.second.cpuMs / requests, way.second.totalMs);
+    }
+
+    g_fetchThreadPool.Shutdown();
+    return 0;
+}
+
+// ============================================================
+// MAIN
+// ============================================================
+
+struct Mode {
+    const char* name;
+    int (*run)(int requests);
+};
+
+static const Mode MODES[] = {
+    { "reuse", BenchReuse },
+    { "stream", BenchStream },
+    { "body", BenchBody },
+    { "json", BenchJson },
+    { "async", BenchAsync },
+};
+
+// Results go to stderr: stdout carries the log in wide mode
+int main(int argc, char** argv) {
+    const Mode* mode = nullptr;
+    int requests = 200;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            requests = std::max(1, atoi(argv[++i]));
+            continue;
+        }
+        for (const Mode& m : MODES) {
+            if (strcmp(argv[i], m.name) == 0) mode = &m;
+        }
+    }
+    if (!mode) {
+        std::string names;
+        for (const Mode& m : MODES) {
+            names += names.empty() ? m.name : std::string("|") + m.name;
+        }
+        fprintf(stderr, "Usage: fetch_bench <%s> [--requests n]\n", names.c_str());
+        return 2;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        fprintf(stderr, "WSAStartup failed\n");
+        return 1;
+    }
+#endif
+
+    g_config.SetDefaults();
+    g_config.SetTransport("socket");
+    g_logger.SetLogLevel(L"warning");
+
+    int result = mode->run(requests);
+    ShutdownHttpTransports();
+    return result;
+}
@@ -0,0 +1,230 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmark driver: speaks a scenario through the proxy and reports its latency
+// The scenario runs in a child process that loads the proxy's version.dll
+// and calls SAPI's Speak the way the game does. When the child exits, the
+// proxy logs its shutdown statistics to tts_proxy.log next to this program;
+// they are printed here: Speak-to-first-sound percentiles, each server's
+// request phases, hedging, failover and batching.
+//
+// Put tts_settings.txt next to tts_bench.exe, pointing at tools/tts_standin
+// (server=http://127.0.0.1:8880/v1) with mute_original=1 and log_to_file=1.
+// Delete the cache folder between runs, or the next one is all cache hits.
+//
+// Scenario file, one Speak call per line:
+//   +<ms> text    wait ms after the previous line, then speak text
+//   text          speak right after the previous line
+//   # comment
+//
+// Usage: tts_bench <scenario> [--dll path] [--settle seconds]
+
+#include <windows.h>
+#include <sapi.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#pragma comment(lib, "ole32.lib")
+
+// The proxy creates its SAPI hooks 3 seconds after loading, from a timer
+static const DWORD HOOK_DELAY_MS = 4000;
+
+// Written by the proxy when it shuts down; its statistics follow
+static const char* SHUTDOWN_MARKER = "Shutting down parallel TTS system";
+
+struct ScenarioLine {
+    DWORD delayMs = 0;
+    std::wstring text;
+};
+
+static std::wstring Widen(const std::string& text) {
+    if (text.empty()) return std::wstring();
+    int size = MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+    std::wstring wide(size, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), &wide[0], size);
+    return wide;
+}
+
+static bool LoadScenario(const std::wstring& path, std::vector<ScenarioLine>& lines) {
+    std::ifstream file(path);
+    if (!file) {
+        fwprintf(stderr, L"Can't open scenario %s\n", path.c_str());
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') continue;
+
+        ScenarioLine entry;
+        if (line[start] == '+') {
+            size_t end = line.find_first_of(" \t", start);
+            if (end == std::string::npos) continue;
+            entry.delayMs = static_cast<DWORD>(strtoul(line.c_str() + start + 1, nullptr, 10));
+            start = line.find_first_not_of(" \t", end);
+            if (start == std::string::npos) continue;
+        }
+        entry.text = Widen(line.substr(start));
+        lines.push_back(std::move(entry));
+    }
+
+    if (lines.empty()) {
+        fwprintf(stderr, L"Scenario %s has no lines\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Wait, dispatching messages meanwhile - the proxy's timer window lives on this thread
+static void PumpFor(DWORD ms) {
+    DWORD start = GetTickCount();
+    for (DWORD elapsed = 0; elapsed < ms; elapsed = GetTickCount() - start) {
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, ms - elapsed, QS_ALLINPUT);
+        MSG msg;
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+    }
+}
+
+// Child process: load the proxy and speak the scenario
+static int RunScenario(const std::vector<ScenarioLine>& lines, const std::wstring& dll, DWORD settleMs) {
+    HMODULE proxy = LoadLibraryW(dll.c_str());
+    if (!proxy) {
+        fwprintf(stderr, L"Can't load %s (error %lu)\n", dll.c_str(), GetLastError());
+        return 1;
+    }
+    PumpFor(HOOK_DELAY_MS);
+
+    if (FAILED(CoInitialize(nullptr))) {
+        fwprintf(stderr, L"CoInitialize failed\n");
+        return 1;
+    }
+    ISpVoice* voice = nullptr;
+    if (FAILED(CoCreateInstance(CLSID_SpVoice, nullptr, CLSCTX_ALL, IID_ISpVoice, reinterpret_cast<void**>(&voice)))) {
+        fwprintf(stderr, L"Can't create a SAPI voice\n");
+        CoUninitialize();
+        return 1;
+    }
+
+    for (const ScenarioLine& line : lines) {
+        PumpFor(line.delayMs);
+        voice->Speak(line.text.c_str(), SPF_ASYNC, nullptr);
+    }
+    PumpFor(settleMs);
+
+    voice->Release();
+    CoUninitialize();
+    return 0;   // Exiting unloads the proxy, which logs its statistics
+}
+
+static std::wstring ExeDirectory() {
+    wchar_t path[MAX_PATH];
+    DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+    std::wstring directory(path, length);
+    size_t slash = directory.find_last_of(L"\\/");
+    return slash == std::wstring::npos ? std::wstring(L".") : directory.substr(0, slash);
+}
+
+int wmain(int argc, wchar_t** argv) {
+    std::wstring scenarioPath;
+    std::wstring dll = ExeDirectory() + L"\\version.dll";
+    DWORD settleSeconds = 30;
+    bool child = false;
+    bool usage = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::wstring arg = argv[i];
+        if (arg == L"--dll" && i + 1 < argc) dll = argv[++i];
+        else if (arg == L"--settle" && i + 1 < argc) settleSeconds = wcstoul(argv[++i], nullptr, 10);
+        else if (arg == L"--run") child = true;
+        else if (scenarioPath.empty() && arg.rfind(L"--", 0) != 0) scenarioPath = arg;
+        else usage = true;
+    }
+    if (usage || scenarioPath.empty()) {
+        fwprintf(stderr, L"Usage: tts_bench <scenario> [--dll path] [--settle seconds]\n");
+        return 2;
+    }
+
+    std::vector<ScenarioLine> lines;
+    if (!LoadScenario(scenarioPath, lines)) {
+        return 1;
+    }
+    if (child) {
+        return RunScenario(lines, dll, settleSeconds * 1000);
+    }
+
+    // Only this run's part of the log is reported
+    std::wstring logPath = ExeDirectory() + L"\\tts_proxy.log";
+    WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+    uint64_t logStart = 0;
+    if (GetFileAttributesExW(logPath.c_str(), GetFileExInfoStandard, &attributes)) {
+        logStart = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    }
+
+    wchar_t exePath[MAX_PATH];
+    GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+    std::wstring commandLine = L"\"" + std::wstring(exePath) + L"\" --run \"" + scenarioPath + L"\" --dll \"" + dll +
+        L"\" --settle " + std::to_wstring(settleSeconds);
+
+    wprintf(L"Speaking %zu lines through %s...\n", lines.size(), dll.c_str());
+    STARTUPINFOW startup = { sizeof(startup) };
+    PROCESS_INFORMATION process = {};
+    if (!CreateProcessW(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &process)) {
+        fwprintf(stderr, L"Can't start the scenario process (error %lu)\n", GetLastError());
+        return 1;
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    if (exitCode != 0) {
+        return static_cast<int>(exitCode);
+    }
+
+    std::ifstream log(logPath, std::ios::binary);
+    log.seekg(static_cast<std::streamoff>(logStart));
+    std::string line;
+    bool reporting = false;
+    while (std::getline(log, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!reporting) {
+            reporting = line.find(SHUTDOWN_MARKER) != std::string::npos;
+            if (reporting) printf("\n=== Proxy statistics ===\n");
+            continue;
+        }
+        printf("%s\n", line.c_str());
+    }
+    if (!reporting) {
+        fwprintf(stderr, L"No shutdown statistics in %s - is log_to_file=1 set?\n", logPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,954 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Stand-in for an OpenAI-compatible speech server
+// Answers POST .../audio/speech with deterministic synthetic audio in every
+// response_format the proxy can ask for, and GET .../models for the warm-up.
+// A profile file scripts how the server misbehaves - latency, bandwidth,
+// 429 bursts, errors, truncated bodies and connection resets - so slow and
+// flaky servers can be reproduced without paying for the real API.
+//
+// Builds with tts_standin.vcxproj on Windows, and elsewhere with
+//   g++ -std=c++17 -O2 -pthread tools/tts_standin.cpp -o tts_standin
+//
+// Usage: tts_standin [--port 8880] [--profile file] [--seed n] [--quiet]
+
+#include "../socket_platform.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+// ============================================================
+// PROFILE
+// ============================================================
+
+// A latency in milliseconds: "300", "uniform 100 900" or "lognormal 400 1500"
+// (median and 99th percentile, for a long tail)
+struct Distribution {
+    enum class Kind { Fixed, Uniform, LogNormal };
+
+    Kind kind = Kind::Fixed;
+    double a = 0;
+    double b = 0;
+
+    bool Parse(const std::string& spec) {
+        std::istringstream in(spec);
+        std::string first;
+        if (!(in >> first)) return false;
+
+        if (first == "uniform" || first == "lognormal") {
+            if (!(in >> a >> b) || a < 0 || b < a) return false;
+            kind = first == "uniform" ? Kind::Uniform : Kind::LogNormal;
+            return first == "uniform" || a > 0;
+        }
+        kind = Kind::Fixed;
+        a = atof(first.c_str());
+        return a >= 0;
+    }
+
+    double Sample(std::mt19937& rng) const {
+        switch (kind) {
+        case Kind::Uniform:
+            return std::uniform_real_distribution<double>(a, b)(rng);
+        case Kind::LogNormal: {
+            // The 99th percentile of a normal distribution is 2.326 standard deviations out
+            double sigma = std::log(b / a) / 2.326;
+            return std::lognormal_distribution<double>(std::log(a), sigma)(rng);
+        }
+        default:
+            return a;
+        }
+    }
+};
+
+enum class Transfer { Length, Chunked, Close };
+
+// One phase of a run; keys before the first [stage] are defaults every stage starts from
+struct Stage {
+    std::string name = "default";
+    uint64_t requests = 0;            // Speech requests this stage lasts, 0 = the rest of the run
+
+    Distribution ttfb;                // Synthesis time before the response headers
+    double msPerChar = 0;             // Added to ttfb for every input character
+    uint64_t bytesPerSecond = 0;      // Body bandwidth, 0 = unlimited
+    size_t chunkBytes = 4096;         // Body written (and paced) in blocks of this size
+    Transfer transfer = Transfer::Length;
+    bool keepAlive = true;
+
+    double rate429 = 0;               // Share of requests answered 429
+    uint64_t burst429Every = 0;       // Every this many requests...
+    uint64_t burst429Length = 0;      // ...this many in a row get 429
+    int retryAfterSeconds = 1;        // Retry-After sent with 429 and 503, 0 = none
+    double rate500 = 0;
+    double rate503 = 0;
+    double truncateRate = 0;          // Body cut short and the connection closed
+    double resetRate = 0;             // Connection reset, before the headers or mid-body
+
+    double charsPerSecond = 15;       // Speaking rate of the synthetic audio
+    uint32_t sampleRate = 24000;      // wav, pcm and flac; the silent codecs use their own
+};
+
+static bool SetStageKey(Stage& stage, const std::string& key, const std::string& value) {
+    if (key == "requests") stage.requests = strtoull(value.c_str(), nullptr, 10);
+    else if (key == "ttfb_ms") return stage.ttfb.Parse(value);
+    else if (key == "ms_per_char") stage.msPerChar = atof(value.c_str());
+    else if (key == "bytes_per_second") stage.bytesPerSecond = strtoull(value.c_str(), nullptr, 10);
+    else if (key == "chunk_bytes") stage.chunkBytes = std::max<size_t>(1, strtoull(value.c_str(), nullptr, 10));
+    else if (key == "transfer") {
+        if (value == "length") stage.transfer = Transfer::Length;
+        else if (value == "chunked") stage.transfer = Transfer::Chunked;
+        else if (value == "close") stage.transfer = Transfer::Close;
+        else return false;
+    }
+    else if (key == "keep_alive") stage.keepAlive = value != "0";
+    else if (key == "rate_429") stage.rate429 = atof(value.c_str());
+    else if (key == "burst_429_every") stage.burst429Every = strtoull(value.c_str(), nullptr, 10);
+    else if (key == "burst_429_length") stage.burst429Length = strtoull(value.c_str(), nullptr, 10);
+    else if (key == "retry_after_s") stage.retryAfterSeconds = atoi(value.c_str());
+    else if (key == "rate_500") stage.rate500 = atof(value.c_str());
+    else if (key == "rate_503") stage.rate503 = atof(value.c_str());
+    else if (key == "truncate_rate") stage.truncateRate = atof(value.c_str());
+    else if (key == "reset_rate") stage.resetRate = atof(value.c_str());
+    else if (key == "chars_per_second") stage.charsPerSecond = std::max(1.0, atof(value.c_str()));
+    else if (key == "sample_rate") stage.sampleRate = static_cast<uint32_t>(std::max(8000, atoi(value.c_str())));
+    else return false;
+    return true;
+}
+
+static std::string Trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(start, end - start + 1);
+}
+
+// Same key=value layout as tts_settings.txt, plus [stage name] headers
+static bool LoadProfile(const char* path, std::vector<Stage>& stages) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Can't open profile %s\n", path);
+        return false;
+    }
+
+    Stage defaults;
+    bool inStage = false;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        line = Trim(line);
+        if (line.empty()) continue;
+
+        if (line.front() == '[' && line.back() == ']') {
+            stages.push_back(defaults);
+            stages.back().name = Trim(line.substr(1, line.size() - 2));
+            inStage = true;
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        Stage& target = inStage ? stages.back() : defaults;
+        if (equals == std::string::npos ||
+            !SetStageKey(target, Trim(line.substr(0, equals)), Trim(line.substr(equals + 1)))) {
+            fprintf(stderr, "%s:%d: bad setting '%s'\n", path, lineNumber, line.c_str());
+            return false;
+        }
+    }
+
+    if (stages.empty()) {
+        stages.push_back(defaults);
+    }
+    return true;
+}
+
+// ============================================================
+// SYNTHETIC AUDIO
+// ============================================================
+
+// Speech-like PCM: a tone per sentence, as long as its characters take to
+// say, each followed by a pause so batched lines can be cut apart again.
+// The pitch comes from the sentence's text, so the same input always gives
+// the same samples.
+static std::vector<int16_t> SynthesizePcm(const std::string& text, const Stage& stage, uint32_t sampleRate) {
+    const double PI = 3.14159265358979323846;
+    std::vector<int16_t> samples(sampleRate / 20, 0);   // 50 ms lead-in
+
+    auto addSentence = [&](size_t chars, uint32_t hash) {
+        size_t length = static_cast<size_t>(std::max(0.15, chars / stage.charsPerSecond) * sampleRate);
+        size_t fade = sampleRate / 100;
+        double frequency = 180.0 + hash % 200;
+        for (size_t i = 0; i < length; ++i) {
+            double envelope = std::min({ 1.0, double(i) / fade, double(length - i) / fade });
+            samples.push_back(static_cast<int16_t>(9000.0 * envelope * std::sin(2 * PI * frequency * i / sampleRate)));
+        }
+        samples.resize(samples.size() + sampleRate * 2 / 5, 0);  // 400 ms pause
+    };
+
+    size_t chars = 0;
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 16777619u;
+        if ((c & 0xC0) != 0x80) chars++;   // Count code points, not bytes
+        if (c == '.' || c == '!' || c == '?' || c == '\n') {
+            if (chars > 1) {
+                addSentence(chars, hash);
+                chars = 0;
+                hash = 2166136261u;
+            }
+        }
+    }
+    if (chars > 0 || samples.size() == sampleRate / 20) {
+        addSentence(std::max<size_t>(chars, 1), hash);
+    }
+    return samples;
+}
+
+static void AppendLE(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static void AppendBytes(std::vector<uint8_t>& out, const char* bytes, size_t size) {
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+static std::vector<uint8_t> EncodePcm(const std::vector<int16_t>& samples) {
+    std::vector<uint8_t> out;
+    out.reserve(samples.size() * 2);
+    for (int16_t sample : samples) AppendLE(out, static_cast<uint16_t>(sample), 2);
+    return out;
+}
+
+static std::vector<uint8_t> EncodeWav(const std::vector<int16_t>& samples, uint32_t sampleRate) {
+    uint32_t dataSize = static_cast<uint32_t>(samples.size() * 2);
+    std::vector<uint8_t> out;
+    AppendBytes(out, "RIFF", 4);
+    AppendLE(out, 36 + dataSize, 4);
+    AppendBytes(out, "WAVEfmt ", 8);
+    AppendLE(out, 16, 4);
+    AppendLE(out, 1, 2);                 // PCM
+    AppendLE(out, 1, 2);                 // Mono
+    AppendLE(out, sampleRate, 4);
+    AppendLE(out, sampleRate * 2, 4);
+    AppendLE(out, 2, 2);
+    AppendLE(out, 16, 2);
+    AppendBytes(out, "data", 4);
+    AppendLE(out, dataSize, 4);
+    std::vector<uint8_t> pcm = EncodePcm(samples);
+    out.insert(out.end(), pcm.begin(), pcm.end());
+    return out;
+}
+
+// MSB-first bit packing for the FLAC and ADTS headers
+class BitWriter {
+public:
+    std::vector<uint8_t> bytes;
+
+    void Put(uint64_t value, int bits) {
+        for (int i = bits - 1; i >= 0; --i) {
+            if (used == 0) bytes.push_back(0);
+            if ((value >> i) & 1) bytes.back() |= static_cast<uint8_t>(0x80 >> used);
+            used = (used + 1) % 8;
+        }
+    }
+
+private:
+    int used = 0;
+};
+
+static uint8_t Crc8(const uint8_t* data, size_t size) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t Crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; ++bit) crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1);
+    }
+    return crc;
+}
+
+// Lossless FLAC with verbatim subframes - bigger than a real encoder's, but the tone survives
+static std::vector<uint8_t> EncodeFlac(const std::vector<int16_t>& samples, uint32_t sampleRate) {
+    const size_t BLOCK = 4096;
+    std::vector<uint8_t> out;
+    AppendBytes(out, "fLaC", 4);
+
+    BitWriter info;
+    info.Put(1, 1);                      // Last metadata block
+    info.Put(0, 7);                      // STREAMINFO
+    info.Put(34, 24);
+    info.Put(BLOCK, 16);
+    info.Put(BLOCK, 16);
+    info.Put(0, 24);                     // Frame sizes unknown
+    info.Put(0, 24);
+    info.Put(sampleRate, 20);
+    info.Put(0, 3);                      // One channel
+    info.Put(15, 5);                     // 16 bits per sample
+    info.Put(samples.size(), 36);
+    for (int i = 0; i < 16; ++i) info.Put(0, 8);   // No MD5
+    out.insert(out.end(), info.bytes.begin(), info.bytes.end());
+
+    uint64_t frameNumber = 0;
+    for (size_t start = 0; start < samples.size(); start += BLOCK, ++frameNumber) {
+        size_t count = std::min(BLOCK, samples.size() - start);
+
+        BitWriter frame;
+        frame.Put(0x3FFE, 14);           // Sync
+        frame.Put(0, 1);
+        frame.Put(0, 1);                 // Fixed block size
+        frame.Put(7, 4);                 // Block size in a 16-bit field after the header
+        frame.Put(0, 4);                 // Sample rate from STREAMINFO
+        frame.Put(0, 4);                 // Mono
+        frame.Put(4, 3);                 // 16 bits per sample
+        frame.Put(0, 1);
+        // Frame number, UTF-8 style
+        if (frameNumber < 0x80) {
+            frame.Put(frameNumber, 8);
+        } else {
+            int extra = 1;
+            while (extra < 6 && frameNumber >= (uint64_t(1) << (6 + 5 * extra))) extra++;
+            frame.Put(((0xFF00 >> (extra + 1)) & 0xFF) | (frameNumber >> (6 * extra)), 8);
+            for (int i = extra - 1; i >= 0; --i) frame.Put(0x80 | ((frameNumber >> (6 * i)) & 0x3F), 8);
+        }
+        frame.Put(count - 1, 16);
+        frame.Put(Crc8(frame.bytes.data(), frame.bytes.size()), 8);
+
+        frame.Put(0, 1);
+        frame.Put(1, 6);                 // VERBATIM subframe
+        frame.Put(0, 1);
+        for (size_t i = 0; i < count; ++i) frame.Put(static_cast<uint16_t>(samples[start + i]), 16);
+        frame.Put(Crc16(frame.bytes.data(), frame.bytes.size()), 16);
+
+        out.insert(out.end(), frame.bytes.begin(), frame.bytes.end());
+    }
+    return out;
+}
+
+// The lossy formats would need a real encoder for a tone; they carry valid
+// silence of the same length instead, which is enough to exercise downloads,
+// decoding and playback timing
+
+// MPEG-2 Layer III, 24 kHz mono 32 kbps: header plus zeroed side info decodes as silence
+static std::vector<uint8_t> EncodeSilentMp3(double seconds) {
+    const size_t FRAME_BYTES = 96;       // 72 * 32000 / 24000
+    size_t frames = static_cast<size_t>(std::ceil(seconds * 24000 / 576));
+    std::vector<uint8_t> out;
+    out.reserve(frames * FRAME_BYTES);
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t header[4] = { 0xFF, 0xF3, 0x44, 0xC0 };
+        out.insert(out.end(), header, header + 4);
+        out.resize(out.size() + FRAME_BYTES - 4, 0);
+    }
+    return out;
+}
+
+// AAC-LC in ADTS, 24 kHz mono: each frame a single channel element with no spectral data
+static std::vector<uint8_t> EncodeSilentAac(double seconds) {
+    size_t frames = static_cast<size_t>(std::ceil(seconds * 24000 / 1024));
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i < frames; ++i) {
+        BitWriter frame;
+        frame.Put(0xFFF, 12);            // Sync
+        frame.Put(0, 1);                 // MPEG-4
+        frame.Put(0, 2);
+        frame.Put(1, 1);                 // No CRC
+        frame.Put(1, 2);                 // AAC-LC
+        frame.Put(6, 4);                 // 24 kHz
+        frame.Put(0, 1);
+        frame.Put(1, 3);                 // Mono
+        frame.Put(0, 4);
+        frame.Put(7 + 4, 13);            // Frame length including this header
+        frame.Put(0x7FF, 11);            // Variable bitrate
+        frame.Put(0, 2);                 // One raw data block
+
+        frame.Put(0, 3);                 // Single channel element
+        frame.Put(0, 4);
+        frame.Put(100, 8);               // Global gain
+        frame.Put(0, 11);                // Long window, no scale factor bands, no prediction
+        frame.Put(0, 3);                 // No pulse, TNS or gain control data
+        frame.Put(7, 3);                 // End element, which ends on a byte boundary
+        out.insert(out.end(), frame.bytes.begin(), frame.bytes.end());
+    }
+    return out;
+}
+
+static uint32_t OggCrc(const uint8_t* data, size_t size) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint32_t>(data[i]) << 24;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+    }
+    return crc;
+}
+
+static void AppendOggPage(std::vector<uint8_t>& out, const std::vector<std::vector<uint8_t>>& packets,
+    uint8_t flags, uint64_t granule, uint32_t sequence) {
+    std::vector<uint8_t> page;
+    AppendBytes(page, "OggS", 4);
+    page.push_back(0);
+    page.push_back(flags);
+    AppendLE(page, granule, 8);
+    AppendLE(page, 0x53544E44, 4);       // Stream serial
+    AppendLE(page, sequence, 4);
+    AppendLE(page, 0, 4);                // CRC, filled in below
+    size_t segmentsAt = page.size();
+    page.push_back(0);
+    for (const auto& packet : packets) {
+        size_t left = packet.size();
+        do {
+            uint8_t lace = static_cast<uint8_t>(std::min<size_t>(left, 255));
+            page.push_back(lace);
+            page[segmentsAt]++;
+            left -= lace;
+            if (lace < 255) break;
+        } while (true);
+    }
+    for (const auto& packet : packets) page.insert(page.end(), packet.begin(), packet.end());
+
+    uint32_t crc = OggCrc(page.data(), page.size());
+    for (int i = 0; i < 4; ++i) page[22 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    out.insert(out.end(), page.begin(), page.end());
+}
+
+// Ogg Opus, mono: 20 ms CELT frames of digital silence
+static std::vector<uint8_t> EncodeSilentOpus(double seconds, uint32_t inputRate) {
+    const uint64_t PRE_SKIP = 312;
+    const size_t PACKETS_PER_PAGE = 50;
+    std::vector<uint8_t> out;
+
+    std::vector<uint8_t> head;
+    AppendBytes(head, "OpusHead", 8);
+    head.push_back(1);                   // Version
+    head.push_back(1);                   // Channels
+    AppendLE(head, PRE_SKIP, 2);
+    AppendLE(head, inputRate, 4);
+    AppendLE(head, 0, 2);                // Output gain
+    head.push_back(0);                   // Mapping family
+    AppendOggPage(out, { head }, 0x02, 0, 0);
+
+    std::vector<uint8_t> tags;
+    const char vendor[] = "tts_standin";
+    AppendBytes(tags, "OpusTags", 8);
+    AppendLE(tags, sizeof(vendor) - 1, 4);
+    AppendBytes(tags, vendor, sizeof(vendor) - 1);
+    AppendLE(tags, 0, 4);
+    AppendOggPage(out, { tags }, 0, 0, 1);
+
+    uint64_t total = PRE_SKIP + static_cast<uint64_t>(seconds * 48000);
+    size_t packets = static_cast<size_t>((total + 959) / 960);
+    uint32_t sequence = 2;
+    for (size_t first = 0; first < packets; first += PACKETS_PER_PAGE) {
+        size_t count = std::min(PACKETS_PER_PAGE, packets - first);
+        std::vector<std::vector<uint8_t>> page(count, std::vector<uint8_t>{ 0xF8, 0xFF, 0xFE });
+        bool last = first + count == packets;
+        uint64_t granule = last ? total : (first + count) * 960;
+        AppendOggPage(out, page, last ? 0x04 : 0, granule, sequence++);
+    }
+    return out;
+}
+
+// Audio for text in format; false for a format the real API doesn't have either
+static bool SynthesizeAudio(const std::string& text, const std::string& format, const Stage& stage,
+    std::vector<uint8_t>& audio) {
+    uint32_t rate = (format == "pcm") ? 24000 : stage.sampleRate;   // OpenAI's pcm is always 24 kHz
+    std::vector<int16_t> samples = SynthesizePcm(text, stage, rate);
+    double seconds = double(samples.size()) / rate;
+
+    if (format == "pcm") audio = EncodePcm(samples);
+    else if (format == "wav") audio = EncodeWav(samples, rate);
+    else if (format == "flac") audio = EncodeFlac(samples, rate);
+    else if (format == "mp3") audio = EncodeSilentMp3(seconds);
+    else if (format == "aac") audio = EncodeSilentAac(seconds);
+    else if (format == "opus") audio = EncodeSilentOpus(seconds, rate);
+    else return false;
+    return true;
+}
+
+static const char* ContentType(const std::string& format) {
+    if (format == "mp3") return "audio/mpeg";
+    if (format == "opus") return "audio/ogg";
+    if (format == "aac") return "audio/aac";
+    if (format == "flac") return "audio/flac";
+    if (format == "wav") return "audio/wav";
+    return "audio/pcm";
+}
+
+static std::string Base64(const uint8_t* data, size_t size) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t block = uint32_t(data[i]) << 16;
+        if (i + 1 < size) block |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) block |= data[i + 2];
+        out += ALPHABET[(block >> 18) & 63];
+        out += ALPHABET[(block >> 12) & 63];
+        out += i + 1 < size ? ALPHABET[(block >> 6) & 63] : '=';
+        out += i + 2 < size ? ALPHABET[block & 63] : '=';
+    }
+    return out;
+}
+
+// stream_format=sse: the audio as speech.audio.delta events of chunkBytes each
+static std::vector<uint8_t> EncodeSse(const std::vector<uint8_t>& audio, size_t chunkBytes) {
+    std::string events;
+    for (size_t start = 0; start < audio.size(); start += chunkBytes) {
+        size_t count = std::min(chunkBytes, audio.size() - start);
+        events += "data: {\"type\":\"speech.audio.delta\",\"audio\":\"" + Base64(audio.data() + start, count) + "\"}\n\n";
+    }
+    events += "data: {\"type\":\"speech.audio.done\"}\n\n";
+    return std::vector<uint8_t>(events.begin(), events.end());
+}
+
+// ============================================================
+// HTTP
+// ============================================================
+
+// Value of a string field in the request JSON, unescaped; \u escapes outside ASCII become '?'
+static bool JsonStringField(const std::string& json, const char* name, std::string& value) {
+    std::string key = std::string("\"") + name + "\"";
+    size_t pos = json.find(key);
+    if (pos == std::string::npos) return false;
+    pos = json.find_first_not_of(" \t\r\n", pos + key.size());
+    if (pos == std::string::npos || json[pos] != ':') return false;
+    pos = json.find_first_not_of(" \t\r\n", pos + 1);
+    if (pos == std::string::npos || json[pos] != '"') return false;
+
+    value.clear();
+    for (++pos; pos < json.size(); ++pos) {
+        char c = json[pos];
+        if (c == '"') return true;
+        if (c != '\\' || pos + 1 >= json.size()) {
+            value += c;
+            continue;
+        }
+        char escaped = json[++pos];
+        switch (escaped) {
+        case 'n': value += '\n'; break;
+        case 't': value += '\t'; break;
+        case 'r': value += '\r'; break;
+        case 'b': case 'f': value += ' '; break;
+        case 'u': {
+            unsigned long code = strtoul(json.substr(pos + 1, 4).c_str(), nullptr, 16);
+            value += code < 0x80 ? static_cast<char>(code) : '?';
+            pos += 4;
+            break;
+        }
+        default: value += escaped; break;
+        }
+    }
+    return false;
+}
+
+struct IncomingRequest {
+    std::string method;
+    std::string path;
+    std::string body;
+    bool keepAlive = true;
+};
+
+static bool SendAll(SocketHandle s, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        int sent = send(s, bytes, static_cast<int>(std::min<size_t>(size, 1 << 20)), SEND_FLAGS);
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Read one request from a keep-alive connection; false when the client is done or broke off
+static bool ReadRequest(SocketHandle s, std::string& buffer, IncomingRequest& request) {
+    size_t headEnd;
+    while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > 64 * 1024) return false;
+        char block[4096];
+        int received = recv(s, block, sizeof(block), 0);
+        if (received <= 0) return false;
+        buffer.append(block, static_cast<size_t>(received));
+    }
+
+    std::string head = buffer.substr(0, headEnd);
+    buffer.erase(0, headEnd + 4);
+
+    std::istringstream lines(head);
+    std::string line;
+    std::getline(lines, line);
+    std::istringstream requestLine(line);
+    std::string version;
+    requestLine >> request.method >> request.path >> version;
+    request.keepAlive = version != "HTTP/1.0";
+
+    size_t contentLength = 0;
+    while (std::getline(lines, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = Trim(line.substr(0, colon));
+        std::string value = Trim(line.substr(colon + 1));
+        if (EqualsIgnoreCase(name, "content-length")) {
+            contentLength = strtoull(value.c_str(), nullptr, 10);
+        } else if (EqualsIgnoreCase(name, "connection")) {
+            request.keepAlive = !ContainsIgnoreCase(value, "close");
+        }
+    }
+    if (contentLength > 16 * 1024 * 1024) return false;
+
+    while (buffer.size() < contentLength) {
+        char block[16384];
+        int received = recv(s, block, sizeof(block), 0);
+        if (received <= 0) return false;
+        buffer.append(block, static_cast<size_t>(received));
+    }
+    request.body = buffer.substr(0, contentLength);
+    buffer.erase(0, contentLength);
+    return !request.method.empty();
+}
+
+static bool SendSimple(SocketHandle s, int status, const char* reason, const std::string& extraHeaders,
+    const std::string& body, bool keepAlive) {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n" + extraHeaders + "\r\n" + body;
+    return SendAll(s, response.data(), response.size());
+}
+
+static std::string ErrorJson(const char* type, const char* message) {
+    return std::string("{\"error\":{\"message\":\"") + message + "\",\"type\":\"" + type + "\"}}";
+}
+
+// Make closing the socket reset the connection instead of ending it in order
+static void ArmReset(SocketHandle s) {
+    linger hard = {};
+    hard.l_onoff = 1;
+    hard.l_linger = 0;
+    setsockopt(s, SOL_SOCKET, SO_LINGER, reinterpret_cast<const char*>(&hard), sizeof(hard));
+}
+
+// ============================================================
+// SERVER
+// ============================================================
+
+enum class Fault { None, Status429, Status500, Status503, ResetBeforeHeaders, ResetMidBody, Truncate };
+
+static const char* FaultName(Fault fault) {
+    switch (fault) {
+    case Fault::Status429: return "429";
+    case Fault::Status500: return "500";
+    case Fault::Status503: return "503";
+    case Fault::ResetBeforeHeaders: return "reset before headers";
+    case Fault::ResetMidBody: return "reset mid-body";
+    case Fault::Truncate: return "truncated";
+    default: return "ok";
+    }
+}
+
+// What the next speech request gets, drawn in arrival order from one seeded generator
+struct Plan {
+    const Stage* stage = nullptr;
+    uint64_t number = 0;
+    Fault fault = Fault::None;
+    double ttfbMs = 0;
+    double cutAt = 1.0;   // Share of the body sent before a truncation or reset
+};
+
+class StandinServer {
+private:
+    std::vector<Stage> stages;
+    std::mt19937 rng;
+    std::mutex planMutex;
+    std::mutex printMutex;
+    uint64_t speechRequests = 0;
+    size_t currentStage = 0;
+    bool quiet;
+
+    const Stage& StageFor(uint64_t number, uint64_t& indexInStage) {
+        uint64_t start = 0;
+        for (size_t i = 0; i < stages.size(); ++i) {
+            bool last = i + 1 == stages.size();
+            if (last || stages[i].requests == 0 || number < start + stages[i].requests) {
+                if (i != currentStage) {
+                    currentStage = i;
+                    Print("--- stage \"" + stages[i].name + "\" from request " + std::to_string(number + 1) + " ---");
+                }
+                indexInStage = number - start;
+                return stages[i];
+            }
+            start += stages[i].requests;
+        }
+        indexInStage = number;
+        return stages.back();
+    }
+
+public:
+    StandinServer(std::vector<Stage> profile, uint32_t seed, bool quiet)
+        : stages(std::move(profile)), rng(seed), quiet(quiet) {}
+
+    void Print(const std::string& text) {
+        if (quiet) return;
+        std::lock_guard<std::mutex> lock(printMutex);
+        printf("%s\n", text.c_str());
+        fflush(stdout);
+    }
+
+    Plan Next(size_t chars) {
+        std::lock_guard<std::mutex> lock(planMutex);
+        Plan plan;
+        uint64_t index;
+        plan.number = ++speechRequests;
+        plan.stage = &StageFor(plan.number - 1, index);
+        const Stage& stage = *plan.stage;
+
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        plan.ttfbMs = std::max(0.0, stage.ttfb.Sample(rng)) + stage.msPerChar * chars;
+        plan.cutAt = 0.2 + 0.6 * chance(rng);
+
+        // Every draw is made even when an earlier one decides, so one knob
+        // doesn't shift the random sequence the others see
+        double roll429 = chance(rng), roll500 = chance(rng), roll503 = chance(rng);
+        double rollReset = chance(rng), rollTruncate = chance(rng), rollWhere = chance(rng);
+
+        if (stage.burst429Every > 0 && index % stage.burst429Every < stage.burst429Length) plan.fault = Fault::Status429;
+        else if (roll429 < stage.rate429) plan.fault = Fault::Status429;
+        else if (roll500 < stage.rate500) plan.fault = Fault::Status500;
+        else if (roll503 < stage.rate503) plan.fault = Fault::Status503;
+        else if (rollReset < stage.resetRate) plan.fault = rollWhere < 0.5 ? Fault::ResetBeforeHeaders : Fault::ResetMidBody;
+        else if (rollTruncate < stage.truncateRate) plan.fault = Fault::Truncate;
+        return plan;
+    }
+
+    // Returns false if the connection must be closed
+    bool HandleSpeech(SocketHandle s, const IncomingRequest& request) {
+        std::string input, format = "mp3", streamFormat = "audio";
+        if (!JsonStringField(request.body, "input", input)) {
+            return SendSimple(s, 400, "Bad Request", "", ErrorJson("invalid_request_error", "input is required"),
+                request.keepAlive);
+        }
+        JsonStringField(request.body, "response_format", format);
+        JsonStringField(request.body, "stream_format", streamFormat);
+
+        size_t chars = 0;
+        for (unsigned char c : input) chars += (c & 0xC0) != 0x80;
+        Plan plan = Next(chars);
+        const Stage& stage = *plan.stage;
+        bool keepAlive = request.keepAlive && stage.keepAlive;
+
+        auto started = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(plan.ttfbMs * 1000)));
+        auto log = [&](const std::string& outcome, size_t bytes) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+            Print("#" + std::to_string(plan.number) + " [" + stage.name + "] " + format +
+                (streamFormat == "sse" ? "/sse" : "") + ", " + std::to_string(chars) + " chars: " + outcome +
+                ", ttfb " + std::to_string(static_cast<int64_t>(plan.ttfbMs)) + " ms, " + std::to_string(bytes) +
+                " bytes in " + std::to_string(elapsed.count()) + " ms");
+        };
+
+        std::string retryAfter = stage.retryAfterSeconds > 0
+            ? "Retry-After: " + std::to_string(stage.retryAfterSeconds) + "\r\n" : std::string();
+        switch (plan.fault) {
+        case Fault::Status429:
+            log(FaultName(plan.fault), 0);
+            return SendSimple(s, 429, "Too Many Requests", retryAfter,
+                ErrorJson("rate_limit_exceeded", "Rate limit reached (tts_standin)"), keepAlive) && keepAlive;
+        case Fault::Status500:
+            log(FaultName(plan.fault), 0);
+            return SendSimple(s, 500, "Internal Server Error", "",
+                ErrorJson("server_error", "Synthesis failed (tts_standin)"), keepAlive) && keepAlive;
+        case Fault::Status503:
+            log(FaultName(plan.fault), 0);
+            return SendSimple(s, 503, "Service Unavailable", retryAfter,
+                ErrorJson("server_error", "Overloaded (tts_standin)"), keepAlive) && keepAlive;
+        case Fault::ResetBeforeHeaders:
+            log(FaultName(plan.fault), 0);
+            ArmReset(s);
+            return false;
+        default:
+            break;
+        }
+
+        std::vector<uint8_t> audio;
+        if (!SynthesizeAudio(input, format, stage, audio)) {
+            log("unsupported format", 0);
+            return SendSimple(s, 400, "Bad Request", "",
+                ErrorJson("invalid_request_error", "Unsupported response_format"), keepAlive) && keepAlive;
+        }
+
+        bool sse = streamFormat == "sse";
+        std::vector<uint8_t> body = sse ? EncodeSse(audio, stage.chunkBytes) : audio;
+        // SSE is always streamed; close-delimited bodies can't be followed by another request
+        Transfer transfer = sse ? Transfer::Chunked : stage.transfer;
+        if (transfer == Transfer::Close) keepAlive = false;
+
+        std::string head = "HTTP/1.1 200 OK\r\nContent-Type: ";
+        head += sse ? "text/event-stream" : ContentType(format);
+        head += "\r\n";
+        if (transfer == Transfer::Length) head += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        if (transfer == Transfer::Chunked) head += "Transfer-Encoding: chunked\r\n";
+        head += std::string("Connection: ") + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+        if (!SendAll(s, head.data(), head.size())) return false;
+
+        bool cut = plan.fault == Fault::Truncate || plan.fault == Fault::ResetMidBody;
+        size_t limit = cut ? static_cast<size_t>(body.size() * plan.cutAt) : body.size();
+
+        // Paced in chunkBytes blocks, each a chunk of its own with chunked transfer
+        auto bodyStart = std::chrono::steady_clock::now();
+        size_t sent = 0;
+        while (sent < limit) {
+            size_t count = std::min(stage.chunkBytes, limit - sent);
+            if (transfer == Transfer::Chunked) {
+                char size[32];
+                snprintf(size, sizeof(size), "%zx\r\n", count);
+                if (!SendAll(s, size, strlen(size))) return false;
+            }
+            if (!SendAll(s, body.data() + sent, count)) return false;
+            if (transfer == Transfer::Chunked && !SendAll(s, "\r\n", 2)) return false;
+            sent += count;
+
+            if (stage.bytesPerSecond > 0) {
+                auto due = bodyStart + std::chrono::microseconds(sent * 1000000 / stage.bytesPerSecond);
+                std::this_thread::sleep_until(due);
+            }
+        }
+
+        if (cut) {
+            log(FaultName(plan.fault), sent);
+            if (plan.fault == Fault::ResetMidBody) {
+                ArmReset(s);
+            }
+            return false;
+        }
+        if (transfer == Transfer::Chunked && !SendAll(s, "0\r\n\r\n", 5)) return false;
+        log(FaultName(plan.fault), sent);
+        return keepAlive;
+    }
+
+    void ServeConnection(SocketHandle s) {
+        std::string buffer;
+        IncomingRequest request;
+        bool open = true;
+        while (open && ReadRequest(s, buffer, request)) {
+            bool speech = request.method == "POST" && request.path.size() >= 13 &&
+                request.path.compare(request.path.size() - 13, 13, "/audio/speech") == 0;
+            bool models = request.method == "GET" && request.path.size() >= 7 &&
+                request.path.compare(request.path.size() - 7, 7, "/models") == 0;
+
+            if (speech) {
+                open = HandleSpeech(s, request);
+            } else if (models) {
+                open = SendSimple(s, 200, "OK", "",
+                    "{\"object\":\"list\",\"data\":[{\"id\":\"tts-1\",\"object\":\"model\"},"
+                    "{\"id\":\"gpt-4o-mini-tts\",\"object\":\"model\"}]}", request.keepAlive) && request.keepAlive;
+            } else {
+                open = SendSimple(s, 404, "Not Found", "", ErrorJson("invalid_request_error", "Unknown path"),
+                    request.keepAlive) && request.keepAlive;
+            }
+        }
+        CloseSocket(s);
+    }
+};
+
+int main(int argc, char** argv) {
+    uint16_t port = 8880;
+    const char* profilePath = nullptr;
+    uint32_t seed = 1;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) port = static_cast<uint16_t>(atoi(argv[++i]));
+        else if (arg == "--profile" && i + 1 < argc) profilePath = argv[++i];
+        else if (arg == "--seed" && i + 1 < argc) seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--quiet") quiet = true;
+        else {
+            fprintf(stderr, "Usage: tts_standin [--port 8880] [--profile file] [--seed n] [--quiet]\n");
+            return 2;
+        }
+    }
+
+    std::vector<Stage> stages;
+    if (!profilePath) {
+        stages.push_back(Stage());
+    } else if (!LoadProfile(profilePath, stages)) {
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        fprintf(stderr, "WSAStartup failed\n");
+        return 1;
+    }
+#endif
+
+    SocketHandle listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (listener == BAD_SOCKET || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 64) != 0) {
+        fprintf(stderr, "Can't listen on 127.0.0.1:%u (error %d)\n", port, LastSocketError());
+        return 1;
+    }
+
+    StandinServer server(stages, seed, quiet);
+    printf("tts_standin on http://127.0.0.1:%u/v1, seed %u\n", port, seed);
+    for (const Stage& stage : stages) {
+        printf("  stage \"%s\": %s\n", stage.name.c_str(),
+            stage.requests > 0 ? (std::to_string(stage.requests) + " requests").c_str() : "until the end");
+    }
+    fflush(stdout);
+
+    while (true) {
+        SocketHandle client = accept(listener, nullptr, nullptr);
+        if (client == BAD_SOCKET) {
+            continue;
+        }
+        int noDelay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        std::thread([&server, client]() { server.ServeConnection(client); }).detach();
+    }
+}
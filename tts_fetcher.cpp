@@ -21,142 +21,406 @@
 // SOFTWARE.
 
 #include "tts_fetcher.h"
+#include "http_transport.h"
+#include "socket_event_loop.h"
+#include "sse_audio_parser.h"
+#include "response_body.h"
+#include "speech_request.h"
+#include "audio_cache.h"
+#include "retry_policy.h"
+#include "cancellation.h"
+#include "backend_pool.h"
+#include "request_timing.h"
+#include "fetch_thread_pool.h"
 #include "config.h"
 #include "utils.h"
 #include "logger.h"
 
-#include <sstream>
-#include <iomanip>
-
-std::vector<uint8_t> FetchTTSAudioWithRetry(const std::string& text, int maxRetries) {
-    std::ostringstream jsonBody;
-    jsonBody << "{"
-        << "\"model\":\"" << EscapeJSON(g_config.model) << "\","
-        << "\"input\":\"" << EscapeJSON(text) << "\","
-        << "\"voice\":\"" << EscapeJSON(g_config.voice) << "\","
-        << "\"response_format\":\"" << EscapeJSON(g_config.format) << "\""
-        << "}";
-
-    std::string jsonString = jsonBody.str();
-    std::string fullUrl = std::string(g_config.server) + "/audio/speech";
-
-    for (int attempt = 0; attempt < maxRetries; ++attempt) {
-        if (attempt > 0) {
-            LOG_INFO(L"Retry attempt " + std::to_wstring(attempt + 1) + L" of " + std::to_wstring(maxRetries));
-            // Proper exponential backoff
-            DWORD delayMs = 500 * (1 << attempt); // 500ms, 1000ms, 2000ms
-            Sleep(delayMs);
+#include <chrono>
+#include <algorithm>
+
+// Read window grows while reads come back full, so large bodies need few calls
+static constexpr size_t INITIAL_READ_SIZE = 16 * 1024;
+static constexpr size_t MAX_READ_SIZE = 256 * 1024;
+
+// Only the start of an error body is logged
+static constexpr size_t MAX_ERROR_TEXT = 1024;
+
+// Request for one synthesis call; false (with the outcome in result) if it must not be sent
+// The body points into a per-thread buffer that the next call on this thread overwrites
+static bool PrepareSpeechRequest(const Backend& backend, const std::string& text, CancellationToken* cancel,
+    HttpRequest& request, FetchResult& result) {
+    // Per-thread builder, so the request body buffer is reused between fetches
+    static thread_local SpeechRequestBuilder requestBuilder;
+    const std::string& jsonString = requestBuilder.Build(backend.model, backend.voice, text);
+    std::string fullUrl = backend.url + "/audio/speech";
+
+    if (!ParseHttpUrl(fullUrl, request)) {
+        LOG_ERROR(L"Failed to parse URL");
+        return false;
+    }
+
+    request.headers = "Content-Type: application/json\r\n";
+    if (!backend.apiKey.empty()) {
+        request.headers += "Authorization: Bearer " + backend.apiKey + "\r\n";
+    }
+    request.body = jsonString.data();
+    request.bodySize = jsonString.size();
+    request.cancel = cancel;
+
+    if (!backend.breaker->AllowRequest()) {
+        LOG_DEBUG(L"Circuit open for " + std::wstring(request.host.begin(), request.host.end()) + L", failing fast");
+        result.outcome = FetchOutcome::CircuitOpen;
+        return false;
+    }
+
+    LOG_DEBUG(L"Connecting to: " + std::wstring(fullUrl.begin(), fullUrl.end()));
+    return true;
+}
+
+// No response came back
+static void HandleSendFailure(CircuitBreaker& breaker, CancellationToken* cancel, const std::wstring& error,
+    FetchResult& result) {
+    if (cancel && cancel->IsCancelled()) {
+        LOG_DEBUG(L"Request cancelled before the response arrived");
+        breaker.RecordCancelled();
+        result.outcome = FetchOutcome::Aborted;
+        return;
+    }
+    LOG_ERROR(error);
+    breaker.RecordFailure();
+    result.outcome = FetchOutcome::RetryableError;
+}
+
+// A status other than 200; errorText is the start of the error body
+static void HandleErrorStatus(CircuitBreaker& breaker, const std::string& errorText, const std::string& retryAfter,
+    FetchResult& result) {
+    LOG_ERROR(L"Server returned status code: " + std::to_wstring(result.statusCode));
+    if (!errorText.empty()) {
+        LOG_ERROR(L"Server error response: " + std::wstring(errorText.begin(), errorText.end()));
+    }
+
+    // 429 and 503 say when to come back
+    if (ParseRetryAfter(retryAfter, result.retryAfter)) {
+        LOG_DEBUG(L"Server asked to retry after " + std::to_wstring(result.retryAfter.count()) + L" ms");
+    }
+
+    if (result.statusCode >= 500) {
+        breaker.RecordFailure();
+        result.outcome = FetchOutcome::RetryableError;
+    } else {
+        // The server is up and answering; only rate limiting and timeouts are worth retrying
+        breaker.RecordSuccess();
+        result.outcome = (result.statusCode == 429 || result.statusCode == 408)
+            ? FetchOutcome::RetryableError : FetchOutcome::PermanentError;
+    }
+}
+
+// Settle a 200 response once its body has ended; true if the body arrived complete
+static bool HandleAudioBody(CircuitBreaker& breaker, CancellationToken* cancel, const SseAudioParser* sseParser,
+    bool aborted, bool readOk, bool hadConsumer, std::vector<uint8_t> audioData,
+    std::chrono::steady_clock::time_point bodyStart, FetchResult& result) {
+    result.chunksDelivered = hadConsumer && !audioData.empty();
+
+    if (cancel && cancel->IsCancelled()) {
+        LOG_DEBUG(L"Request cancelled after " + std::to_wstring(audioData.size()) + L" bytes");
+        breaker.RecordCancelled();
+        result.outcome = FetchOutcome::Aborted;
+        return false;
+    }
+
+    if (sseParser && sseParser->HasError()) {
+        breaker.RecordFailure();
+        result.outcome = FetchOutcome::RetryableError;
+        return false;
+    }
+
+    if (aborted) {
+        LOG_DEBUG(L"Download aborted by consumer after " + std::to_wstring(audioData.size()) + L" bytes");
+        breaker.RecordSuccess();
+        result.outcome = FetchOutcome::Aborted;
+        return false;
+    }
+
+    // A connection dropped mid-body must not be cached as a complete clip
+    if (!readOk) {
+        LOG_ERROR(L"Connection lost after " + std::to_wstring(audioData.size()) + L" bytes of audio");
+        breaker.RecordFailure();
+        result.outcome = FetchOutcome::RetryableError;
+        return false;
+    }
+
+    if (sseParser) {
+        if (!sseParser->IsDone()) {
+            LOG_WARNING(L"Event stream ended without speech.audio.done");
         }
+        LOG_DEBUG(L"Decoded " + std::to_wstring(sseParser->DeltaCount()) + L" SSE audio deltas");
+    }
+
+    breaker.RecordSuccess();
 
-        LOG_DEBUG(L"Connecting to: " + std::wstring(fullUrl.begin(), fullUrl.end()));
+    auto bodyMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bodyStart).count();
+    LOG_INFO(L"Downloaded " + std::to_wstring(audioData.size()) + L" bytes of audio");
+    LOG_DEBUG(L"Body received in " + std::to_wstring(bodyMs) + L" ms (" +
+        std::to_wstring(bodyMs > 0 ? audioData.size() / 1024 * 1000 / bodyMs : 0) + L" KB/s)");
 
-        InternetHandle hInternet(InternetOpenA("StellarTTS/1.0", INTERNET_OPEN_TYPE_DIRECT, NULL, NULL, 0));
-        if (!hInternet) {
-            LOG_ERROR(L"Failed to initialize WinINet: " + GetWindowsErrorMessage(GetLastError()));
-            continue;
+    result.outcome = audioData.empty() ? FetchOutcome::RetryableError : FetchOutcome::Success;
+    result.audio = std::move(audioData);
+    result.bodyTime = std::chrono::milliseconds(bodyMs);
+    return true;
+}
+
+FetchResult FetchTTSAudioOnce(const Backend& backend, const std::string& text,
+    const AudioChunkCallback& onChunk, CancellationToken* cancel, CacheFileWriter* diskCopy) {
+    FetchResult result;
+
+    HttpRequest request;
+    if (!PrepareSpeechRequest(backend, text, cancel, request, result)) {
+        return result;
+    }
+
+    CircuitBreaker& breaker = *backend.breaker;
+    HttpTransport& transport = GetHttpTransport();
+
+    // Declared before the response, which the transport may still report to until destroyed
+    HttpTimings timings;
+    request.timings = &timings;
+
+    auto sendStart = std::chrono::steady_clock::now();
+    timings.start = sendStart;
+    std::wstring sendError;
+    std::unique_ptr<HttpResponse> response = transport.Send(request, sendError);
+    if (!response) {
+        HandleSendFailure(breaker, cancel, sendError, result);
+        return result;
+    }
+
+    result.responseTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - sendStart);
+    auto headersMs = result.responseTime.count();
+    LOG_DEBUG(L"Response headers after " + std::to_wstring(headersMs) + L" ms (" + transport.Name() + L", " +
+        (response->ConnectionReused() ? L"reused session" : L"new session") + L")");
+
+    result.statusCode = response->StatusCode();
+
+    if (result.statusCode != 200) {
+        uint8_t errorBuffer[MAX_ERROR_TEXT];
+        size_t errorBytesRead = 0;
+        std::string errorText;
+        if (response->Read(errorBuffer, sizeof(errorBuffer), errorBytesRead) && errorBytesRead > 0) {
+            errorText.assign(reinterpret_cast<char*>(errorBuffer), errorBytesRead);
         }
+        MarkPhase(&timings, &HttpTimings::lastByte);
+        g_requestTimings.Record(backend.name, text.size(), result.statusCode, response->ConnectionReused(), timings);
+        HandleErrorStatus(breaker, errorText, response->Header("Retry-After"), result);
+        return result;
+    }
+
+    // Servers that ignore stream_format just send plain audio, so go by Content-Type
+    bool isSse = response->Header("Content-Type").compare(0, 17, "text/event-stream") == 0;
+    uint64_t contentLength = response->ContentLength();
 
-        DWORD dwTimeout = 15000;
-        InternetSetOptionA(hInternet, INTERNET_OPTION_CONNECT_TIMEOUT, &dwTimeout, sizeof(DWORD));
-        dwTimeout = 30000;
-        InternetSetOptionA(hInternet, INTERNET_OPTION_RECEIVE_TIMEOUT, &dwTimeout, sizeof(DWORD));
-
-        URL_COMPONENTSA urlComp = { sizeof(URL_COMPONENTSA) };
-        char hostname[256] = { 0 };
-        char urlPath[1024] = { 0 };
-        urlComp.lpszHostName = hostname;
-        urlComp.dwHostNameLength = sizeof(hostname);
-        urlComp.lpszUrlPath = urlPath;
-        urlComp.dwUrlPathLength = sizeof(urlPath);
-
-        if (!InternetCrackUrlA(fullUrl.c_str(), 0, 0, &urlComp)) {
-            LOG_ERROR(L"Failed to parse URL");
-            continue;
+    // One receive buffer per fetch worker, so its blocks are reused between responses
+    static thread_local ResponseBody body;
+    static thread_local std::vector<uint8_t> sseScratch;
+
+    bool knownLength = !isSse && contentLength > 0 && contentLength < 50 * 1024 * 1024; // Sanity check: < 50MB
+    body.Reset(knownLength ? static_cast<size_t>(contentLength) : 0);
+
+    auto deliver = [&onChunk, diskCopy](const uint8_t* data, size_t size) {
+        body.Append(data, size);
+        if (diskCopy) {
+            diskCopy->Write(data, size);
         }
+        return !onChunk || onChunk(data, size);
+    };
+    SseAudioParser sseParser(deliver);
 
-        InternetHandle hSession(InternetConnectA(hInternet, hostname, urlComp.nPort,
-            NULL, NULL, INTERNET_SERVICE_HTTP, 0, 0));
+    // A blocking Read waits for the whole buffer to fill, so when
+    // someone is consuming chunks read only what has arrived
+    bool incremental = isSse || onChunk;
+    auto bodyStart = std::chrono::steady_clock::now();
+    size_t readWindow = INITIAL_READ_SIZE;
+    size_t bytesRead = 0;
+    size_t available = 0;
+    bool readOk = true;
+    bool aborted = false;
 
-        if (!hSession) {
-            LOG_ERROR(L"Failed to create session: " + GetWindowsErrorMessage(GetLastError()));
-            continue;
+    while (true) {
+        size_t toRead = readWindow;
+        if (incremental) {
+            if (!(readOk = response->QueryAvailable(available)) || available == 0) {
+                break;
+            }
+            toRead = std::min(available, readWindow);
         }
 
-        DWORD flags = INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE;
-        if (urlComp.nScheme == INTERNET_SCHEME_HTTPS) {
-            flags |= INTERNET_FLAG_SECURE;
-            // Enable certificate validation
-            flags |= INTERNET_FLAG_KEEP_CONNECTION;
+        uint8_t* dest;
+        if (isSse) {
+            if (sseScratch.size() < toRead) {
+                sseScratch.resize(MAX_READ_SIZE);
+            }
+            dest = sseScratch.data();
+        } else {
+            size_t space = 0;
+            dest = body.Prepare(toRead, space);
+            toRead = std::min(toRead, space);
         }
 
-        InternetHandle hRequest(HttpOpenRequestA(hSession, "POST", urlPath, NULL, NULL, NULL, flags, 0));
+        if (!(readOk = response->Read(dest, toRead, bytesRead)) || bytesRead == 0) {
+            break;
+        }
 
-        if (!hRequest) {
-            LOG_ERROR(L"Failed to create request: " + GetWindowsErrorMessage(GetLastError()));
-            continue;
+        bool keepGoing;
+        if (isSse) {
+            keepGoing = sseParser.Feed(reinterpret_cast<const char*>(dest), bytesRead);
+        } else {
+            body.Commit(bytesRead);
+            if (diskCopy) {
+                diskCopy->Write(dest, bytesRead);
+            }
+            keepGoing = !onChunk || onChunk(dest, bytesRead);
+        }
+        if (!keepGoing) {
+            aborted = true;
+            break;
         }
 
-        std::string headers = "Content-Type: application/json\r\n";
-        if (!g_config.ApiKeyEmpty()) {
-            headers += "Authorization: Bearer " + std::string(g_config.api_key) + "\r\n";
+        if (bytesRead == toRead && readWindow < MAX_READ_SIZE) {
+            readWindow *= 2;
         }
+    }
 
-        BOOL result = HttpSendRequestA(hRequest, headers.c_str(), headers.length(),
-            (LPVOID)jsonString.c_str(), jsonString.length());
+    MarkPhase(&timings, &HttpTimings::lastByte);
+    g_requestTimings.Record(backend.name, text.size(), result.statusCode, response->ConnectionReused(), timings);
 
-        if (!result) {
-            DWORD error = GetLastError();
-            LOG_ERROR(L"Failed to send request: " + GetWindowsErrorMessage(error));
-            continue;
-        }
+    // Only a fully drained response leaves the connection reusable
+    if (HandleAudioBody(breaker, cancel, isSse ? &sseParser : nullptr, aborted, readOk, onChunk != nullptr,
+        body.Take(), bodyStart, result)) {
+        response->MarkComplete();
+    }
+    return result;
+}
 
-        DWORD statusCode = 0;
-        DWORD statusCodeSize = sizeof(statusCode);
-        HttpQueryInfoA(hRequest, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER,
-            &statusCode, &statusCodeSize, NULL);
+bool CanFetchAsync(const Backend& backend) {
+    return g_config.async_fetch && g_config.TransportEquals("socket") && backend.url.compare(0, 7, "http://") == 0;
+}
 
-        if (statusCode != 200) {
-            LOG_ERROR(L"Server returned status code: " + std::to_wstring(statusCode));
+// One speech request on the socket event loop
+// The callbacks run on the loop thread and only parse and buffer; the
+// result is handed to a fetch worker, since the caller may write the cache
+class AsyncSpeechFetch : public AsyncHttpHandler {
+private:
+    CircuitBreaker& breaker;
+    CancellationToken* cancel;
+    AudioChunkCallback onChunk;
+    FetchCompletion onDone;
+    AudioChunkGate canTakeChunk;
+    FetchResult result;
+    std::string server;
+    size_t chars;
+    HttpTimings timings;
+    bool reused = false;
+    std::chrono::steady_clock::time_point sendStart;
+    std::chrono::steady_clock::time_point bodyStart;
+    bool isSse = false;
+    bool aborted = false;
+    std::string errorText;
+    std::string retryAfter;
+    ResponseBody body;
+    SseAudioParser sseParser;
 
-            BYTE errorBuffer[1024];
-            DWORD errorBytesRead = 0;
-            if (InternetReadFile(hRequest, errorBuffer, sizeof(errorBuffer) - 1, &errorBytesRead) && errorBytesRead > 0) {
-                errorBuffer[errorBytesRead] = 0;
-                LOG_ERROR(L"Server error response: " + std::wstring((char*)errorBuffer, (char*)errorBuffer + errorBytesRead));
-            }
+public:
+    AsyncSpeechFetch(const Backend& backend, size_t textChars, CancellationToken* c, AudioChunkCallback chunkCallback,
+        FetchCompletion done, AudioChunkGate gate)
+        : breaker(*backend.breaker), cancel(c), onChunk(std::move(chunkCallback)), onDone(std::move(done)),
+          canTakeChunk(std::move(gate)), server(backend.name), chars(textChars), sendStart(std::chrono::steady_clock::now()),
+          sseParser([this](const uint8_t* data, size_t size) {
+              body.Append(data, size);
+              return !onChunk || onChunk(data, size);
+          }) {
+        timings.start = sendStart;
+    }
 
-            if (statusCode >= 400 && statusCode < 500) {
-                break; // Don't retry client errors
-            }
-            continue;
+    // Filled in by the event loop while the request runs
+    HttpTimings* Timings() { return &timings; }
+
+    bool OnResponse(const HttpResponseHead& head) override {
+        result.responseTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - sendStart);
+        LOG_DEBUG(L"Response headers after " + std::to_wstring(result.responseTime.count()) + L" ms (socket event loop, " +
+            (head.connectionReused ? L"reused session" : L"new session") + L")");
+
+        reused = head.connectionReused;
+        result.statusCode = head.statusCode;
+        if (result.statusCode != 200) {
+            retryAfter = head.Header("Retry-After");
+            return true;
         }
 
-        // Check Content-Length and reserve space
-        DWORD contentLength = 0;
-        DWORD contentLengthSize = sizeof(contentLength);
-        HttpQueryInfoA(hRequest, HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER,
-            &contentLength, &contentLengthSize, NULL);
+        isSse = head.Header("Content-Type").compare(0, 17, "text/event-stream") == 0;
+        bool knownLength = !isSse && head.contentLength > 0 && head.contentLength < 50 * 1024 * 1024;
+        body.Reset(knownLength ? static_cast<size_t>(head.contentLength) : 0);
+        bodyStart = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool OnBody(const uint8_t* data, size_t size) override {
+        if (result.statusCode != 200) {
+            errorText.append(reinterpret_cast<const char*>(data), std::min(size, MAX_ERROR_TEXT - errorText.size()));
+            return errorText.size() < MAX_ERROR_TEXT;
+        }
 
-        std::vector<uint8_t> audioData;
-        if (contentLength > 0 && contentLength < 50 * 1024 * 1024) { // Sanity check: < 50MB
-            audioData.reserve(contentLength);
+        bool keepGoing;
+        if (isSse) {
+            keepGoing = sseParser.Feed(reinterpret_cast<const char*>(data), size);
+        } else {
+            body.Append(data, size);
+            keepGoing = !onChunk || onChunk(data, size);
         }
+        aborted = !keepGoing;
+        return keepGoing;
+    }
 
-        BYTE buffer[4096];
-        DWORD bytesRead = 0;
+    bool ReadyForBody() override {
+        return !canTakeChunk || canTakeChunk();
+    }
 
-        while (InternetReadFile(hRequest, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
-            audioData.insert(audioData.end(), buffer, buffer + bytesRead);
+    void OnComplete(bool ok, const std::wstring& error) override {
+        if (result.statusCode != 0) {
+            MarkPhase(&timings, &HttpTimings::lastByte);
+            g_requestTimings.Record(server, chars, result.statusCode, reused, timings);
         }
 
-        LOG_INFO(L"Downloaded " + std::to_wstring(audioData.size()) + L" bytes of audio");
-        return audioData;
+        if (result.statusCode == 0) {
+            HandleSendFailure(breaker, cancel, error, result);
+        } else if (result.statusCode != 200) {
+            HandleErrorStatus(breaker, errorText, retryAfter, result);
+        } else {
+            HandleAudioBody(breaker, cancel, isSse ? &sseParser : nullptr, aborted, ok, onChunk != nullptr,
+                body.Take(), bodyStart, result);
+        }
+
+        auto finished = std::make_shared<FetchResult>(std::move(result));
+        FetchCompletion done = std::move(onDone);
+        if (!g_fetchThreadPool.EnqueueDelayed([finished, done]() { done(*finished); }, std::chrono::milliseconds(0))) {
+            LOG_DEBUG(L"Fetch finished during shutdown, result dropped");
+        }
     }
+};
 
-    LOG_ERROR(L"Failed to fetch audio after " + std::to_wstring(maxRetries) + L" attempts");
-    return {};
-}
+void FetchTTSAudioAsync(const Backend& backend, const std::string& text, AudioChunkCallback onChunk,
+    CancellationToken* cancel, FetchCompletion onDone, AudioChunkGate canTakeChunk) {
+    FetchResult result;
+    HttpRequest request;
+    if (!PrepareSpeechRequest(backend, text, cancel, request, result)) {
+        onDone(result);
+        return;
+    }
 
-std::vector<uint8_t> FetchTTSAudio(const std::string& text) {
-    return FetchTTSAudioWithRetry(text, 3);
+    auto fetch = std::make_shared<AsyncSpeechFetch>(backend, text.size(), cancel, std::move(onChunk), std::move(onDone),
+        std::move(canTakeChunk));
+    request.timings = fetch->Timings();
+    g_socketEventLoop.Start(request, fetch);
 }
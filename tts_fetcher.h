@@ -25,48 +25,62 @@
 
 #include <vector>
 #include <string>
-#include <windows.h>
-#include <wininet.h>
+#include <functional>
+#include <chrono>
+#include <cstdint>
 
-// RAII wrapper for Windows handles
-template<typename T, BOOL(WINAPI* Closer)(T)>
-class WinHandle {
-    T handle;
-public:
-    WinHandle(T h = nullptr) : handle(h) {}
-    ~WinHandle() { if (handle) Closer(handle); }
+class CancellationToken;
+class CacheFileWriter;
+struct Backend;
 
-    WinHandle(const WinHandle&) = delete;
-    WinHandle& operator=(const WinHandle&) = delete;
+// Receives each block of the response body as it arrives; return false to abort the download
+using AudioChunkCallback = std::function<bool(const uint8_t* data, size_t size)>;
 
-    WinHandle(WinHandle&& other) noexcept : handle(other.handle) {
-        other.handle = nullptr;
-    }
-    WinHandle& operator=(WinHandle&& other) noexcept {
-        if (this != &other) {
-            if (handle) Closer(handle);
-            handle = other.handle;
-            other.handle = nullptr;
-        }
-        return *this;
-    }
-
-    operator T() const { return handle; }
-    explicit operator bool() const { return handle != nullptr; }
-    T* operator&() { return &handle; }
-    const T* operator&() const { return &handle; }
+enum class FetchOutcome {
+    Success,
+    RetryableError,   // Connection failure, 5xx, 408/429 or a broken body
+    PermanentError,   // Other 4xx or a bad server URL - retrying won't help
+    Aborted,          // The chunk consumer stopped the download or the request was cancelled
+    CircuitOpen,      // Server marked down by its circuit breaker, not contacted
+    OverBudget        // Speech budget used up and no unmetered server, not contacted
+};
 
-    void reset(T h = nullptr) {
-        if (handle) Closer(handle);
-        handle = h;
-    }
+struct FetchResult {
+    FetchOutcome outcome = FetchOutcome::PermanentError;
+    std::vector<uint8_t> audio;
+    int statusCode = 0;
+    std::chrono::milliseconds responseTime{ 0 };  // Wait for the response headers, 0 if none came
+    std::chrono::milliseconds bodyTime{ 0 };      // Time to receive the audio body
+    std::chrono::milliseconds retryAfter{ 0 };   // Delay requested via Retry-After, 0 if none
+    bool chunksDelivered = false;               // onChunk already saw part of the audio
 };
 
-using InternetHandle = WinHandle<HINTERNET, InternetCloseHandle>;
-using FileHandle = WinHandle<HANDLE, CloseHandle>;
+// TTS fetching
+// Makes a single request to backend; retries are scheduled by the caller so no worker
+// sleeps between attempts. The complete body is returned in the result, and
+// onChunk additionally sees it block by block as it arrives. Cancelling
+// the token abandons the request wherever it is blocked.
+// diskCopy, if given, receives the audio as it arrives; committing it is up to the caller
+FetchResult FetchTTSAudioOnce(const Backend& backend, const std::string& text,
+    const AudioChunkCallback& onChunk = nullptr, CancellationToken* cancel = nullptr,
+    CacheFileWriter* diskCopy = nullptr);
+
+// Receives the result of an asynchronous fetch, on a fetch worker
+using FetchCompletion = std::function<void(FetchResult& result)>;
+
+// Asked on the event loop before more of the body is read; while it says no,
+// the socket is left unread (see AsyncHttpHandler::ReadyForBody)
+using AudioChunkGate = std::function<bool()>;
+
+// Can this backend be fetched on the socket event loop (async_fetch=1 with transport=socket, plain http)
+bool CanFetchAsync(const Backend& backend);
 
-// TTS fetching functions
-std::vector<uint8_t> FetchTTSAudioWithRetry(const std::string& text, int maxRetries = 3);
-std::vector<uint8_t> FetchTTSAudio(const std::string& text);
+// Same request as FetchTTSAudioOnce, but returns once it is queued on the socket
+// event loop instead of holding the calling thread until the body is in.
+// onChunk runs on the loop thread and must not block; onDone runs on a fetch
+// worker (or before this returns, if the request is never sent). A consumer
+// that can fall behind passes canTakeChunk instead of buffering without limit.
+void FetchTTSAudioAsync(const Backend& backend, const std::string& text, AudioChunkCallback onChunk,
+    CancellationToken* cancel, FetchCompletion onDone, AudioChunkGate canTakeChunk = nullptr);
 
 #endif // TTS_STELLARIS_TTS_FETCHER_H
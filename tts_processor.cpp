@@ -27,12 +27,27 @@
 #include "audio_cache.h"
 #include "tts_fetcher.h"
 #include "audio_player.h"
+#include "audio_stream.h"
+#include "audio_decoder.h"
+#include "audio_splitter.h"
+#include "local_speech.h"
 #include "playback_queue.h"
 #include "fetch_thread_pool.h"
+#include "http_transport.h"
+#include "retry_policy.h"
+#include "hedge_policy.h"
+#include "backend_pool.h"
+#include "cancellation.h"
+#include "text_splitter.h"
+#include "rate_limiter.h"
+#include "request_timing.h"
+#include "socket_event_loop.h"
+#include "speech_priority.h"
 #include <thread>
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <algorithm>
 
 std::mutex g_audioMutex;
 
@@ -47,14 +62,61 @@ std::mutex g_playbackCoordinatorMutex;
 // PARALLEL TTS PROCESSING FUNCTIONS
 // ============================================================
 
+// Backends with the same cache group and voice share cache entries; one of each
+static std::vector<const Backend*> CacheIdentities() {
+    std::vector<const Backend*> identities;
+    for (const auto& backend : g_backendPool.Backends()) {
+        bool seen = false;
+        for (const Backend* other : identities) {
+            seen = seen || (other->cacheGroup == backend->cacheGroup && other->voice == backend->voice);
+        }
+        if (!seen) {
+            identities.push_back(backend.get());
+        }
+    }
+    return identities;
+}
+
+static bool IsCached(const std::string& text) {
+    for (const Backend* backend : CacheIdentities()) {
+        if (g_audioCache.Contains(text, backend->cacheGroup, backend->voice)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The day's speech usage is written from here rather than by each request
+// that charges it; stops once the fetch pool shuts down
+static void SaveUsagePeriodically() {
+    g_spendGovernor.Save();
+    g_fetchThreadPool.EnqueueDelayed(SaveUsagePeriodically, std::chrono::seconds(30), FETCH_PRIORITY_BACKGROUND);
+}
+
 // Entry point for parallel TTS processing - non-blocking
-void ProcessTTSRequest(const std::wstring& text) {
-    // Lazy initialization: start playback coordinator on first use
+// Lazy initialization: start playback coordinator on first use (or on warm-up)
+void EnsureParallelSystemStarted() {
     if (!g_playbackCoordinatorInitialized.load()) {
         std::lock_guard<std::mutex> lock(g_playbackCoordinatorMutex);
 
         // Double-check after acquiring lock
         if (!g_playbackCoordinatorInitialized.load()) {
+            // Streams on a shared HTTP/2 connection cost no extra handshake, so more
+            // requests can be in flight than there would be separate connections
+            size_t fetchThreads = (g_config.TransportEquals("winhttp") && g_config.http2)
+                ? g_config.http2_max_streams : g_config.max_fetch_threads;
+            // The adaptive limit decides how many are in flight; leave it threads to grow into
+            if (g_config.adaptive_concurrency) {
+                fetchThreads = std::max(fetchThreads, static_cast<size_t>(g_config.adaptive_max_concurrency));
+            }
+            g_fetchThreadPool.Configure(fetchThreads, g_config.max_pending_fetches);
+            g_socketEventLoop.Configure(g_config.async_max_requests);
+            g_backendPool.Configure();
+            ConfigureSpeechPriority();
+            if (g_config.budget_daily_chars > 0) {
+                SaveUsagePeriodically();
+            }
+
             LOG_INFO(L"Lazy initializing PlaybackCoordinator thread");
             g_playbackCoordinatorRunning.store(true);
             g_playbackCoordinatorThread = std::make_unique<std::thread>(PlaybackCoordinator);
@@ -62,31 +124,340 @@ void ProcessTTSRequest(const std::wstring& text) {
             LOG_INFO(L"PlaybackCoordinator thread started");
         }
     }
+}
+
+// Lines dropped or cut off to make way for more important ones
+static std::atomic<uint64_t> g_preemptedLines{ 0 };
+
+bool ProcessTTSRequest(const std::wstring& text, uint32_t speakFlags) {
+    EnsureParallelSystemStarted();
+
+    // Long texts go out as several shorter requests fetched in parallel; the
+    // short first piece gets audio started while the rest is synthesized
+    std::vector<std::wstring> pieces;
+    if (text.size() > static_cast<size_t>(g_config.max_chunk_chars)) {
+        pieces = SplitTextForSynthesis(text, g_config.first_chunk_chars, g_config.max_chunk_chars);
+        LOG_DEBUG(L"Split " + std::to_wstring(text.size()) + L" characters into " +
+            std::to_wstring(pieces.size()) + L" pieces");
+    } else {
+        pieces.push_back(text);
+    }
+    if (pieces.empty()) {
+        return true;
+    }
+
+    // Out of budget: a line that can't be played entirely from cache goes to the game's voice
+    if (g_config.BudgetExhaustedEquals("original_voice") && g_backendPool.BudgetExhausted()) {
+        for (const std::wstring& piece : pieces) {
+            if (!IsCached(WideToUTF8(piece))) {
+                LOG_DEBUG(L"Speech budget used up, leaving line to the original voice");
+                return false;
+            }
+        }
+    }
+
+    auto line = std::make_shared<SpeechLine>();
+    line->priority = ClassifySpeech(text);
+
+    // Speak's purge flag drops the queued lines this one supersedes, and with
+    // priority_interrupt a less important line that is playing is cut off
+    bool purge = g_config.priority_classes && (speakFlags & SPEAK_PURGE_BEFORE_SPEAK) != 0;
+    if (purge || g_config.priority_interrupt) {
+        size_t preempted = g_playbackQueue.MakeWayFor(line->priority, purge, g_config.priority_interrupt);
+        if (preempted > 0) {
+            g_preemptedLines += preempted;
+            LOG_INFO(L"Made way for a " + std::wstring(SpeechPriorityName(line->priority)) + L" priority line: " +
+                std::to_wstring(preempted) + L" line(s) dropped or cut off");
+        }
+    }
 
-    uint64_t seq = g_playbackQueue.AddRequest(text);
-    std::string utf8Text = WideToUTF8(text);
+    uint64_t firstSeq = g_playbackQueue.AddRequests(pieces, line);
 
-    if (!g_fetchThreadPool.Enqueue([utf8Text, seq]() {
-        FetchAndEnqueueForPlayback(utf8Text, seq);
+    // Tooltips go stale fast; by the time a backlog reaches them the player has moved on
+    int timeoutSeconds = g_config.line_timeout_seconds;
+    if (line->priority == SpeechPriority::Low && g_config.priority_low_timeout_seconds > 0 &&
+        (timeoutSeconds == 0 || g_config.priority_low_timeout_seconds < timeoutSeconds)) {
+        timeoutSeconds = g_config.priority_low_timeout_seconds;
+    }
+
+    // A line that sat too long is no longer worth saying: drop it and stop its downloads
+    if (timeoutSeconds > 0) {
+        std::chrono::seconds timeout(timeoutSeconds);
+        line->deadline = std::chrono::steady_clock::now() + timeout;
+        std::weak_ptr<SpeechLine> weakLine = line;
+        g_fetchThreadPool.EnqueueDelayed([weakLine, firstSeq, timeout]() {
+            std::shared_ptr<SpeechLine> expired = weakLine.lock();
+            if (expired && expired->Expire()) {
+                LOG_INFO(L"Request #" + std::to_wstring(firstSeq) + L" not played within " +
+                    std::to_wstring(timeout.count()) + L"s, dropping it");
+            }
+        }, timeout);
+    }
+
+    std::vector<FetchThreadPool::GroupTask> fetches;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        uint64_t seq = firstSeq + i;
+        std::string utf8Text = WideToUTF8(pieces[i]);
+        fetches.push_back({ [utf8Text, seq, line]() {
+            FetchAndEnqueueForPlayback(utf8Text, seq, line);
+        }, FetchPriorityFor(line->priority, seq) });
+    }
+
+    // The pieces are queued together, so a full queue never keeps the end of a
+    // line; a more urgent line may take the place of the whole line before any
+    // of it starts, which then is skipped like a failed fetch
+    size_t count = pieces.size();
+    auto skipLine = [firstSeq, count]() {
+        for (size_t i = 0; i < count; ++i) {
+            g_playbackQueue.MarkFailed(firstSeq + i);
+        }
+    };
+    if (!g_fetchThreadPool.EnqueueGroup(std::move(fetches), [firstSeq, skipLine]() {
+        LOG_WARNING(L"Fetch of request #" + std::to_wstring(firstSeq) + L" displaced by a more urgent line");
+        skipLine();
     })) {
-        LOG_WARNING(L"Failed to enqueue fetch task for: " + text);
-        g_playbackQueue.MarkFailed(seq);
+        LOG_WARNING(L"Failed to enqueue fetch tasks for: " + text);
+        skipLine();
     }
+    return true;
+}
+
+// State of one line's fetch, carried across retry attempts
+struct FetchJob {
+    std::string text;               // Original text (cache key)
+    std::string requestText;        // Sanitized text sent to the server
+    size_t chars = 0;               // Characters in requestText, for rate limits and the budget
+    uint64_t sequenceNumber = 0;
+    uint64_t fetchPriority = 0;     // Fetch and backend pool priority (FetchPriorityFor)
+    int attempt = 0;
+    std::chrono::milliseconds lastDelay{ 0 };
+    const Backend* lastBackend = nullptr;  // Failed the previous attempt; avoided on the next
+    bool decodeWireFormat = false;         // This attempt downloads wire_format
+    std::shared_ptr<AudioStream> stream;   // Set for progressive playback
+    std::shared_ptr<SpeechLine> line;      // Cancelled by the player, the line timeout or shutdown
+    std::vector<std::shared_ptr<FetchJob>> batch;  // Lines synthesized together; empty for a single line
+    std::vector<std::unique_ptr<CancellationRegistration>> memberLinks;  // Cancel a batch's line with its last member
+};
+
+// One attempt of a job: the primary request and, if it is slow, a hedge
+// racing it. Contender 0 is the primary, 1 the hedge.
+struct FetchRace {
+    std::shared_ptr<FetchJob> job;
+    CancellationToken cancel[2];
+    const Backend* backends[2] = { nullptr, nullptr };
+    std::atomic<int> streamOwner{ -1 };   // First contender to deliver audio into the stream
+
+    std::mutex raceMutex;
+    int running = 0;
+    bool settled = false;       // Won, or every contender failed
+    bool hedged = false;
+    bool hasFailure = false;
+    FetchResult failure;        // Most informative failure so far
+    const Backend* failureBackend = nullptr;
+
+    // Cancelling the line cancels both contenders; declared last so it is
+    // unregistered before the tokens it touches are destroyed
+    std::unique_ptr<CancellationRegistration> lineLink;
+};
+
+static void RunFetchAttempt(std::shared_ptr<FetchJob> job);
+static void RunContender(std::shared_ptr<FetchRace> race, int index, BackendPool::Lease lease);
+static void FinishContender(const std::shared_ptr<FetchRace>& race, int index, BackendPool::Lease& lease,
+    FetchResult& result, std::chrono::steady_clock::time_point start, CacheFileWriter* diskCopy);
+static void LaunchHedge(std::shared_ptr<FetchRace> race);
+static void CompleteAttempt(const std::shared_ptr<FetchJob>& job, const Backend* backend, FetchResult& result,
+    CacheFileWriter* diskCopy = nullptr);
+
+// Short texts collected to share one request (batch_max_chars)
+struct PendingBatch {
+    std::vector<std::shared_ptr<FetchJob>> members;
+    size_t chars = 0;
+};
+static std::mutex g_batchMutex;
+static std::shared_ptr<PendingBatch> g_openBatch;
+static std::atomic<uint64_t> g_batchRequests{ 0 };
+static std::atomic<uint64_t> g_batchedLines{ 0 };
+static std::atomic<int> g_batchSplitFailures{ 0 };
+
+// Most lines in one batch; every extra cut is another chance to cut wrongly
+static const size_t MAX_BATCH_LINES = 8;
+
+// Batches in a row whose audio couldn't be cut before batching is given up for the session
+static const int MAX_BATCH_SPLIT_FAILURES = 3;
+
+static bool BatchesShortTexts() {
+    return g_config.batch_max_chars > 0 && (g_config.FormatEquals("wav") || g_config.FormatEquals("pcm")) &&
+        g_batchSplitFailures.load() < MAX_BATCH_SPLIT_FAILURES;
+}
+
+// Send a collected batch: a lone line goes out as usual, several as one request
+static void SendBatch(const std::shared_ptr<PendingBatch>& batch) {
+    // Lines cancelled or past their deadline while the batch was open aren't sent
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<FetchJob>> members;
+    for (const auto& member : batch->members) {
+        if (member->line && (member->line->cancel.IsCancelled() ||
+            (now >= member->line->deadline && member->line->Expire()))) {
+            g_playbackQueue.MarkFailed(member->sequenceNumber);
+        } else {
+            members.push_back(member);
+        }
+    }
+    if (members.empty()) {
+        return;
+    }
+    if (members.size() == 1) {
+        RunFetchAttempt(members[0]);
+        return;
+    }
+
+    std::sort(members.begin(), members.end(), [](const std::shared_ptr<FetchJob>& a, const std::shared_ptr<FetchJob>& b) {
+        return a->sequenceNumber < b->sequenceNumber;
+    });
+
+    // Every line ends a sentence, so the server pauses where the audio will be cut
+    auto job = std::make_shared<FetchJob>();
+    for (const auto& member : members) {
+        if (!job->requestText.empty()) {
+            job->requestText += "\n\n";
+        }
+        job->requestText += member->requestText;
+        if (!EndsSentence(UTF8ToWide(member->requestText))) {
+            job->requestText += '.';
+        }
+    }
+    job->chars = CountUTF8Chars(job->requestText);
+    job->sequenceNumber = members.front()->sequenceNumber;
+    job->fetchPriority = members.front()->fetchPriority;
+    for (const auto& member : members) {
+        job->fetchPriority = std::min(job->fetchPriority, member->fetchPriority);
+    }
+
+    // The request is abandoned once every line in it is, by the player or by
+    // its own line timeout; until then it is worth finishing. A line nobody
+    // tracks never lets it go.
+    auto line = std::make_shared<SpeechLine>();
+    auto remaining = std::make_shared<std::atomic<size_t>>(members.size());
+    for (const auto& member : members) {
+        if (member->line) {
+            job->memberLinks.push_back(std::make_unique<CancellationRegistration>(&member->line->cancel,
+                [line, remaining]() {
+                    if (--*remaining == 0) {
+                        line->cancel.Cancel();
+                    }
+                }));
+        }
+    }
+    job->line = std::move(line);
+    job->batch = std::move(members);
+
+    LOG_DEBUG(L"Batching " + std::to_wstring(job->batch.size()) + L" requests from #" +
+        std::to_wstring(job->sequenceNumber) + L" into one (" + std::to_wstring(job->chars) + L" characters)");
+    RunFetchAttempt(job);
+}
+
+// Hold a short text for batch_window_ms so others arriving with it can share its request
+static void AddToBatch(const std::shared_ptr<FetchJob>& job) {
+    std::shared_ptr<PendingBatch> full;
+    std::shared_ptr<PendingBatch> opened;
+    {
+        std::lock_guard<std::mutex> lock(g_batchMutex);
+        if (g_openBatch && (g_openBatch->chars + job->chars > static_cast<size_t>(g_config.batch_max_chars) ||
+            g_openBatch->members.size() >= MAX_BATCH_LINES)) {
+            full = std::move(g_openBatch);
+            g_openBatch.reset();
+        }
+        if (!g_openBatch) {
+            g_openBatch = std::make_shared<PendingBatch>();
+            opened = g_openBatch;
+        }
+        g_openBatch->members.push_back(job);
+        g_openBatch->chars += job->chars;
+    }
+
+    // The window starts with the first text; whoever closes the batch sends it
+    if (opened) {
+        auto flush = [opened]() {
+            {
+                std::lock_guard<std::mutex> lock(g_batchMutex);
+                if (g_openBatch != opened) {
+                    return;  // Already sent when it filled up
+                }
+                g_openBatch.reset();
+            }
+            SendBatch(opened);
+        };
+        if (!g_fetchThreadPool.EnqueueDelayed(flush, std::chrono::milliseconds(g_config.batch_window_ms),
+            job->fetchPriority)) {
+            flush();
+        }
+    }
+    if (full) {
+        SendBatch(full);
+    }
+}
+
+// Cut a batch's audio into its lines and deliver each as if fetched alone.
+// Audio that can't be cut cleanly is dropped and the lines fetched one by one.
+static void CompleteBatch(const std::shared_ptr<FetchJob>& job, const Backend* backend, const std::vector<uint8_t>& audio) {
+    std::vector<size_t> weights;
+    for (const auto& member : job->batch) {
+        weights.push_back(member->chars);
+    }
+
+    std::vector<std::vector<uint8_t>> clips;
+    std::wstring error;
+    if (!SplitSpeechAudio(audio, weights, clips, error)) {
+        int failures = ++g_batchSplitFailures;
+        LOG_WARNING(L"Couldn't split batched audio (" + error + L"), fetching " +
+            std::to_wstring(job->batch.size()) + L" lines separately" +
+            (failures == MAX_BATCH_SPLIT_FAILURES ? L"; batching disabled for this session" : L""));
+        for (const auto& member : job->batch) {
+            std::shared_ptr<FetchJob> next = member;
+            if (!g_fetchThreadPool.EnqueueDelayed([next]() { RunFetchAttempt(next); }, std::chrono::milliseconds(0),
+                next->fetchPriority)) {
+                g_playbackQueue.MarkFailed(next->sequenceNumber);
+            }
+        }
+        return;
+    }
+
+    g_batchSplitFailures.store(0);
+    g_batchRequests++;
+    g_batchedLines += job->batch.size();
+
+    for (size_t i = 0; i < job->batch.size(); ++i) {
+        const FetchJob& member = *job->batch[i];
+        g_audioCache.Put(member.text, backend->cacheGroup, backend->voice, clips[i]);
+        std::string cachePath = g_audioCache.GetCachedFilePath(member.text, backend->cacheGroup, backend->voice);
+        g_playbackQueue.MarkReady(member.sequenceNumber, std::move(clips[i]), &cachePath);
+    }
+    LOG_DEBUG(L"Batch complete for requests #" + std::to_wstring(job->batch.front()->sequenceNumber) + L"-" +
+        std::to_wstring(job->batch.back()->sequenceNumber));
 }
 
 // Fetch worker - runs in parallel thread
-void FetchAndEnqueueForPlayback(const std::string& text, uint64_t sequenceNumber) {
+void FetchAndEnqueueForPlayback(const std::string& text, uint64_t sequenceNumber, std::shared_ptr<SpeechLine> line) {
+    // Cancelled or timed out while waiting for a worker
+    if (line && line->cancel.IsCancelled()) {
+        LOG_DEBUG(L"Request #" + std::to_wstring(sequenceNumber) + L" cancelled before it started");
+        g_playbackQueue.MarkFailed(sequenceNumber);
+        return;
+    }
+
     LOG_DEBUG(L"Fetching audio for request #" + std::to_wstring(sequenceNumber));
 
     std::vector<uint8_t> audioData;
     std::string cachePath;
 
-    // Check cache first
-    if (g_audioCache.Get(text, g_config.server, g_config.voice, audioData)) {
-        LOG_DEBUG(L"Cache hit for request #" + std::to_wstring(sequenceNumber));
-        cachePath = g_audioCache.GetCachedFilePath(text, g_config.server, g_config.voice);
-        g_playbackQueue.MarkReady(sequenceNumber, audioData, &cachePath);
-        return;
+    // Check cache first - under every cache group a backend could have filled
+    for (const Backend* backend : CacheIdentities()) {
+        if (g_audioCache.Get(text, backend->cacheGroup, backend->voice, audioData)) {
+            LOG_DEBUG(L"Cache hit for request #" + std::to_wstring(sequenceNumber));
+            cachePath = g_audioCache.GetCachedFilePath(text, backend->cacheGroup, backend->voice);
+            g_playbackQueue.MarkReady(sequenceNumber, std::move(audioData), &cachePath);
+            return;
+        }
     }
 
     // Sanitize text before fetching
@@ -97,20 +468,374 @@ void FetchAndEnqueueForPlayback(const std::string& text, uint64_t sequenceNumber
         return;
     }
 
-    // Fetch from server (parallel!)
-    LOG_DEBUG(L"Fetching from server for request #" + std::to_wstring(sequenceNumber));
-    audioData = FetchTTSAudio(sanitizedText);
+    auto job = std::make_shared<FetchJob>();
+    job->text = text;
+    job->requestText = std::move(sanitizedText);
+    job->chars = CountUTF8Chars(job->requestText);
+    job->sequenceNumber = sequenceNumber;
+    job->fetchPriority = FetchPriorityFor(line ? line->priority : SpeechPriority::Normal, sequenceNumber);
+    job->line = std::move(line);
 
-    if (!audioData.empty()) {
-        // Cache the result
-        g_audioCache.Put(text, g_config.server, g_config.voice, audioData);
-        cachePath = g_audioCache.GetCachedFilePath(text, g_config.server, g_config.voice);
+    // A short text may share a request with others arriving at the same time
+    if (BatchesShortTexts() && job->chars * 2 <= static_cast<size_t>(g_config.batch_max_chars)) {
+        AddToBatch(job);
+        return;
+    }
 
-        LOG_DEBUG(L"Fetch complete for request #" + std::to_wstring(sequenceNumber));
-        g_playbackQueue.MarkReady(sequenceNumber, audioData, &cachePath);
+    // Progressive playback: hand the coordinator a stream now and fill it as the response arrives
+    if (g_config.progressive_playback && SupportsStreamingPlayback()) {
+        job->stream = std::make_shared<AudioStream>();
+        g_playbackQueue.MarkStreaming(sequenceNumber, job->stream);
+    }
+
+    RunFetchAttempt(job);
+}
+
+// One request to the server, plus a hedge if it runs slow
+static void RunFetchAttempt(std::shared_ptr<FetchJob> job) {
+    LOG_DEBUG(L"Fetching from server for request #" + std::to_wstring(job->sequenceNumber) +
+        (job->attempt > 0 ? L" (attempt " + std::to_wstring(job->attempt + 1) + L")" : L""));
+
+    CancellationToken* lineCancel = job->line ? &job->line->cancel : nullptr;
+    if (lineCancel && lineCancel->IsCancelled()) {
+        FetchResult result;
+        result.outcome = FetchOutcome::Aborted;
+        CompleteAttempt(job, nullptr, result);
+        return;
+    }
+
+    job->decodeWireFormat = DecodesWireFormat();
+
+    auto race = std::make_shared<FetchRace>();
+    race->job = job;
+    race->running = 1;
+    if (lineCancel) {
+        FetchRace* raw = race.get();
+        race->lineLink = std::make_unique<CancellationRegistration>(lineCancel, [raw]() {
+            raw->cancel[0].Cancel();
+            raw->cancel[1].Cancel();
+        });
+    }
+
+    // Wait a while for a slot when every backend is at its concurrency or rate limit
+    BackendPool::Lease lease = g_backendPool.Acquire(job->lastBackend, job->chars, job->fetchPriority,
+        MAX_RETRY_DELAY, lineCancel);
+    if (!lease) {
+        {
+            std::lock_guard<std::mutex> lock(race->raceMutex);
+            race->settled = true;
+            race->running = 0;
+        }
+        race->cancel[1].Cancel();
+
+        FetchResult result;
+        if (lineCancel && lineCancel->IsCancelled()) {
+            result.outcome = FetchOutcome::Aborted;
+        } else if (g_backendPool.BudgetExhausted()) {
+            result.outcome = FetchOutcome::OverBudget;
+        } else {
+            LOG_ERROR(L"No server available for request #" + std::to_wstring(job->sequenceNumber));
+        }
+        CompleteAttempt(job, nullptr, result);
+        return;
+    }
+
+    // The hedge delay counts from when the primary is sent, not from the wait for its slot
+    std::chrono::milliseconds hedgeDelay;
+    if (g_hedgePolicy.HedgeDelay(job->stream != nullptr, hedgeDelay)) {
+        g_fetchThreadPool.EnqueueDelayed([race]() { LaunchHedge(race); }, hedgeDelay, job->fetchPriority);
+    }
+
+    RunContender(race, 0, std::move(lease));
+}
+
+// Timer fired: duplicate the request unless the primary has already delivered
+static void LaunchHedge(std::shared_ptr<FetchRace> race) {
+    const Backend* primary;
+    {
+        std::lock_guard<std::mutex> lock(race->raceMutex);
+        if (race->settled || race->running == 0 || race->streamOwner.load() != -1 ||
+            race->cancel[1].IsCancelled()) {
+            return;
+        }
+        primary = race->backends[0];
+    }
+
+    // Another backend if one is free, otherwise the same one again; never wait for a slot
+    BackendPool::Lease lease = g_backendPool.Acquire(primary, race->job->chars, race->job->fetchPriority,
+        std::chrono::milliseconds(0));
+    if (!lease) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(race->raceMutex);
+        if (race->settled || race->running == 0 || race->streamOwner.load() != -1) {
+            return;
+        }
+        if (!g_hedgePolicy.TryAcquireHedge()) {
+            return;
+        }
+        race->running++;
+        race->hedged = true;
+    }
+
+    LOG_DEBUG(L"Request #" + std::to_wstring(race->job->sequenceNumber) + L" is slow, sending hedge to " +
+        std::wstring(lease.Get()->name.begin(), lease.Get()->name.end()));
+    RunContender(race, 1, std::move(lease));
+}
+
+static void RunContender(std::shared_ptr<FetchRace> race, int index, BackendPool::Lease lease) {
+    const std::shared_ptr<FetchJob>& job = race->job;
+    const Backend* backend = lease.Get();
+    {
+        std::lock_guard<std::mutex> lock(race->raceMutex);
+        race->backends[index] = backend;
+    }
+
+    bool streaming = job->stream != nullptr;
+    bool async = CanFetchAsync(*backend);
+    auto start = std::chrono::steady_clock::now();
+
+    // Only one contender may write into the stream; the first to produce
+    // audio takes it and cancels the other. The event loop must not wait
+    // for the player, so instead it stops reading while the stream is full.
+    AudioChunkCallback onChunk;
+    AudioChunkGate canTakeChunk;
+    if (streaming) {
+        onChunk = [race, index, start, async](const uint8_t* data, size_t size) {
+            int owner = -1;
+            if (race->streamOwner.compare_exchange_strong(owner, index)) {
+                g_hedgePolicy.RecordLatency(true, std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start));
+                race->cancel[1 - index].Cancel();
+            } else if (owner != index) {
+                return false;
+            }
+            return async ? race->job->stream->Append(data, size) : race->job->stream->Write(data, size);
+        };
+        if (async) {
+            std::shared_ptr<AudioStream> stream = job->stream;
+            stream->SetSpaceCallback([]() { g_socketEventLoop.Wake(); });
+            canTakeChunk = [stream]() { return stream->HasSpace(); };
+        }
+    }
+
+    // The worker is free as soon as the request is queued; the rest continues on completion
+    if (async) {
+        auto heldLease = std::make_shared<BackendPool::Lease>(std::move(lease));
+        FetchTTSAudioAsync(*backend, job->requestText, std::move(onChunk), &race->cancel[index],
+            [race, index, heldLease, start](FetchResult& result) {
+                FinishContender(race, index, *heldLease, result, start, nullptr);
+            }, std::move(canTakeChunk));
+        return;
+    }
+
+    // The audio goes to a temporary cache file as it arrives; only the winner's is kept.
+    // Wire format audio isn't what the cache holds, so it is saved once decoded;
+    // a batch is saved line by line once cut.
+    std::unique_ptr<CacheFileWriter> diskCopy = (job->decodeWireFormat || !job->batch.empty()) ? nullptr :
+        g_audioCache.BeginDiskWrite(job->text, backend->cacheGroup, backend->voice);
+    FetchResult result = FetchTTSAudioOnce(*backend, job->requestText, onChunk, &race->cancel[index], diskCopy.get());
+    FinishContender(race, index, lease, result, start, diskCopy.get());
+}
+
+// A contender's request is over: report to the backend pool and settle the race
+static void FinishContender(const std::shared_ptr<FetchRace>& race, int index, BackendPool::Lease& lease,
+    FetchResult& result, std::chrono::steady_clock::time_point start, CacheFileWriter* diskCopy) {
+    const std::shared_ptr<FetchJob>& job = race->job;
+    const Backend* backend = lease.Get();
+    bool streaming = job->stream != nullptr;
+
+    if (result.outcome != FetchOutcome::Success) {
+        lease.RefundCharge();
+    }
+
+    // Hand the slot back before anything else is scheduled on this backend
+    if (result.statusCode == 429 || result.statusCode == 503) {
+        lease.MarkOverloaded();
+    }
+    if (result.outcome == FetchOutcome::RetryableError && result.statusCode != 429) {
+        lease.RecordFailure();
+    } else if (result.responseTime.count() > 0) {
+        lease.RecordSuccess(result.responseTime);
     } else {
-        LOG_ERROR(L"Fetch failed for request #" + std::to_wstring(sequenceNumber));
-        g_playbackQueue.MarkFailed(sequenceNumber);
+        lease.RecordCancelled();
+    }
+
+    std::unique_lock<std::mutex> lock(race->raceMutex);
+    race->running--;
+    if (race->settled) {
+        return;  // The other contender already won
+    }
+
+    if (result.outcome == FetchOutcome::Success) {
+        race->settled = true;
+        bool hedged = race->hedged;
+        lock.unlock();
+
+        race->cancel[1 - index].Cancel();
+        if (hedged) {
+            g_hedgePolicy.RecordRaceWinner(index == 1);
+        }
+        if (!streaming) {
+            g_hedgePolicy.RecordLatency(false, std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start));
+        }
+        CompleteAttempt(job, backend, result, diskCopy);
+        return;
+    }
+
+    // A cancelled loser says less than a real error from the other side
+    if (!race->hasFailure || result.outcome != FetchOutcome::Aborted) {
+        race->failure = std::move(result);
+        race->failureBackend = backend;
+        race->hasFailure = true;
+    }
+    if (race->running > 0) {
+        return;  // The other contender may still succeed
+    }
+
+    race->settled = true;
+    FetchResult failure = std::move(race->failure);
+    const Backend* failureBackend = race->failureBackend;
+    lock.unlock();
+
+    CompleteAttempt(job, failureBackend, failure);
+}
+
+// Have the local voice say a line no server could; false if local_fallback is off
+static bool SpeakJobLocally(const std::shared_ptr<FetchJob>& job) {
+    if (!g_config.local_fallback) {
+        return false;
+    }
+
+    if (!job->batch.empty()) {
+        for (const auto& member : job->batch) {
+            if (!SpeakJobLocally(member)) {
+                g_playbackQueue.MarkFailed(member->sequenceNumber);
+            }
+        }
+        return true;
+    }
+
+    uint64_t seq = job->sequenceNumber;
+    std::shared_ptr<AudioStream> stream = job->stream;
+    LOG_INFO(L"Speaking request #" + std::to_wstring(seq) + L" with the local voice");
+    return SpeakLocally(job->requestText, job->fetchPriority, [seq, stream](FetchResult& result) {
+        bool ok = result.outcome == FetchOutcome::Success;
+        if (stream) {
+            // Nothing reached the stream yet, so the local clip fills it from the start
+            if (ok) {
+                stream->Write(result.audio.data(), result.audio.size());
+            }
+            stream->Finish(ok);
+        } else if (ok) {
+            // Not cached: the server's voice should be heard again once it is back
+            g_playbackQueue.MarkReady(seq, std::move(result.audio), nullptr);
+        } else {
+            g_playbackQueue.MarkFailed(seq);
+        }
+    });
+}
+
+// Deliver the winning response, or retry/fail the line; on a retryable
+// failure the next attempt is scheduled on the pool's timer instead of
+// sleeping in this worker
+static void CompleteAttempt(const std::shared_ptr<FetchJob>& job, const Backend* backend, FetchResult& result,
+    CacheFileWriter* diskCopy) {
+    uint64_t seq = job->sequenceNumber;
+
+    if (result.outcome == FetchOutcome::Success) {
+        // The cache keeps what the player plays, so wire format audio is decoded first.
+        // If it can't be, wire_format is now off and the line is fetched again as format.
+        if (job->decodeWireFormat && !DecodeDownloadedClip(result.audio, result.bodyTime)) {
+            std::shared_ptr<FetchJob> next = job;
+            if (!g_fetchThreadPool.EnqueueDelayed([next]() { RunFetchAttempt(next); }, std::chrono::milliseconds(0),
+                next->fetchPriority)) {
+                g_playbackQueue.MarkFailed(seq);
+            }
+            return;
+        }
+
+        if (!job->batch.empty()) {
+            CompleteBatch(job, backend, result.audio);
+            return;
+        }
+
+        g_audioCache.Put(job->text, backend->cacheGroup, backend->voice, result.audio, diskCopy);
+
+        if (job->stream) {
+            job->stream->Finish(true);
+            LOG_DEBUG(L"Stream complete for request #" + std::to_wstring(seq));
+        } else {
+            std::string cachePath = g_audioCache.GetCachedFilePath(job->text, backend->cacheGroup, backend->voice);
+            LOG_DEBUG(L"Fetch complete for request #" + std::to_wstring(seq));
+            g_playbackQueue.MarkReady(seq, std::move(result.audio), &cachePath);
+        }
+        return;
+    }
+
+    // A server that failed or is marked down can be swapped for another right away
+    job->lastBackend = backend;
+    bool failover = backend && (result.outcome == FetchOutcome::RetryableError || result.outcome == FetchOutcome::CircuitOpen) &&
+        g_backendPool.HasAlternative(backend);
+
+    // Audio the player already consumed can't be taken back, so a partial stream is not retried
+    bool retry = (result.outcome == FetchOutcome::RetryableError || failover) && !result.chunksDelivered &&
+        job->attempt + 1 < g_config.max_retries;
+
+    if (retry) {
+        std::chrono::milliseconds delay(0);
+        if (failover) {
+            LOG_INFO(L"Failing over request #" + std::to_wstring(seq) + L" from " +
+                std::wstring(backend->name.begin(), backend->name.end()));
+        } else {
+            delay = std::max(NextRetryDelay(job->lastDelay), result.retryAfter);
+        }
+
+        if (delay <= MAX_RETRY_DELAY) {
+            job->attempt++;
+            if (!failover) {
+                job->lastDelay = delay;
+            }
+            LOG_INFO(L"Retrying request #" + std::to_wstring(seq) + L" in " + std::to_wstring(delay.count()) +
+                L" ms (attempt " + std::to_wstring(job->attempt + 1) + L" of " + std::to_wstring(g_config.max_retries) + L")");
+
+            std::shared_ptr<FetchJob> next = job;
+            if (g_fetchThreadPool.EnqueueDelayed([next]() { RunFetchAttempt(next); }, delay, next->fetchPriority)) {
+                return;
+            }
+        } else {
+            LOG_WARNING(L"Server asked to wait " + std::to_wstring(result.retryAfter.count() / 1000) +
+                L"s, giving up on request #" + std::to_wstring(seq));
+        }
+    }
+
+    if (result.outcome == FetchOutcome::CircuitOpen) {
+        LOG_WARNING(L"Server unavailable, skipping request #" + std::to_wstring(seq));
+    } else if (result.outcome == FetchOutcome::OverBudget) {
+        LOG_DEBUG(L"Speech budget used up, skipping request #" + std::to_wstring(seq));
+    } else if (result.outcome == FetchOutcome::Aborted && job->line && job->line->cancel.IsCancelled()) {
+        LOG_DEBUG(L"Request #" + std::to_wstring(seq) + L" cancelled");
+    } else if (result.outcome != FetchOutcome::Aborted) {
+        LOG_ERROR(L"Fetch failed for request #" + std::to_wstring(seq) + L" after " +
+            std::to_wstring(job->attempt + 1) + L" attempt(s)");
+    }
+
+    bool cancelled = job->line && job->line->cancel.IsCancelled();
+    if (result.outcome != FetchOutcome::Aborted && !cancelled && !result.chunksDelivered && SpeakJobLocally(job)) {
+        return;
+    }
+
+    if (job->stream) {
+        job->stream->Finish(false);
+    } else if (!job->batch.empty()) {
+        for (const auto& member : job->batch) {
+            g_playbackQueue.MarkFailed(member->sequenceNumber);
+        }
+    } else {
+        g_playbackQueue.MarkFailed(seq);
     }
 }
 
@@ -125,6 +850,9 @@ void PlaybackCoordinator() {
         return;
     }
 
+    // Line whose first piece was last timed; later pieces of a split text aren't
+    std::shared_ptr<SpeechLine> timedLine;
+
     while (g_playbackCoordinatorRunning.load()) {
         AudioItem item;
 
@@ -140,13 +868,44 @@ void PlaybackCoordinator() {
             continue;
         }
 
+        // Cancelled, or waited past line_timeout_seconds; from here on the timeout no longer applies
+        if (item.line && !item.line->BeginPlayback()) {
+            LOG_DEBUG(L"Skipping item #" + std::to_wstring(item.sequenceNumber) + L" of a cancelled line");
+            if (item.stream) {
+                item.stream->Close();
+            }
+            g_playbackQueue.Remove(item.sequenceNumber);
+            continue;
+        }
+
         // Play audio (only holds g_audioMutex during playback)
         LOG_INFO(L"Playing item #" + std::to_wstring(item.sequenceNumber) + L": " + item.text);
 
+        auto soundAt = std::chrono::steady_clock::now();
         {
             std::lock_guard<std::mutex> lock(g_audioMutex);
-            PlayAudioFromMemory(item.audioData,
-                item.cachePath.empty() ? nullptr : &item.cachePath);
+            if (item.stream) {
+                PlayAudioStream(item.stream);
+                soundAt = item.stream->FirstSoundTime();
+            } else {
+                PlayAudioFromMemory(item.audioData,
+                    item.cachePath.empty() ? nullptr : &item.cachePath);
+            }
+        }
+
+        // A line's latency is that of its first piece; a stream that never played has none
+        if (item.line && item.line != timedLine) {
+            timedLine = item.line;
+            if (soundAt != std::chrono::steady_clock::time_point()) {
+                g_requestTimings.RecordLineLatency(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    soundAt - item.line->spokenAt).count());
+            }
+        }
+
+        // Cancelling one piece of a split text cancels the pieces after it too,
+        // including those still downloading
+        if (g_shouldCancel.load() && item.line) {
+            item.line->cancel.Cancel();
         }
 
         LOG_DEBUG(L"Finished playing item #" + std::to_wstring(item.sequenceNumber));
@@ -174,8 +933,28 @@ void ShutdownParallelSystem() {
 
     // Signal shutdown
     g_playbackCoordinatorRunning.store(false);
+    g_playbackQueue.CancelAll();
     g_playbackQueue.Shutdown();
     g_fetchThreadPool.Shutdown();
+    g_spendGovernor.Save();
+    ShutdownLocalSpeech();
+    ShutdownHttpTransports();
+    g_circuitBreakers.LogStats();
+    g_hedgePolicy.LogStats();
+    g_backendPool.LogStats();
+    g_requestTimings.LogStats();
+    g_spendGovernor.LogStats();
+    LogWireFormatStats();
+    if (g_preemptedLines.load() > 0) {
+        LOG_INFO(L"Priority classes: " + std::to_wstring(g_preemptedLines.load()) +
+            L" lines dropped or cut off for more important ones");
+    }
+    if (g_batchRequests.load() > 0) {
+        LOG_INFO(L"Batching: " + std::to_wstring(g_batchedLines.load()) + L" lines synthesized in " +
+            std::to_wstring(g_batchRequests.load()) + L" requests");
+    }
+
+    g_audioCache.LogAdmissionStats();
 
     // Detach the thread (fast shutdown for DLL unload)
     if (g_playbackCoordinatorThread && g_playbackCoordinatorThread->joinable()) {
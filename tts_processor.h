@@ -28,14 +28,20 @@
 #include <chrono>
 #include <vector>
 #include <cstdint>
+#include <memory>
+
+struct SpeechLine;
 
 // Global state for TTS processing
 extern std::mutex g_audioMutex;
 
 // TTS processing functions
-void ProcessTTSRequest(const std::wstring& text);
-void FetchAndEnqueueForPlayback(const std::string& text, uint64_t sequenceNumber);
+// speakFlags are Speak's SPF_* flags; a purge drops queued lines of the same or a lower priority class
+// Returns false if the line was left to the game's own voice (budget_exhausted=original_voice)
+bool ProcessTTSRequest(const std::wstring& text, uint32_t speakFlags = 0);
+void FetchAndEnqueueForPlayback(const std::string& text, uint64_t sequenceNumber, std::shared_ptr<SpeechLine> line);
 void PlaybackCoordinator();
+void EnsureParallelSystemStarted();
 void InitializeParallelSystem();
 void ShutdownParallelSystem();
 
@@ -27,9 +27,18 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <cstdint>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include "logger.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TTS_STELLARIS_HAVE_SSE2 1
+#endif
+
 // Utility functions
 
 inline std::string trim(const std::string& str) {
@@ -67,9 +76,19 @@ inline bool IsValidUTF8(const std::string& str) {
     return true;
 }
 
-inline bool SanitizeText(std::string& text) {
-    const size_t MAX_LENGTH = 5000;
+// Characters (code points) in UTF-8 text, as speech APIs count them
+inline size_t CountUTF8Chars(const std::string& str) {
+    size_t count = 0;
+    for (unsigned char c : str) {
+        if ((c & 0xC0) != 0x80) {
+            count++;
+        }
+    }
+    return count;
+}
 
+// Length is not limited here - long texts are split into pieces before they get this far
+inline bool SanitizeText(std::string& text) {
     text.erase(std::remove(text.begin(), text.end(), '\0'), text.end());
 
     // Validate UTF-8
@@ -77,48 +96,148 @@ inline bool SanitizeText(std::string& text) {
         LOG_WARNING(L"Invalid UTF-8 sequence detected, text may be corrupted");
     }
 
-    if (text.length() > MAX_LENGTH) {
-        text.resize(MAX_LENGTH);
-        LOG_WARNING(L"Text truncated to " + std::to_wstring(MAX_LENGTH) + L" characters");
-    }
-
     return !text.empty();
 }
 
 inline std::string WideToUTF8(const std::wstring& wstr) {
     if (wstr.empty()) return std::string();
+#ifdef _WIN32
     int size_needed = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), NULL, 0, NULL, NULL);
     std::string strTo(size_needed, 0);
     WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &strTo[0], size_needed, NULL, NULL);
     return strTo;
+#else
+    // wchar_t holds whole code points outside Windows
+    std::string strTo;
+    strTo.reserve(wstr.size());
+    for (wchar_t wc : wstr) {
+        uint32_t cp = static_cast<uint32_t>(wc);
+        if (cp < 0x80) {
+            strTo += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            strTo += static_cast<char>(0xC0 | (cp >> 6));
+            strTo += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            strTo += static_cast<char>(0xE0 | (cp >> 12));
+            strTo += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            strTo += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            strTo += static_cast<char>(0xF0 | (cp >> 18));
+            strTo += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            strTo += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            strTo += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return strTo;
+#endif
 }
 
-inline std::string EscapeJSON(const std::string& str) {
-    std::ostringstream oss;
-    for (size_t i = 0; i < str.length(); ++i) {
+inline std::wstring UTF8ToWide(const std::string& str) {
+    if (str.empty()) return std::wstring();
+#ifdef _WIN32
+    int size = MultiByteToWideChar(CP_UTF8, 0, str.data(), static_cast<int>(str.size()), nullptr, 0);
+    if (size <= 0) return std::wstring();
+    std::wstring wide(size, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, str.data(), static_cast<int>(str.size()), &wide[0], size);
+    return wide;
+#else
+    std::wstring wide;
+    wide.reserve(str.size());
+    size_t i = 0;
+    while (i < str.size()) {
         unsigned char c = static_cast<unsigned char>(str[i]);
+        size_t extra = c < 0x80 ? 0 : (c & 0xE0) == 0xC0 ? 1 : (c & 0xF0) == 0xE0 ? 2 : (c & 0xF8) == 0xF0 ? 3 : 0;
+        uint32_t cp = extra == 0 ? c : c & (0x3F >> extra);
+        if (c >= 0x80 && extra == 0) {
+            cp = 0xFFFD;   // Stray continuation or invalid lead byte
+        }
+        size_t j = 1;
+        for (; j <= extra && i + j < str.size(); ++j) {
+            unsigned char next = static_cast<unsigned char>(str[i + j]);
+            if ((next & 0xC0) != 0x80) break;
+            cp = (cp << 6) | (next & 0x3F);
+        }
+        if (j <= extra) {
+            cp = 0xFFFD;   // Truncated sequence
+        }
+        wide += static_cast<wchar_t>(cp);
+        i += j;
+    }
+    return wide;
+#endif
+}
 
-        switch (c) {
-        case '"':  oss << "\\\""; break;
-        case '\\': oss << "\\\\"; break;
-        case '\b': oss << "\\b"; break;
-        case '\f': oss << "\\f"; break;
-        case '\n': oss << "\\n"; break;
-        case '\r': oss << "\\r"; break;
-        case '\t': oss << "\\t"; break;
-        default:
-            if (c < 0x20) {
-                oss << "\\u"
-                    << std::hex << std::setw(4) << std::setfill('0')
-                    << static_cast<int>(c)
-                    << std::dec;
-            }
-            else {
-                oss << c;
-            }
+// Append one byte that needs escaping
+inline void AppendEscapedJSONChar(std::string& out, unsigned char c) {
+    static const char hex[] = "0123456789abcdef";
+
+    switch (c) {
+    case '"':  out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\b': out += "\\b"; break;
+    case '\f': out += "\\f"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default: {
+        char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+        out.append(esc, sizeof(esc));
+    }
+    }
+}
+
+// Append JSON-escaped text to out
+// Clean runs are copied in bulk; with SSE2 16 bytes are checked per step
+// for quote, backslash and control characters
+inline void AppendEscapedJSON(std::string& out, const char* data, size_t size) {
+    out.reserve(out.size() + size + size / 8);
+
+    size_t i = 0;
+    size_t runStart = 0;
+
+#ifdef TTS_STELLARIS_HAVE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+
+    while (i + 16 <= size) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, controlMax), controlMax));  // v <= 0x1F
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask == 0) {
+            i += 16;
+            continue;
         }
+
+        unsigned offset = 0;
+        while (!(mask & (1u << offset))) ++offset;
+
+        size_t pos = i + offset;
+        out.append(data + runStart, pos - runStart);
+        AppendEscapedJSONChar(out, static_cast<unsigned char>(data[pos]));
+        i = runStart = pos + 1;
     }
-    return oss.str();
+#endif
+
+    for (; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == '"' || c == '\\' || c < 0x20) {
+            out.append(data + runStart, i - runStart);
+            AppendEscapedJSONChar(out, c);
+            runStart = i + 1;
+        }
+    }
+
+    out.append(data + runStart, size - runStart);
+}
+
+inline std::string EscapeJSON(const std::string& str) {
+    std::string escaped;
+    AppendEscapedJSON(escaped, str.data(), str.size());
+    return escaped;
 }
 
 // Escape path for MCI commands
@@ -135,6 +254,7 @@ inline std::string EscapeMCIPath(const std::string& path) {
     return escaped;
 }
 
+#ifdef _WIN32
 // Get human-readable Windows error message
 inline std::wstring GetWindowsErrorMessage(DWORD error) {
     wchar_t* messageBuffer = nullptr;
@@ -171,5 +291,6 @@ inline bool IsValidStringPointer(const WCHAR* text) {
         return false;
     }
 }
+#endif
 
 #endif // TTS_STELLARIS_UTILS_H
@@ -0,0 +1,172 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "warmup.h"
+#include "backend_pool.h"
+#include "http_transport.h"
+#include "socket_platform.h"
+#include "socket_transport.h"
+#include "fetch_thread_pool.h"
+#include "rate_limiter.h"
+#include "tts_fetcher.h"
+#include "tts_processor.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include <chrono>
+
+static const char WARMUP_TEXT[] = "Hello.";
+
+static long long MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fills the resolver cache, which every transport goes through
+static bool WarmUpDns(const HttpRequest& target, std::wstring& timings) {
+    std::wstring error;
+    if (!g_socketTransport.EnsureStarted(error)) {
+        timings += L"DNS skipped (" + error + L")";
+        return true;
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    std::string portStr = std::to_string(target.port);
+    auto start = std::chrono::steady_clock::now();
+    int result = getaddrinfo(target.host.c_str(), portStr.c_str(), &hints, &addresses);
+    long long elapsed = MillisecondsSince(start);
+
+    if (result != 0 || !addresses) {
+        timings += L"DNS failed after " + std::to_wstring(elapsed) + L" ms (" + std::to_wstring(result) + L")";
+        return false;
+    }
+    freeaddrinfo(addresses);
+    timings += L"DNS " + std::to_wstring(elapsed) + L" ms";
+    return true;
+}
+
+// GET /models opens the connection (and the TLS session for https); reading the
+// answer to the end leaves the connection in the keep-alive pool
+static bool WarmUpConnection(const Backend& backend, std::wstring& timings) {
+    HttpRequest request;
+    if (!ParseHttpUrl(backend.url + "/models", request)) {
+        timings += L", bad URL";
+        return false;
+    }
+    request.method = "GET";
+    if (!backend.apiKey.empty()) {
+        request.headers = "Authorization: Bearer " + backend.apiKey + "\r\n";
+    }
+
+    std::wstring error;
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<HttpResponse> response = GetHttpTransport().Send(request, error);
+    if (!response) {
+        timings += L", connect failed after " + std::to_wstring(MillisecondsSince(start)) + L" ms: " + error;
+        return false;
+    }
+
+    uint8_t discard[4096];
+    size_t bytesRead = 0;
+    bool complete = false;
+    while (response->Read(discard, sizeof(discard), bytesRead)) {
+        if (bytesRead == 0) {
+            complete = true;
+            break;
+        }
+    }
+    if (complete) {
+        response->MarkComplete();
+    }
+
+    timings += L", connect " + std::to_wstring(MillisecondsSince(start)) + L" ms (HTTP " +
+        std::to_wstring(response->StatusCode()) + L")";
+    return true;
+}
+
+// A first synthesis makes a self-hosted server load its voice model
+static void WarmUpSynthesis(const Backend& backend, std::wstring& timings) {
+    size_t chars = CountUTF8Chars(WARMUP_TEXT);
+    if (backend.metered && !g_spendGovernor.TryCharge(chars)) {
+        timings += L", synthesis skipped (speech budget used up)";
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FetchResult result = FetchTTSAudioOnce(backend, WARMUP_TEXT);
+    long long elapsed = MillisecondsSince(start);
+
+    if (result.outcome != FetchOutcome::Success) {
+        if (backend.metered) {
+            g_spendGovernor.Refund(chars);
+        }
+        timings += L", synthesis failed after " + std::to_wstring(elapsed) + L" ms";
+        return;
+    }
+    timings += L", first synthesis " + std::to_wstring(elapsed) + L" ms (" +
+        std::to_wstring(result.audio.size()) + L" bytes)";
+}
+
+static void WarmUpBackend(const Backend& backend) {
+    HttpRequest target;
+    if (!ParseHttpUrl(backend.url, target)) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::wstring timings;
+    bool reachable = WarmUpDns(target, timings) && WarmUpConnection(backend, timings);
+    if (reachable && g_config.WarmupEquals("synthesize")) {
+        WarmUpSynthesis(backend, timings);
+    }
+
+    std::wstring line = L"Warm-up " + std::wstring(backend.name.begin(), backend.name.end()) + L": " + timings + L", total " +
+        std::to_wstring(MillisecondsSince(start)) + L" ms";
+    if (reachable) {
+        LOG_INFO(line);
+    } else {
+        LOG_WARNING(line);
+    }
+}
+
+void StartWarmup() {
+    if (g_config.WarmupEquals("off")) {
+        return;
+    }
+
+    // The fetch pool and backend list are normally set up by the first line spoken
+    EnsureParallelSystemStarted();
+
+    const auto& backends = g_backendPool.Backends();
+    LOG_INFO(L"Warming up " + std::to_wstring(backends.size()) + L" server(s)");
+    for (const auto& backend : backends) {
+        const Backend* target = backend.get();
+        if (!g_fetchThreadPool.Enqueue([target]() { WarmUpBackend(*target); })) {
+            LOG_WARNING(L"Fetch queue full, skipping warm-up of " + std::wstring(target->name.begin(), target->name.end()));
+        }
+    }
+}
@@ -0,0 +1,400 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "winhttp_transport.h"
+#include "cancellation.h"
+#include "config.h"
+#include "logger.h"
+
+#include <windows.h>
+#include <winhttp.h>
+
+#pragma comment(lib, "winhttp.lib")
+
+// Global WinHTTP transport instance
+WinHttpTransport g_winHttpTransport;
+
+namespace {
+
+std::wstring ErrorText(const wchar_t* what, DWORD error) {
+    return std::wstring(what) + L" (WinHTTP error " + std::to_wstring(error) + L")";
+}
+
+// Context of a request handle's status callback
+struct StatusContext {
+    HttpTimings* timings = nullptr;
+    bool secure = false;
+    bool connected = false;   // The request opened a connection of its own
+};
+
+constexpr DWORD TIMING_NOTIFICATIONS = WINHTTP_CALLBACK_STATUS_NAME_RESOLVED |
+    WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER | WINHTTP_CALLBACK_STATUS_SENDING_REQUEST |
+    WINHTTP_CALLBACK_STATUS_REQUEST_SENT | WINHTTP_CALLBACK_STATUS_RESPONSE_RECEIVED;
+
+// WinHTTP reports each step of a synchronous request to the handle's status
+// callback, on the thread blocked in the send, receive or read
+void CALLBACK OnRequestStatus(HINTERNET, DWORD_PTR context, DWORD status, LPVOID, DWORD) {
+    StatusContext* request = reinterpret_cast<StatusContext*>(context);
+    if (!request) {
+        return;
+    }
+    switch (status) {
+    case WINHTTP_CALLBACK_STATUS_NAME_RESOLVED:
+        MarkPhase(request->timings, &HttpTimings::resolved);
+        break;
+    case WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER:
+        request->connected = true;
+        MarkPhase(request->timings, &HttpTimings::connected);
+        break;
+    case WINHTTP_CALLBACK_STATUS_SENDING_REQUEST:
+        // There is no handshake notification; on a new https connection the
+        // handshake is what happens between connecting and sending
+        if (request->secure && request->connected) {
+            MarkPhaseOnce(request->timings, &HttpTimings::tlsDone);
+        }
+        break;
+    case WINHTTP_CALLBACK_STATUS_REQUEST_SENT:
+        MarkPhase(request->timings, &HttpTimings::requestSent);
+        break;
+    case WINHTTP_CALLBACK_STATUS_RESPONSE_RECEIVED:
+        MarkPhaseOnce(request->timings, &HttpTimings::firstByte);
+        break;
+    }
+}
+
+// Request handle that a cancellation callback may close from another thread
+// WinHTTP cancels a blocking send, receive or read when its handle is closed;
+// on HTTP/2 that resets just this stream. Every call on the handle goes
+// through BeginCall/EndCall, so a handle closed by Abort is never used again.
+class AbortableRequest {
+private:
+    std::mutex requestMutex;
+    HINTERNET handle = nullptr;
+    int callsInProgress = 0;
+    bool aborted = false;
+
+public:
+    StatusContext status;
+
+    ~AbortableRequest() {
+        if (handle) WinHttpCloseHandle(handle);
+    }
+
+    // Takes ownership; closes the handle and returns false if already aborted
+    bool Set(HINTERNET request) {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        if (aborted) {
+            WinHttpCloseHandle(request);
+            return false;
+        }
+        handle = request;
+        return true;
+    }
+
+    // Handle to make one call with, or null once aborted; pair with EndCall
+    HINTERNET BeginCall() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        if (aborted || !handle) {
+            return nullptr;
+        }
+        callsInProgress++;
+        return handle;
+    }
+
+    // False if the request was aborted while the call ran
+    bool EndCall() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        callsInProgress--;
+        return !aborted;
+    }
+
+    // A running call can only be interrupted by closing the handle; with none
+    // running, later calls are refused and the destructor closes it
+    void Abort() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        aborted = true;
+        if (handle && callsInProgress > 0) {
+            WinHttpCloseHandle(handle);
+            handle = nullptr;
+        }
+    }
+
+    bool IsAborted() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        return aborted;
+    }
+};
+
+class WinHttpResponse : public HttpResponse {
+private:
+    std::shared_ptr<AbortableRequest> request;
+    std::unique_ptr<CancellationRegistration> cancelRegistration;
+    bool reused;
+    int statusCode;
+    uint64_t contentLength;
+
+    bool QueryNumber(DWORD query, DWORD& value) const {
+        HINTERNET handle = request->BeginCall();
+        if (!handle) {
+            return false;
+        }
+        DWORD valueSize = sizeof(value);
+        BOOL ok = WinHttpQueryHeaders(handle, query | WINHTTP_QUERY_FLAG_NUMBER, WINHTTP_HEADER_NAME_BY_INDEX,
+            &value, &valueSize, WINHTTP_NO_HEADER_INDEX);
+        return request->EndCall() && ok;
+    }
+
+public:
+    WinHttpResponse(std::shared_ptr<AbortableRequest> abortable, std::unique_ptr<CancellationRegistration>&& registration,
+        bool connectionReused)
+        : request(std::move(abortable)), cancelRegistration(std::move(registration)),
+          reused(connectionReused), statusCode(0), contentLength(0) {
+        DWORD value = 0;
+        if (QueryNumber(WINHTTP_QUERY_STATUS_CODE, value)) {
+            statusCode = static_cast<int>(value);
+        }
+
+        value = 0;
+        if (QueryNumber(WINHTTP_QUERY_CONTENT_LENGTH, value)) {
+            contentLength = value;
+        }
+    }
+
+    // The request handle closes with the last reference to it, after the
+    // registration is gone; on HTTP/2 an unfinished request resets just its stream
+    ~WinHttpResponse() override {
+        cancelRegistration.reset();
+    }
+
+    int StatusCode() const override { return statusCode; }
+    uint64_t ContentLength() const override { return contentLength; }
+    bool ConnectionReused() const override { return reused; }
+
+    std::string Header(const char* name) const override {
+        HINTERNET handle = request->BeginCall();
+        if (!handle) {
+            return std::string();
+        }
+        std::wstring wideName(name, name + strlen(name));
+        wchar_t buffer[512] = { 0 };
+        DWORD bufferSize = sizeof(buffer);
+        BOOL ok = WinHttpQueryHeaders(handle, WINHTTP_QUERY_CUSTOM, wideName.c_str(),
+            buffer, &bufferSize, WINHTTP_NO_HEADER_INDEX);
+        if (!request->EndCall() || !ok) {
+            return std::string();
+        }
+        // Header values are ASCII
+        std::wstring value(buffer, bufferSize / sizeof(wchar_t));
+        return std::string(value.begin(), value.end());
+    }
+
+    bool QueryAvailable(size_t& available) override {
+        HINTERNET handle = request->BeginCall();
+        if (!handle) {
+            return false;
+        }
+        DWORD bytes = 0;
+        BOOL ok = WinHttpQueryDataAvailable(handle, &bytes);
+        if (!request->EndCall() || !ok) {
+            return false;
+        }
+        available = bytes;
+        return true;
+    }
+
+    bool Read(uint8_t* dest, size_t size, size_t& bytesRead) override {
+        // WinHttpReadData may return less than asked; keep going until full or end of body
+        bytesRead = 0;
+        while (bytesRead < size) {
+            HINTERNET handle = request->BeginCall();
+            if (!handle) {
+                return false;
+            }
+            DWORD read = 0;
+            BOOL ok = WinHttpReadData(handle, dest + bytesRead, static_cast<DWORD>(size - bytesRead), &read);
+            if (!request->EndCall() || !ok) {
+                return false;
+            }
+            if (read == 0) {
+                break;
+            }
+            bytesRead += read;
+        }
+        return true;
+    }
+
+    // WinHTTP returns the connection to its pool by itself once the body is drained
+    void MarkComplete() override {}
+};
+
+} // namespace
+
+// DLL Best Practices: the destructor runs during DLL_PROCESS_DETACH -
+// abandon the handles and let the OS reclaim them
+WinHttpTransport::~WinHttpTransport() {
+    connections.clear();
+    session = nullptr;
+}
+
+bool WinHttpTransport::EnsureSessionLocked(std::wstring& error) {
+    if (session) {
+        return true;
+    }
+
+    // Automatic proxy needs Windows 8.1; fall back to the static proxy settings
+    HINTERNET hSession = WinHttpOpen(L"StellarTTS/1.0", WINHTTP_ACCESS_TYPE_AUTOMATIC_PROXY,
+        WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+    if (!hSession) {
+        hSession = WinHttpOpen(L"StellarTTS/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+            WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+    }
+    if (!hSession) {
+        error = ErrorText(L"Failed to initialize WinHTTP", GetLastError());
+        return false;
+    }
+
+    // Same limits as the WinINet session: resolve, connect, send, receive
+    WinHttpSetTimeouts(hSession, 0, 15000, 15000, 30000);
+
+    if (g_config.http2) {
+        DWORD protocols = WINHTTP_PROTOCOL_FLAG_HTTP2;
+        http2Enabled = WinHttpSetOption(hSession, WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL, &protocols, sizeof(protocols)) != FALSE;
+        if (!http2Enabled) {
+            LOG_WARNING(L"HTTP/2 not supported by this version of WinHTTP, using HTTP/1.1");
+        }
+    }
+
+    session = hSession;
+    return true;
+}
+
+std::unique_ptr<HttpResponse> WinHttpTransport::Send(const HttpRequest& request, std::wstring& error) {
+    HINTERNET hConnect = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(transportMutex);
+        if (!EnsureSessionLocked(error)) {
+            return nullptr;
+        }
+
+        // One connect handle per server, shared by every request and thread
+        for (auto& connection : connections) {
+            if (connection.port == request.port && connection.host == request.host) {
+                hConnect = static_cast<HINTERNET>(connection.handle);
+                break;
+            }
+        }
+
+        if (!hConnect) {
+            std::wstring wideHost(request.host.begin(), request.host.end());
+            hConnect = WinHttpConnect(static_cast<HINTERNET>(session), wideHost.c_str(), request.port, 0);
+            if (!hConnect) {
+                error = ErrorText(L"Failed to create session", GetLastError());
+                return nullptr;
+            }
+            connections.push_back({ request.host, request.port, hConnect });
+        }
+        requestsSent++;
+    }
+
+    std::wstring method(request.method, request.method + strlen(request.method));
+    std::wstring path(request.path.begin(), request.path.end());
+    DWORD flags = WINHTTP_FLAG_REFRESH | (request.secure ? WINHTTP_FLAG_SECURE : 0);
+
+    HINTERNET hRequest = WinHttpOpenRequest(hConnect, method.c_str(), path.c_str(), NULL,
+        WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, flags);
+    if (!hRequest) {
+        error = ErrorText(L"Failed to create request", GetLastError());
+        return nullptr;
+    }
+
+    auto abortable = std::make_shared<AbortableRequest>();
+    abortable->status.timings = request.timings;
+    abortable->status.secure = request.secure;
+    // Always watched: whether a connect is reported tells a reused connection from a new one
+    DWORD_PTR context = reinterpret_cast<DWORD_PTR>(&abortable->status);
+
+    auto registration = std::make_unique<CancellationRegistration>(request.cancel, [abortable]() {
+        abortable->Abort();
+    });
+    if (!abortable->Set(hRequest)) {
+        error = L"Request cancelled";
+        return nullptr;
+    }
+
+    HINTERNET handle = abortable->BeginCall();
+    if (!handle) {
+        error = L"Request cancelled";
+        return nullptr;
+    }
+
+    WinHttpSetStatusCallback(handle, OnRequestStatus, TIMING_NOTIFICATIONS, 0);
+
+    if (!g_config.keep_alive) {
+        DWORD feature = WINHTTP_DISABLE_KEEP_ALIVE;
+        WinHttpSetOption(handle, WINHTTP_OPTION_DISABLE_FEATURE, &feature, sizeof(feature));
+    }
+
+    // Request headers are ASCII (content type and bearer token)
+    std::wstring headers(request.headers.begin(), request.headers.end());
+
+    bool sent = WinHttpSendRequest(handle, headers.c_str(), static_cast<DWORD>(headers.length()),
+            (LPVOID)request.body, static_cast<DWORD>(request.bodySize), static_cast<DWORD>(request.bodySize), context) &&
+        WinHttpReceiveResponse(handle, NULL);
+    DWORD sendError = GetLastError();
+
+    DWORD protocol = 0;
+    DWORD protocolSize = sizeof(protocol);
+    bool knowProtocol = sent && WinHttpQueryOption(handle, WINHTTP_OPTION_HTTP_PROTOCOL_USED, &protocol, &protocolSize);
+
+    if (!abortable->EndCall()) {
+        error = L"Request cancelled";
+        return nullptr;
+    }
+    if (!sent) {
+        error = ErrorText(L"Failed to send request", sendError);
+        return nullptr;
+    }
+    if (knowProtocol) {
+        RecordProtocol((protocol & WINHTTP_PROTOCOL_FLAG_HTTP2) != 0);
+    }
+
+    // A request sent on a pooled HTTP/1.1 connection or as another HTTP/2 stream never connects
+    bool reused = !abortable->status.connected;
+    return std::make_unique<WinHttpResponse>(abortable, std::move(registration), reused);
+}
+
+void WinHttpTransport::RecordProtocol(bool usedHttp2) {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    if (usedHttp2) {
+        http2Requests++;
+    }
+}
+
+// Handles are left open for the same reason as the destructor
+void WinHttpTransport::Shutdown() {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    if (requestsSent > 0) {
+        LOG_INFO(L"WinHTTP transport: " + std::to_wstring(requestsSent) + L" requests, " +
+            std::to_wstring(http2Requests) + L" over HTTP/2");
+    }
+}
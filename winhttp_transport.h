@@ -0,0 +1,67 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_WINHTTP_TRANSPORT_H
+#define TTS_STELLARIS_WINHTTP_TRANSPORT_H
+
+#include "http_transport.h"
+#include <vector>
+#include <mutex>
+
+// WinHTTP backend with HTTP/2 enabled
+// Every request to a server goes through one shared session and connect
+// handle, so on an HTTP/2 server all in-flight syntheses are multiplexed as
+// streams over a single TLS connection. Dropping a response before its body
+// is read resets only that stream; flow control is handled by WinHTTP.
+// Servers without HTTP/2 (or plain http://) fall back to pooled HTTP/1.1.
+class WinHttpTransport : public HttpTransport {
+private:
+    struct Connection {
+        std::string host;
+        uint16_t port;
+        void* handle;            // HINTERNET from WinHttpConnect
+    };
+
+    void* session = nullptr;     // HINTERNET from WinHttpOpen
+    std::vector<Connection> connections;
+    std::mutex transportMutex;
+    bool http2Enabled = false;
+    uint64_t requestsSent = 0;
+    uint64_t http2Requests = 0;
+
+    // Must be called with transportMutex held
+    bool EnsureSessionLocked(std::wstring& error);
+    void RecordProtocol(bool usedHttp2);
+
+public:
+    WinHttpTransport() = default;
+    ~WinHttpTransport() override;
+
+    const wchar_t* Name() const override { return L"winhttp"; }
+    std::unique_ptr<HttpResponse> Send(const HttpRequest& request, std::wstring& error) override;
+    void Shutdown() override;
+};
+
+// Global WinHTTP transport instance
+extern WinHttpTransport g_winHttpTransport;
+
+#endif // TTS_STELLARIS_WINHTTP_TRANSPORT_H
@@ -0,0 +1,256 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "wininet_transport.h"
+#include "http_session_pool.h"
+#include "tts_fetcher.h"
+#include "cancellation.h"
+#include "config.h"
+#include "utils.h"
+#include "logger.h"
+
+#include <mutex>
+
+// Global WinINet transport instance
+WinInetTransport g_winInetTransport;
+
+namespace {
+
+// Context of a request handle's status callback
+struct StatusContext {
+    HttpTimings* timings = nullptr;
+    bool secure = false;
+};
+
+// WinINet reports each step of a request to the handle's status callback, on
+// the thread blocked in HttpSendRequest or InternetReadFile
+void CALLBACK OnRequestStatus(HINTERNET, DWORD_PTR context, DWORD status, LPVOID, DWORD) {
+    StatusContext* request = reinterpret_cast<StatusContext*>(context);
+    switch (status) {
+    case INTERNET_STATUS_NAME_RESOLVED:
+        MarkPhase(request->timings, &HttpTimings::resolved);
+        break;
+    case INTERNET_STATUS_CONNECTED_TO_SERVER:
+        MarkPhase(request->timings, &HttpTimings::connected);
+        break;
+    case INTERNET_STATUS_SENDING_REQUEST:
+        // There is no handshake notification; on a new https connection the
+        // handshake is what happens between connecting and sending
+        if (request->secure && request->timings->connected != HttpTimings::TimePoint()) {
+            MarkPhaseOnce(request->timings, &HttpTimings::tlsDone);
+        }
+        break;
+    case INTERNET_STATUS_REQUEST_SENT:
+        MarkPhase(request->timings, &HttpTimings::requestSent);
+        break;
+    case INTERNET_STATUS_RESPONSE_RECEIVED:
+        MarkPhaseOnce(request->timings, &HttpTimings::firstByte);
+        break;
+    }
+}
+
+// Request handle that a cancellation callback may close from another thread
+// Closing the handle is how WinINet cancels a blocking send or read
+class AbortableRequest {
+public:
+    // Declared first so it outlives the handle
+    StatusContext status;
+
+private:
+    std::mutex requestMutex;
+    InternetHandle handle;
+    bool aborted = false;
+
+public:
+    // Takes ownership; closes the handle and returns false if already aborted
+    bool Set(HINTERNET request) {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        if (aborted) {
+            InternetCloseHandle(request);
+            return false;
+        }
+        handle.reset(request);
+        return true;
+    }
+
+    HINTERNET Get() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        return handle;
+    }
+
+    void Abort() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        aborted = true;
+        handle.reset();
+    }
+
+    bool IsAborted() {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        return aborted;
+    }
+};
+
+class WinInetResponse : public HttpResponse {
+private:
+    HttpSessionPool::Lease session;
+    std::shared_ptr<AbortableRequest> request;
+    std::unique_ptr<CancellationRegistration> cancelRegistration;
+    HINTERNET hRequest;
+    int statusCode;
+    uint64_t contentLength;
+
+public:
+    WinInetResponse(HttpSessionPool::Lease&& lease, std::shared_ptr<AbortableRequest> abortable,
+        std::unique_ptr<CancellationRegistration>&& registration)
+        : session(std::move(lease)), request(std::move(abortable)), cancelRegistration(std::move(registration)),
+          hRequest(request->Get()), statusCode(0), contentLength(0) {
+        DWORD value = 0;
+        DWORD valueSize = sizeof(value);
+        if (HttpQueryInfoA(hRequest, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &value, &valueSize, NULL)) {
+            statusCode = static_cast<int>(value);
+        }
+
+        value = 0;
+        valueSize = sizeof(value);
+        if (HttpQueryInfoA(hRequest, HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER, &value, &valueSize, NULL)) {
+            contentLength = value;
+        }
+    }
+
+    // The registration goes first so no callback closes the handle under us
+    ~WinInetResponse() override {
+        cancelRegistration.reset();
+    }
+
+    int StatusCode() const override { return statusCode; }
+    uint64_t ContentLength() const override { return contentLength; }
+    bool ConnectionReused() const override { return session.IsReused(); }
+
+    std::string Header(const char* name) const override {
+        // HTTP_QUERY_CUSTOM takes the header name in the buffer and overwrites it with the value
+        char buffer[512] = { 0 };
+        strncpy_s(buffer, sizeof(buffer), name, _TRUNCATE);
+        DWORD bufferSize = sizeof(buffer);
+        if (!HttpQueryInfoA(hRequest, HTTP_QUERY_CUSTOM, buffer, &bufferSize, NULL)) {
+            return std::string();
+        }
+        return std::string(buffer, bufferSize);
+    }
+
+    bool QueryAvailable(size_t& available) override {
+        DWORD bytes = 0;
+        if (!InternetQueryDataAvailable(hRequest, &bytes, 0, 0) || request->IsAborted()) {
+            return false;
+        }
+        available = bytes;
+        return true;
+    }
+
+    bool Read(uint8_t* dest, size_t size, size_t& bytesRead) override {
+        DWORD read = 0;
+        if (!InternetReadFile(hRequest, dest, static_cast<DWORD>(size), &read) || request->IsAborted()) {
+            return false;
+        }
+        bytesRead = read;
+        return true;
+    }
+
+    // An aborted request's connection is gone; don't hand the session back
+    void MarkComplete() override {
+        if (!request->IsAborted()) {
+            session.MarkReusable();
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<HttpResponse> WinInetTransport::Send(const HttpRequest& request, std::wstring& error) {
+    DWORD flags = INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE;
+    if (g_config.keep_alive) {
+        flags |= INTERNET_FLAG_KEEP_CONNECTION;
+    }
+    if (request.secure) {
+        flags |= INTERNET_FLAG_SECURE;
+    }
+
+    std::string headers = request.headers;
+    if (!g_config.keep_alive) {
+        headers += "Connection: close\r\n";
+    }
+
+    HttpSessionPool::Lease session = g_httpSessionPool.Acquire(request.host, request.port);
+    if (!session) {
+        error = L"no session available";
+        return nullptr;
+    }
+
+    auto abortable = std::make_shared<AbortableRequest>();
+    abortable->status.timings = request.timings;
+    abortable->status.secure = request.secure;
+    DWORD_PTR context = request.timings ? reinterpret_cast<DWORD_PTR>(&abortable->status) : 0;
+
+    auto registration = std::make_unique<CancellationRegistration>(request.cancel, [abortable]() {
+        abortable->Abort();
+    });
+
+    while (session) {
+        HINTERNET hRequest = HttpOpenRequestA(session.Connection(), request.method, request.path.c_str(), NULL, NULL, NULL, flags, context);
+        if (!hRequest) {
+            error = L"Failed to create request: " + GetWindowsErrorMessage(GetLastError());
+            return nullptr;
+        }
+        if (context) {
+            InternetSetStatusCallbackA(hRequest, OnRequestStatus);
+        }
+        if (!abortable->Set(hRequest)) {
+            error = L"Request cancelled";
+            return nullptr;
+        }
+
+        if (HttpSendRequestA(hRequest, headers.c_str(), static_cast<DWORD>(headers.length()),
+            (LPVOID)request.body, static_cast<DWORD>(request.bodySize)) && !abortable->IsAborted()) {
+            return std::make_unique<WinInetResponse>(std::move(session), abortable, std::move(registration));
+        }
+
+        DWORD lastError = GetLastError();
+        if (abortable->IsAborted()) {
+            error = L"Request cancelled";
+            return nullptr;
+        }
+        if (!session.IsReused()) {
+            error = L"Failed to send request: " + GetWindowsErrorMessage(lastError);
+            return nullptr;
+        }
+
+        // The server dropped the idle keep-alive connection - reconnect without using up an attempt
+        LOG_DEBUG(L"Pooled session went stale, reconnecting");
+        session = g_httpSessionPool.Acquire(request.host, request.port);
+    }
+
+    error = L"no session available";
+    return nullptr;
+}
+
+void WinInetTransport::Shutdown() {
+    g_httpSessionPool.Shutdown();
+}
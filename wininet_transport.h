@@ -0,0 +1,40 @@
+// MIT License
+//
+// Copyright (c) 2026 4byssEcho
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TTS_STELLARIS_WININET_TRANSPORT_H
+#define TTS_STELLARIS_WININET_TRANSPORT_H
+
+#include "http_transport.h"
+
+// Default backend: WinINet over the keep-alive session pool
+// Handles proxies, TLS and redirects the way the rest of Windows does
+class WinInetTransport : public HttpTransport {
+public:
+    const wchar_t* Name() const override { return L"wininet"; }
+    std::unique_ptr<HttpResponse> Send(const HttpRequest& request, std::wstring& error) override;
+    void Shutdown() override;
+};
+
+// Global WinINet transport instance
+extern WinInetTransport g_winInetTransport;
+
+#endif // TTS_STELLARIS_WININET_TRANSPORT_H